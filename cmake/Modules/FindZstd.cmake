@@ -0,0 +1,28 @@
+# Finds zstd.
+#
+# This module defines:
+# ZSTD_FOUND
+# ZSTD_INCLUDE_DIR
+# ZSTD_LIBRARY
+# ZSTD_VERSION
+#
+
+find_package(PkgConfig)
+pkg_check_modules(PC_ZSTD QUIET libzstd)
+
+find_path(ZSTD_INCLUDE_DIR NAMES zstd.h
+	HINTS
+	${PC_ZSTD_INCLUDEDIR}
+	${PC_ZSTD_INCLUDE_DIRS})
+
+find_library(ZSTD_LIBRARY NAMES zstd
+	HINTS
+	${PC_ZSTD_LIBDIR}
+	${PC_ZSTD_LIBRARY_DIRS})
+
+set(ZSTD_VERSION ${PC_ZSTD_VERSION})
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(Zstd REQUIRED_VARS ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
@@ -1,3 +0,0 @@
-void main() {
-  gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
-}
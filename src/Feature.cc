@@ -35,6 +35,7 @@ const Feature Feature::ExperimentalFastCsg("fast-csg", "Enable much faster CSG o
 const Feature Feature::ExperimentalFastCsgSafer("fast-csg-safer", "Don't use corefinement in cases it doesn't supports and risks crashing. This will fallback to slower operations on Nef polyhedra.");
 const Feature Feature::ExperimentalFastCsgDebug("fast-csg-debug", "Debug mode for fast-csg: adds logs with extra costly checks and dumps .off files with the last corefinement operands.");
 const Feature Feature::ExperimentalManifold("manifold", "Use the Manifold library (https://github.com/elalish/manifold) for CSG operations instead of CGAL.");
+const Feature Feature::ExperimentalAutoCsg("auto-csg", "Choose Manifold, corefinement or Nef polyhedra for each CSG operation from its operands, falling back to the next one if it fails. Overrides <code>manifold</code> and <code>fast-csg</code> for unions, intersections and differences.");
 const Feature Feature::ExperimentalRoof("roof", "Enable <code>roof</code>");
 const Feature Feature::ExperimentalInputDriverDBus("input-driver-dbus", "Enable DBus input drivers (requires restart)");
 const Feature Feature::ExperimentalLazyUnion("lazy-union", "Enable lazy unions.");
@@ -45,6 +46,9 @@ const Feature Feature::ExperimentalVxORenderersPrealloc("vertex-object-renderers
 const Feature Feature::ExperimentalTextMetricsFunctions("textmetrics", "Enable the <code>textmetrics()</code> and <code>fontmetrics()</code> functions.");
 const Feature Feature::ExperimentalImportFunction("import-function", "Enable import function returning data instead of geometry.");
 const Feature Feature::ExperimentalPredictibleOutput("predictible-output", "Attempt to produce predictible, diffable outputs (e.g. sorting the STL, or remeshing in a determined order)");
+const Feature Feature::ExperimentalIncrementalUnion("incremental-union", "Cache partial unions of children, so that editing one child of a large union only re-evaluates the unions on its path.");
+const Feature Feature::ExperimentalStreamingUnion("streaming-union", "Union children into partial results as they are evaluated, to release them early and reduce peak memory.");
+const Feature Feature::ExperimentalAnimationFrameCache("animation-frame-cache", "Precompute upcoming animation frames in the background during playback, and keep them so looping plays smoothly.");
 #ifdef ENABLE_PYTHON
 const Feature Feature::ExperimentalPythonEngine("python-engine", "Enable experimental Python Engine (implies risk of malicious scripts downloaded).");
 #endif
@@ -18,6 +18,7 @@ public:
   static const Feature ExperimentalFastCsgSafer;
   static const Feature ExperimentalFastCsgDebug;
   static const Feature ExperimentalManifold;
+  static const Feature ExperimentalAutoCsg;
   static const Feature ExperimentalRoof;
   static const Feature ExperimentalInputDriverDBus;
   static const Feature ExperimentalLazyUnion;
@@ -28,6 +29,9 @@ public:
   static const Feature ExperimentalTextMetricsFunctions;
   static const Feature ExperimentalImportFunction;
   static const Feature ExperimentalPredictibleOutput;
+  static const Feature ExperimentalIncrementalUnion;
+  static const Feature ExperimentalStreamingUnion;
+  static const Feature ExperimentalAnimationFrameCache;
 #ifdef ENABLE_PYTHON
   static const Feature ExperimentalPythonEngine;
 #endif
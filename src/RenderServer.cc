@@ -0,0 +1,207 @@
+#include "RenderServer.h"
+#include "GeometryCache.h"
+#include "PathCache.h"
+#include "SourceFileCache.h"
+#include "StatCache.h"
+#include "dxfdim.h"
+#include "exceptions.h"
+#include "printutils.h"
+#ifdef ENABLE_CGAL
+#include "CGALCache.h"
+#endif
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+
+namespace fs = boost::filesystem;
+using json = nlohmann::json;
+
+namespace {
+
+// JSON-RPC 2.0 error codes
+const int PARSE_ERROR = -32700;
+const int INVALID_REQUEST = -32600;
+const int METHOD_NOT_FOUND = -32601;
+const int INVALID_PARAMS = -32602;
+
+struct RequestError
+{
+  int code;
+  std::string message;
+};
+
+std::string getString(const json& params, const char *name, bool required = false)
+{
+  auto it = params.find(name);
+  if (it == params.end() || it->is_null()) {
+    if (required) throw RequestError{INVALID_PARAMS, std::string("Missing parameter '") + name + "'"};
+    return {};
+  }
+  if (!it->is_string()) throw RequestError{INVALID_PARAMS, std::string("Parameter '") + name + "' must be a string"};
+  return it->get<std::string>();
+}
+
+std::vector<std::string> getStrings(const json& params, const char *name)
+{
+  std::vector<std::string> result;
+  auto it = params.find(name);
+  if (it == params.end() || it->is_null()) return result;
+  if (!it->is_array()) throw RequestError{INVALID_PARAMS, std::string("Parameter '") + name + "' must be an array of strings"};
+  for (const auto& item : *it) {
+    if (!item.is_string()) throw RequestError{INVALID_PARAMS, std::string("Parameter '") + name + "' must be an array of strings"};
+    result.push_back(item.get<std::string>());
+  }
+  return result;
+}
+
+json errorResponse(const json& id, int code, const std::string& message)
+{
+  return {{"jsonrpc", "2.0"}, {"id", id}, {"error", {{"code", code}, {"message", message}}}};
+}
+
+} // namespace
+
+/*!
+   Handles requests from \a in until it ends or a shutdown request was
+   answered. Returns the process exit code.
+ */
+int RenderServer::run(std::istream& in, std::ostream& out)
+{
+  std::string line;
+  while (!this->shutdown && std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    const auto response = handle(line);
+    // Log messages, echo output and file names may hold invalid UTF-8, which
+    // would make dump() throw and end the server
+    if (!response.is_null()) out << response.dump(-1, ' ', false, json::error_handler_t::replace) << std::endl;
+  }
+  return 0;
+}
+
+json RenderServer::handle(const std::string& line)
+{
+  json request;
+  try {
+    request = json::parse(line);
+  } catch (const json::exception& e) {
+    return errorResponse(nullptr, PARSE_ERROR, e.what());
+  }
+  if (!request.is_object()) return errorResponse(nullptr, INVALID_REQUEST, "Request must be an object");
+  const json id = request.value("id", json());
+  // Notifications are handled, but never answered, not even with an error
+  const bool notification = !request.contains("id");
+
+  try {
+    auto method = request.find("method");
+    if (method == request.end() || !method->is_string()) throw RequestError{INVALID_REQUEST, "Missing method"};
+    const json params = request.value("params", json::object());
+    if (!params.is_object()) throw RequestError{INVALID_PARAMS, "Parameters must be an object"};
+
+    json result;
+    if (*method == "render") {
+      result = handleRender(params);
+    } else if (*method == "invalidate") {
+      result = handleInvalidate(params);
+    } else if (*method == "clear-caches") {
+      GeometryCache::instance()->clear();
+#ifdef ENABLE_CGAL
+      CGALCache::instance()->clear();
+#endif
+      dxf_dim_cache.clear();
+      dxf_cross_cache.clear();
+      SourceFileCache::instance()->clear();
+      PathCache::instance()->clear();
+      result = json::object();
+    } else if (*method == "shutdown") {
+      this->shutdown = true;
+      result = json::object();
+    } else {
+      throw RequestError{METHOD_NOT_FOUND, "Unknown method '" + method->get<std::string>() + "'"};
+    }
+    if (notification) return nullptr;
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
+  } catch (const RequestError& e) {
+    if (notification) return nullptr;
+    return errorResponse(id, e.code, e.message);
+  }
+}
+
+json RenderServer::handleRender(const json& params)
+{
+  RenderRequest request;
+  request.file = getString(params, "file", true);
+  request.output = getString(params, "output", true);
+  if (request.output == "-") throw RequestError{INVALID_PARAMS, "Output to stdout is not supported"};
+  request.format = getString(params, "format");
+  request.parameterFile = getString(params, "parameter_file");
+  request.parameterSet = getString(params, "parameter_set");
+  request.summaryOptions = getStrings(params, "summary");
+
+  auto parameters = params.find("parameters");
+  if (parameters != params.end() && !parameters->is_null()) {
+    if (!parameters->is_object()) throw RequestError{INVALID_PARAMS, "Parameter 'parameters' must be an object"};
+    for (const auto& [name, value] : parameters->items()) {
+      // Stored like values read from a parameter file
+      request.parameters[name].data() = value.is_string() ? value.get<std::string>() : value.dump();
+    }
+  }
+
+  // The summary is written to a file and returned with the result
+  if (!request.summaryOptions.empty()) {
+    request.summaryFile = (fs::temp_directory_path() / fs::unique_path("openscad-summary-%%%%-%%%%-%%%%.json")).string();
+  }
+
+  this->log = json::array();
+  set_output_handler(&RenderServer::output, nullptr, this);
+  resetSuppressedMessages();
+  const auto cwd = fs::current_path();
+  int rc = 1;
+  try {
+    rc = this->render(request);
+  } catch (const HardWarningException&) {
+  } catch (const std::exception& e) {
+    LOG(message_group::Error, "Render failed: %1$s", e.what());
+  }
+  fs::current_path(cwd);
+  set_output_handler(nullptr, nullptr, nullptr);
+
+  json result = {{"success", rc == 0}, {"log", std::move(this->log)}};
+  if (!request.summaryFile.empty()) {
+    std::ifstream summary(request.summaryFile);
+    if (summary) {
+      try {
+        result["summary"] = json::parse(summary);
+      } catch (const json::exception&) {
+      }
+    }
+    summary.close();
+    boost::system::error_code ec;
+    fs::remove(request.summaryFile, ec);
+  }
+  return result;
+}
+
+json RenderServer::handleInvalidate(const json& params)
+{
+  const auto paths = getStrings(params, "paths");
+  for (const auto& path : paths) {
+    const auto fullpath = fs::absolute(path).generic_string();
+    StatCache::invalidate(fullpath);
+    SourceFileCache::instance()->invalidate(fullpath);
+  }
+  // Changed files may resolve differently, e.g. a new file in a library directory
+  PathCache::instance()->clear();
+  return {{"invalidated", paths.size()}};
+}
+
+void RenderServer::output(const Message& msg, void *userdata)
+{
+  auto self = static_cast<RenderServer *>(userdata);
+  json entry = {{"type", msg.group == message_group::NONE ? "" : getGroupName(msg.group)}, {"message", msg.msg}};
+  if (!msg.loc.isNone()) {
+    entry["file"] = msg.loc.fileName();
+    entry["line"] = msg.loc.firstLine();
+  }
+  self->log.push_back(std::move(entry));
+}
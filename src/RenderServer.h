@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <json.hpp>
+
+#include "ParameterSet.h"
+#include "printutils.h"
+
+/*!
+   One "render" request, as handed to the function doing the export.
+ */
+struct RenderRequest
+{
+  std::string file;
+  std::string output;
+  std::string format; // like --export-format, empty to use the output suffix
+  ParameterSet parameters; // customizer values, applied on top of the parameter set
+  std::string parameterFile;
+  std::string parameterSet;
+  std::vector<std::string> summaryOptions;
+  std::string summaryFile;
+};
+
+/*!
+   Serves render requests in a long-lived process, so the caches stay warm
+   between renders.
+
+   Reads one JSON-RPC 2.0 request per line and writes one response per line,
+   except for notifications (requests without an id).
+   Messages logged while handling a request are returned with its result.
+   Requests are handled one at a time, in order: the caches and the output
+   handler are process wide.
+
+   Methods:
+   - render {file, output, format?, parameters?, parameter_file?,
+     parameter_set?, summary?} -> {success, log, summary?}
+   - invalidate {paths} -> {invalidated}: forget cached state for changed files
+   - clear-caches {} -> {}
+   - shutdown {} -> {}: ends run() once the response is written
+ */
+class RenderServer
+{
+public:
+  using RenderFunction = std::function<int (const RenderRequest&)>;
+
+  RenderServer(RenderFunction render) : render(std::move(render)) {}
+
+  int run(std::istream& in, std::ostream& out);
+
+private:
+  // Returns null for notifications
+  nlohmann::json handle(const std::string& line);
+  nlohmann::json handleRender(const nlohmann::json& params);
+  nlohmann::json handleInvalidate(const nlohmann::json& params);
+
+  static void output(const Message& msg, void *userdata);
+
+  RenderFunction render;
+  nlohmann::json log;
+  bool shutdown{false};
+};
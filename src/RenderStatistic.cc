@@ -24,15 +24,18 @@
  */
 
 #include <json.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 
 #include "printutils.h"
 #include "GeometryCache.h"
 #include "CGALCache.h"
+#include "PathCache.h"
 #include "PolySet.h"
 #include "Polygon2d.h"
 #ifdef ENABLE_CGAL
 #include "CGAL_Nef_polyhedron.h"
 #include "CGALHybridPolyhedron.h"
+#include "CSGKernelSelector.h"
 #endif // ENABLE_CGAL
 
 #ifdef ENABLE_MANIFOLD
@@ -55,6 +58,7 @@ struct StatisticVisitor : public GeometryVisitor
   virtual void printCamera(const Camera& camera) = 0;
   virtual void printCacheStatistic() = 0;
   virtual void printRenderingTime(std::chrono::milliseconds) = 0;
+  virtual void printKernelStatistic() = 0;
   virtual void finish() = 0;
 protected:
   bool is_enabled(const std::string& name) {
@@ -81,6 +85,7 @@ struct LogVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printKernelStatistic() override;
   void finish() override;
 private:
   void printBoundingBox3(const BoundingBox& bb);
@@ -106,6 +111,7 @@ struct StreamVisitor : public StatisticVisitor
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printKernelStatistic() override;
   void finish() override;
 private:
   nlohmann::json json;
@@ -147,6 +153,8 @@ static nlohmann::json getCache(C cache)
   nlohmann::json cacheJson;
   cacheJson["entries"] = cache->size();
   cacheJson["bytes"] = cache->totalCost();
+  cacheJson["lookups"] = cache->lookups();
+  cacheJson["hits"] = cache->hits();
   cacheJson["max_size"] = cache->maxSizeMB() * 1024 * 1024;
   return cacheJson;
 }
@@ -155,11 +163,17 @@ static nlohmann::json getCache(C cache)
 
 RenderStatistic::RenderStatistic() : begin(std::chrono::steady_clock::now())
 {
+#ifdef ENABLE_CGAL
+  CSGKernelSelector::resetStatistics();
+#endif
 }
 
 void RenderStatistic::start()
 {
   begin = std::chrono::steady_clock::now();
+#ifdef ENABLE_CGAL
+  CSGKernelSelector::resetStatistics();
+#endif
 }
 
 std::chrono::milliseconds RenderStatistic::ms()
@@ -181,6 +195,18 @@ void RenderStatistic::printRenderingTime()
   visitor.printRenderingTime(ms());
 }
 
+static void printAllTo(StatisticVisitor& visitor, const shared_ptr<const Geometry>& geom, const Camera& camera, std::chrono::milliseconds ms)
+{
+  visitor.printCacheStatistic();
+  visitor.printRenderingTime(ms);
+  visitor.printKernelStatistic();
+  if (geom && !geom->isEmpty()) {
+    geom->accept(visitor);
+  }
+  visitor.printCamera(camera);
+  visitor.finish();
+}
+
 void RenderStatistic::printAll(const shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options, const std::string& filename)
 {
   //bool is_log = false;
@@ -193,21 +219,20 @@ void RenderStatistic::printAll(const shared_ptr<const Geometry>& geom, const Cam
   } else {
     visitor = std::make_unique<StreamVisitor>(options, filename);
   }
+  printAllTo(*visitor, geom, camera, ms());
+}
 
-  visitor->printCacheStatistic();
-  visitor->printRenderingTime(ms());
-  if (geom && !geom->isEmpty()) {
-    geom->accept(*visitor);
-  }
-  visitor->printCamera(camera);
-  visitor->finish();
+void RenderStatistic::printAll(const shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options, std::ostream& stream)
+{
+  StreamVisitor visitor(options, stream);
+  printAllTo(visitor, geom, camera, ms());
 }
 
 void LogVisitor::visit(const GeometryList& geomlist)
 {
   LOG("Top level object is a list of objects:");
   LOG("   Objects:    %1$d",
-      geomlist.getChildren().size());
+      geomlist.size());
 }
 
 void LogVisitor::visit(const Polygon2d& poly)
@@ -312,6 +337,7 @@ void LogVisitor::printCacheStatistic()
 #ifdef ENABLE_CGAL
   CGALCache::instance()->print();
 #endif
+  PathCache::instance()->print();
 }
 
 void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
@@ -324,6 +350,21 @@ void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
       (ms.count() % 1000));
 }
 
+void LogVisitor::printKernelStatistic()
+{
+#ifdef ENABLE_CGAL
+  // only with auto-csg, which records the kernel of each operation
+  const auto statistics = CSGKernelSelector::statistics();
+  if (statistics.empty()) return;
+  LOG("CSG kernels:");
+  for (const auto& [kernel, statistic] : statistics) {
+    LOG("   %1$-13s %2$6d operations, %3$d failed, %4$d operand conversions, %5$.3f s",
+        std::string(CSGKernelSelector::kernelName(kernel)) + ":", statistic.operations, statistic.failures, statistic.conversions,
+        std::chrono::duration<double>(statistic.time).count());
+  }
+#endif // ENABLE_CGAL
+}
+
 void LogVisitor::finish()
 {
 }
@@ -433,6 +474,11 @@ void StreamVisitor::printCacheStatistic()
 #ifdef ENABLE_CGAL
     cacheJson["cgal_cache"] = getCache(CGALCache::instance());
 #endif // ENABLE_CGAL
+    nlohmann::json pathCacheJson;
+    pathCacheJson["entries"] = PathCache::instance()->size();
+    pathCacheJson["lookups"] = PathCache::instance()->lookups();
+    pathCacheJson["hits"] = PathCache::instance()->hits();
+    cacheJson["path_cache"] = pathCacheJson;
     json["cache"] = cacheJson;
   }
 }
@@ -455,6 +501,25 @@ void StreamVisitor::printRenderingTime(const std::chrono::milliseconds ms)
   }
 }
 
+void StreamVisitor::printKernelStatistic()
+{
+#ifdef ENABLE_CGAL
+  const auto statistics = CSGKernelSelector::statistics();
+  if (is_enabled(RenderStatistic::CSG) && !statistics.empty()) {
+    nlohmann::json csgJson;
+    for (const auto& [kernel, statistic] : statistics) {
+      nlohmann::json kernelJson;
+      kernelJson["operations"] = statistic.operations;
+      kernelJson["failures"] = statistic.failures;
+      kernelJson["conversions"] = statistic.conversions;
+      kernelJson["milliseconds"] = std::chrono::duration_cast<std::chrono::milliseconds>(statistic.time).count();
+      csgJson[boost::algorithm::to_lower_copy(std::string(CSGKernelSelector::kernelName(kernel)))] = kernelJson;
+    }
+    json["csg"] = csgJson;
+  }
+#endif // ENABLE_CGAL
+}
+
 void StreamVisitor::finish()
 {
   stream << json;
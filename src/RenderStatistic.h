@@ -42,6 +42,7 @@ public:
   constexpr static auto GEOMETRY = "geometry";
   constexpr static auto BOUNDING_BOX = "bounding-box";
   constexpr static auto AREA = "area";
+  constexpr static auto CSG = "csg";
 
   /**
    * Construct a statistic printer for the given geometry with current
@@ -75,6 +76,11 @@ public:
    */
   void printAll(const shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options = {}, const std::string& filename = {});
 
+  /**
+   * Print all available statistic information as JSON to the given stream.
+   */
+  void printAll(const shared_ptr<const Geometry>& geom, const Camera& camera, const std::vector<std::string>& options, std::ostream& stream);
+
 private:
   std::chrono::steady_clock::time_point begin;
 };
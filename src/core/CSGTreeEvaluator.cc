@@ -26,6 +26,8 @@
 
 shared_ptr<CSGNode> CSGTreeEvaluator::buildCSGTree(const AbstractNode& node)
 {
+  // Create expensive leaf geometries concurrently up front
+  if (this->geomevaluator) this->geomevaluator->precomputeLeaves(node);
   this->traverse(node);
 
   shared_ptr<CSGNode> t(this->stored_term[node.index()]);
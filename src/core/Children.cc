@@ -25,18 +25,64 @@
  */
 
 #include "Children.h"
+#include "EvaluationSession.h"
 #include "ScopeContext.h"
+#include "node.h"
+#include "printutils.h"
+
+#include <numeric>
 
 std::shared_ptr<AbstractNode> Children::instantiate(const std::shared_ptr<AbstractNode> &target) const
 {
+  if (cacheable()) {
+    std::vector<size_t> indices(size());
+    std::iota(indices.begin(), indices.end(), 0);
+    return instantiateCached(target, indices);
+  }
   return children_scope->instantiateModules(*scopeContext(), target);
 }
 
 std::shared_ptr<AbstractNode> Children::instantiate(const std::shared_ptr<AbstractNode> &target, const std::vector<size_t>& indices) const
 {
+  if (cacheable()) return instantiateCached(target, indices);
   return children_scope->instantiateModules(*scopeContext(), target, indices);
 }
 
+/*
+   The children of a user module are evaluated in the context of the module
+   instantiation, so within one invocation their nodes only change if the
+   module sets $ variables they can see. Modules calling children() in a loop
+   can so share the nodes of the first call, as long as the body didn't set
+   $ variables since its own context.
+ */
+bool Children::cacheable() const
+{
+  return this->module_context && !this->context->session()->sets_config_variables_above(this->module_context);
+}
+
+/*
+   Children which print messages or draw random numbers are evaluated again
+   each time, so the output and results don't change by caching.
+ */
+std::shared_ptr<AbstractNode> Children::instantiateCached(const std::shared_ptr<AbstractNode>& target, const std::vector<size_t>& indices) const
+{
+  auto it = this->cache.find(indices);
+  if (it != this->cache.end()) {
+    target->children.insert(target->children.end(), it->second.begin(), it->second.end());
+    return target;
+  }
+
+  auto *session = this->context->session();
+  const auto messages = printed_message_count();
+  const auto side_effects = session->side_effect_count();
+  const auto first = target->children.size();
+  children_scope->instantiateModules(*scopeContext(), target, indices);
+  if (printed_message_count() == messages && session->side_effect_count() == side_effects) {
+    this->cache.emplace(indices, std::vector<std::shared_ptr<AbstractNode>>(target->children.begin() + first, target->children.end()));
+  }
+  return target;
+}
+
 ContextHandle<ScopeContext> Children::scopeContext() const
 {
   return Context::create<ScopeContext>(context, children_scope);
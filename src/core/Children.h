@@ -1,6 +1,8 @@
 #pragma once
 
+#include <map>
 #include <utility>
+#include <vector>
 
 #include "Context.h"
 #include "LocalScope.h"
@@ -35,6 +37,14 @@ public:
 private:
   const LocalScope *children_scope;
   std::shared_ptr<const Context> context;
+  // Context of the user module invocation these are the children of, if any
+  const ContextFrame *module_context{nullptr};
+  // Nodes instantiated for each list of indices, see instantiateCached()
+  mutable std::map<std::vector<size_t>, std::vector<std::shared_ptr<AbstractNode>>> cache;
 
   [[nodiscard]] ContextHandle<ScopeContext> scopeContext() const;
+  [[nodiscard]] bool cacheable() const;
+  std::shared_ptr<AbstractNode> instantiateCached(const std::shared_ptr<AbstractNode>& target, const std::vector<size_t>& indices) const;
+
+  friend class UserModuleContext;
 };
@@ -2,6 +2,9 @@
 
 #include "node.h"
 #include "linalg.h"
+#include <string>
+#include <unordered_map>
+#include <boost/optional.hpp>
 
 class ColorNode : public AbstractNode
 {
@@ -13,3 +16,6 @@ public:
 
   Color4f color;
 };
+
+extern std::unordered_map<std::string, Color4f> webcolors;
+boost::optional<Color4f> parse_hex_color(const std::string& hex);
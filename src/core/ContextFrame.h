@@ -34,6 +34,7 @@ public:
   void apply_variables(ContextFrame&& other);
 
   static bool is_config_variable(const std::string& name);
+  [[nodiscard]] bool has_config_variables() const { return config_variables.size() > 0; }
 
   EvaluationSession *session() const { return evaluation_session; }
   const std::string& documentRoot() const { return evaluation_session->documentRoot(); }
@@ -24,6 +24,7 @@
  *
  */
 
+#include <algorithm>
 #include <deque>
 #include <map>
 #include <unordered_set>
@@ -31,6 +32,13 @@
 #include "Context.h"
 #include "ContextMemoryManager.h"
 #include "Value.h"
+#include "printutils.h"
+
+/*
+ * A minor collection runs at the latest once this many contexts have been
+ * added since the last collection, which bounds its pause.
+ */
+static const size_t YOUNG_GENERATION_SIZE = 1024;
 
 /*
  * The garbage collector needs to know, for each Value, whether it stores
@@ -117,9 +125,13 @@ struct ReferencedContextVisitor
  * only from a context, then any outgoing references from that Value are also
  * considered reachable-only-from-context, recursively.
  *
+ * Values reachable only from the given contexts are added to
+ * \a exclusiveValues, if given.
+ *
  * Implemented as a breadth first search to save on stack space.
  */
-static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr<Context>>& managedContexts)
+static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr<Context>>& managedContexts,
+                                               std::unordered_set<ValueIdentifier> *exclusiveValues = nullptr)
 {
   std::map<ValueIdentifier, int> accountedValueReferences;
   std::map<const Context *, int> accountedContextReferences;
@@ -141,6 +153,7 @@ static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr
       int requiredReferences = std::visit(UseCountVisitor(), value.getVariant());
       assert(accountedReferences <= requiredReferences);
       if (accountedReferences == requiredReferences) {
+        if (exclusiveValues) exclusiveValues->insert(identifier);
         const std::vector<Value> *embeddedValues = std::visit(EmbeddedValuesVisitor(), value.getVariant());
         if (embeddedValues) {
           for (const Value& embeddedValue : *embeddedValues) {
@@ -200,12 +213,23 @@ static std::vector<Context *> findRootContexts(const std::vector<std::shared_ptr
 
 
 
+struct Scope
+{
+  std::unordered_set<const Context *> contexts;
+  std::unordered_set<ValueIdentifier> values;
+};
+
 /*
  * Finds all contexts reachable from a set of root contexts.
  *
+ * If \a scope is given, the search doesn't leave the contexts and values
+ * in it. Everything outside the scope that references something inside it
+ * has made the referenced context a root already, so this finds the same
+ * contexts of the scope as a full search.
+ *
  * Implemented as a breadth first search to save on stack space.
  */
-static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts)
+static std::unordered_set<const Context *> findReachableContexts(const std::vector<Context *>& rootContexts, const Scope *scope = nullptr)
 {
   std::unordered_set<ValueIdentifier> valuesSeen;
   std::unordered_set<const Context *> contextsSeen;
@@ -218,12 +242,18 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
       if (!identifier) {
         return;
       }
+      if (scope && !scope->values.count(identifier)) {
+        return;
+      }
       if (!valuesSeen.count(identifier)) {
         valuesSeen.insert(identifier);
         valueQueue.push_back(&value);
       }
     };
   auto visitContext = [&](const Context *context) {
+      if (scope && !scope->contexts.count(context)) {
+        return;
+      }
       if (!contextsSeen.count(context)) {
         contextsSeen.insert(context);
         contextQueue.push_back(context);
@@ -271,9 +301,16 @@ static std::unordered_set<const Context *> findReachableContexts(const std::vect
 
 
 /*
- * Clean up all unreachable contexts.
+ * Clean up all unreachable contexts of \a managedContexts, and move the
+ * others to \a survivors, which may be the same list.
+ *
+ * A \a minor collection only looks at the given contexts and the values
+ * reachable from nothing else: references from anywhere else count as roots.
+ * It collects cycles among the given contexts, but not cycles through other
+ * contexts. Its cost doesn't depend on the size of the rest of the heap.
  */
-static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
+static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts,
+                           std::vector<std::weak_ptr<Context>>& survivors, bool minor)
 {
   /*
    * Garbage collection consists of three phases.
@@ -304,9 +341,18 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
     }
   }
 
-  std::vector<Context *> rootContexts = findRootContexts(allContexts);
-
-  std::unordered_set<const Context *> reachableContexts = findReachableContexts(rootContexts);
+  std::unordered_set<const Context *> reachableContexts;
+  if (minor) {
+    Scope scope;
+    std::vector<Context *> rootContexts = findRootContexts(allContexts, &scope.values);
+    for (const std::shared_ptr<Context>& context : allContexts) {
+      scope.contexts.insert(context.get());
+    }
+    reachableContexts = findReachableContexts(rootContexts, &scope);
+  } else {
+    std::vector<Context *> rootContexts = findRootContexts(allContexts);
+    reachableContexts = findReachableContexts(rootContexts);
+  }
 
 #ifdef DEBUG
   std::vector<std::weak_ptr<Context>> removedContexts;
@@ -315,7 +361,7 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
   managedContexts.clear();
   for (std::shared_ptr<Context>& context : allContexts) {
     if (reachableContexts.count(context.get())) {
-      managedContexts.emplace_back(context);
+      survivors.emplace_back(context);
     } else {
       context->clear();
 #ifdef DEBUG
@@ -349,9 +395,43 @@ static void collectGarbage(std::vector<std::weak_ptr<Context>>& managedContexts)
 
 ContextMemoryManager::~ContextMemoryManager()
 {
-  collectGarbage(managedContexts);
-  assert(managedContexts.empty());
+  oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+  youngContexts.clear();
+  collectGarbage(oldContexts, oldContexts, false);
+  assert(oldContexts.empty());
   assert(heapSizeAccounting.size() == 0);
+
+  if (minorCollections || majorCollections) {
+    const std::chrono::duration<double, std::milli> total = collectionTime;
+    const std::chrono::duration<double, std::milli> longest = longestCollection;
+    PRINTDB("Garbage collection: %d minor and %d major runs, %.3f ms in total, longest %.3f ms",
+            minorCollections % majorCollections % total.count() % longest.count());
+  }
+}
+
+/*
+ * Contexts are collected generationally. Most contexts that become garbage
+ * do so shortly after they were created, e.g. the cycle between a function
+ * literal and the context it captures. A minor collection only looks at the
+ * contexts added since the last collection and promotes the survivors. A
+ * major collection of all contexts only runs if the minor one didn't bring
+ * the heap below the scheduled size.
+ */
+void ContextMemoryManager::collect(bool major)
+{
+  const auto start = std::chrono::steady_clock::now();
+  if (major) {
+    oldContexts.insert(oldContexts.end(), youngContexts.begin(), youngContexts.end());
+    youngContexts.clear();
+    collectGarbage(oldContexts, oldContexts, false);
+    ++majorCollections;
+  } else {
+    collectGarbage(youngContexts, oldContexts, true);
+    ++minorCollections;
+  }
+  const auto duration = std::chrono::steady_clock::now() - start;
+  collectionTime += duration;
+  longestCollection = std::max(longestCollection, duration);
 }
 
 void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
@@ -365,10 +445,13 @@ void ContextMemoryManager::addContext(const std::shared_ptr<Context>& context)
    * right away.
    */
   if (context.use_count() > 1) {
-    managedContexts.emplace_back(context);
+    youngContexts.emplace_back(context);
 
+    if (youngContexts.size() >= YOUNG_GENERATION_SIZE || heapSizeAccounting.size() >= nextGarbageCollectSize) {
+      collect(false);
+    }
     if (heapSizeAccounting.size() >= nextGarbageCollectSize) {
-      collectGarbage(managedContexts);
+      collect(true);
       /*
        * The cost of a garbage collection run is proportional to the heap
        * size. By scheduling the next run at twice the *remaining* heap size,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -41,7 +42,17 @@ public:
   HeapSizeAccounting& accounting() { return heapSizeAccounting; }
 
 private:
-  std::vector<std::weak_ptr<Context>> managedContexts;
+  void collect(bool major);
+
+  // Contexts that survived a collection, and those added since the last one
+  std::vector<std::weak_ptr<Context>> oldContexts;
+  std::vector<std::weak_ptr<Context>> youngContexts;
   HeapSizeAccounting heapSizeAccounting;
   size_t nextGarbageCollectSize = 0;
+
+  // Reported with --debug=ContextMemoryManager
+  size_t minorCollections = 0;
+  size_t majorCollections = 0;
+  std::chrono::steady_clock::duration collectionTime{};
+  std::chrono::steady_clock::duration longestCollection{};
 };
@@ -47,6 +47,15 @@ void EvaluationSession::pop_frame(size_t index)
   assert(stack.size() == index);
 }
 
+bool EvaluationSession::sets_config_variables_above(const ContextFrame *frame) const
+{
+  for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
+    if (*it == frame) return false;
+    if ((*it)->has_config_variables()) return true;
+  }
+  return true;
+}
+
 boost::optional<const Value&> EvaluationSession::try_lookup_special_variable(const std::string& name) const
 {
   for (auto it = stack.crbegin(); it != stack.crend(); ++it) {
@@ -23,6 +23,8 @@ public:
   void replace_frame(size_t index, ContextFrame *frame);
   void pop_frame(size_t index);
 
+  // Whether a frame pushed after \a frame sets $ variables, true if \a frame isn't on the stack
+  [[nodiscard]] bool sets_config_variables_above(const ContextFrame *frame) const;
   [[nodiscard]] boost::optional<const Value&> try_lookup_special_variable(const std::string& name) const;
   [[nodiscard]] const Value& lookup_special_variable(const std::string& name, const Location& loc) const;
   [[nodiscard]] boost::optional<CallableFunction> lookup_special_function(const std::string& name, const Location& loc) const;
@@ -32,8 +34,13 @@ public:
   ContextMemoryManager& contextMemoryManager() { return context_memory_manager; }
   HeapSizeAccounting& accounting() { return context_memory_manager.accounting(); }
 
+  // Counts evaluations that may not give the same result when repeated, e.g. random numbers
+  void add_side_effect() { ++side_effects; }
+  [[nodiscard]] size_t side_effect_count() const { return side_effects; }
+
 private:
   std::string document_root;
   std::vector<ContextFrame *> stack;
   ContextMemoryManager context_memory_manager;
+  size_t side_effects{0};
 };
@@ -284,7 +284,14 @@ Vector::Vector(const Location& loc) : Expression(loc), literal_flag(unknown)
 {
 }
 
+const std::vector<shared_ptr<Expression>>& Vector::getChildren() const
+{
+  if (this->packed && this->children.empty()) unpack();
+  return this->children;
+}
+
 bool Vector::isLiteral() const {
+  if (this->packed) return true;
   if (unknown(literal_flag)) {
     for (const auto& e : this->children) {
       if (!e->isLiteral()) {
@@ -299,13 +306,87 @@ bool Vector::isLiteral() const {
   }
 }
 
+// Vectors reaching this many elements are packed if they are all numbers,
+// small ones stay as children for the customizer to inspect.
+static const size_t PACK_THRESHOLD = 64;
+
+// The value of a number literal or of a vector of them, nested to any depth
+std::optional<Value> Vector::numericValue(const Expression& expr)
+{
+  if (const auto *literal = dynamic_cast<const Literal *>(&expr)) {
+    if (literal->isDouble()) return Value(literal->toDouble());
+  } else if (const auto *vector = dynamic_cast<const Vector *>(&expr)) {
+    if (vector->packed) return Value(vector->packed->clone());
+    if (!vector->packable) return {};
+    VectorType vec(nullptr);
+    vec.reserve(vector->children.size());
+    for (const auto& e : vector->children) {
+      auto value = numericValue(*e);
+      if (!value) return {};
+      vec.emplace_back(std::move(*value));
+    }
+    return Value(std::move(vec));
+  }
+  return {};
+}
+
+/*!
+   Replaces the children by their values if they are all numbers, so the
+   parser doesn't keep an Expression per element of large point arrays and
+   evaluation returns the same shared vector instead of rebuilding it.
+   The packed vector has no evaluation session, as it outlives them.
+ */
+void Vector::pack()
+{
+  VectorType vec(nullptr);
+  vec.reserve(this->children.size());
+  for (const auto& e : this->children) {
+    auto value = numericValue(*e);
+    if (!value) {
+      this->packable = false;
+      return;
+    }
+    vec.emplace_back(std::move(*value));
+  }
+  this->packed = std::move(vec);
+  this->children.clear();
+  this->children.shrink_to_fit();
+}
+
+static Expression *expressionOf(const Value& value, const Location& loc)
+{
+  if (value.type() != Value::Type::VECTOR) return new Literal(value.clone(), loc);
+  auto *vector = new Vector(loc);
+  for (const auto& element : value.toVector()) vector->emplace_back(expressionOf(element, loc));
+  return vector;
+}
+
+// Recreates the children of a packed vector
+void Vector::unpack() const
+{
+  this->children.reserve(this->packed->size());
+  for (const auto& value : *this->packed) this->children.emplace_back(expressionOf(value, loc));
+}
+
 void Vector::emplace_back(Expression *expr)
 {
+  if (this->packed) {
+    if (auto value = numericValue(*expr)) {
+      this->packed->emplace_back(std::move(*value));
+      delete expr;
+      return;
+    }
+    if (this->children.empty()) unpack();
+    this->packed.reset();
+    this->packable = false;
+  }
   this->children.emplace_back(expr);
+  if (this->packable && this->children.size() == PACK_THRESHOLD) pack();
 }
 
 Value Vector::evaluate(const std::shared_ptr<const Context>& context) const
 {
+  if (this->packed) return this->packed->clone();
   if (children.size() == 1) {
     Value val = children.front()->evaluate(context);
     // If only 1 EmbeddedVectorType, convert to plain VectorType
@@ -326,6 +407,10 @@ Value Vector::evaluate(const std::shared_ptr<const Context>& context) const
 
 void Vector::print(std::ostream& stream, const std::string&) const
 {
+  if (this->packed) {
+    stream << Value(this->packed->clone());
+    return;
+  }
   stream << "[";
   for (size_t i = 0; i < this->children.size(); ++i) {
     if (i > 0) stream << ", ";
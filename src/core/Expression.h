@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -137,13 +138,20 @@ class Vector : public Expression
 {
 public:
   Vector(const Location& loc);
-  const std::vector<shared_ptr<Expression>>& getChildren() const { return children; }
+  const std::vector<shared_ptr<Expression>>& getChildren() const;
   Value evaluate(const std::shared_ptr<const Context>& context) const override;
   void print(std::ostream& stream, const std::string& indent) const override;
   void emplace_back(Expression *expr);
   bool isLiteral() const override;
 private:
-  std::vector<shared_ptr<Expression>> children;
+  static std::optional<Value> numericValue(const Expression& expr);
+  void pack();
+  void unpack() const;
+
+  mutable std::vector<shared_ptr<Expression>> children;
+  // Large arrays of numeric literals, kept evaluated instead of as children
+  std::optional<Value::VectorType> packed;
+  bool packable{true};
   mutable boost::tribool literal_flag; // cache if already computed
 };
 
@@ -116,6 +116,7 @@ private:
     [[nodiscard]] hb_direction_t detect_direction(const hb_script_t script) const;
 
     friend class FreetypeRenderer;
+    friend class NodeSerializer;
   };
 
   class TextMetrics
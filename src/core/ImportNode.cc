@@ -39,6 +39,7 @@
 #include "DxfData.h"
 #include "Parameters.h"
 #include "printutils.h"
+#include "io/compression.h"
 #include "io/fileutils.h"
 #include "Feature.h"
 #include "handle_dep.h"
@@ -82,7 +83,8 @@ static std::shared_ptr<AbstractNode> do_import(const ModuleInstantiation *inst,
   if (!filename.empty()) handle_dep(filename);
   ImportType actualtype = type;
   if (actualtype == ImportType::UNKNOWN) {
-    std::string extraw = fs::path(filename).extension().generic_string();
+    // The format of e.g. "model.stl.gz" is taken from the suffix before the compression suffix
+    std::string extraw = fs::path(stripCompressionSuffix(filename)).extension().generic_string();
     std::string ext = boost::algorithm::to_lower_copy(extraw);
     if (ext == ".stl") actualtype = ImportType::STL;
     else if (ext == ".off") actualtype = ImportType::OFF;
@@ -135,45 +135,62 @@ static std::shared_ptr<AbstractNode> builtin_linear_extrude(const ModuleInstanti
   return node;
 }
 
+static std::string toString(const LinearExtrudeNode& node, bool fragmentParameters);
+
 std::string LinearExtrudeNode::toString() const
+{
+  return ::toString(*this, true);
+}
+
+/*!
+   $fn, $fa and $fs only affect the result when extruding from a DXF file
+   or when slices or segments are derived from twist or non-uniform scale.
+ */
+std::string LinearExtrudeNode::toIdString() const
+{
+  const bool non_linear = this->twist != 0 || this->scale_x != this->scale_y;
+  return ::toString(*this, !this->filename.empty() || non_linear);
+}
+
+static std::string toString(const LinearExtrudeNode& node, bool fragmentParameters)
 {
   std::ostringstream stream;
 
-  stream << this->name() << "(";
-  if (!this->filename.empty()) { // Ignore deprecated parameters if empty
-    fs::path path((std::string)this->filename);
+  stream << node.name() << "(";
+  if (!node.filename.empty()) { // Ignore deprecated parameters if empty
+    fs::path path((std::string)node.filename);
     stream <<
-      "file = " << this->filename << ", "
-      "layer = " << QuotedString(this->layername) << ", "
-      "origin = [" << this->origin_x << ", " << this->origin_y << "], "
+      "file = " << node.filename << ", "
+      "layer = " << QuotedString(node.layername) << ", "
+      "origin = [" << node.origin_x << ", " << node.origin_y << "], "
            << "timestamp = " << (fs::exists(path) ? fs::last_write_time(path) : 0) << ", "
     ;
   }
-  stream << "height = " << std::dec << this->height;
-  if (this->center) {
+  stream << "height = " << std::dec << node.height;
+  if (node.center) {
     stream << ", center = true";
   }
-  if (this->has_twist) {
-    stream << ", twist = " << this->twist;
+  if (node.has_twist) {
+    stream << ", twist = " << node.twist;
   }
-  if (this->has_slices) {
-    stream << ", slices = " << this->slices;
+  if (node.has_slices) {
+    stream << ", slices = " << node.slices;
   }
-  if (this->has_segments) {
-    stream << ", segments = " << this->segments;
+  if (node.has_segments) {
+    stream << ", segments = " << node.segments;
   }
 
-  if (this->scale_x != this->scale_y) {
-    stream << ", scale = [" << this->scale_x << ", " << this->scale_y << "]";
-  } else if (this->scale_x != 1.0) {
-    stream << ", scale = " << this->scale_x;
+  if (node.scale_x != node.scale_y) {
+    stream << ", scale = [" << node.scale_x << ", " << node.scale_y << "]";
+  } else if (node.scale_x != 1.0) {
+    stream << ", scale = " << node.scale_x;
   }
 
-  if (!(this->has_slices && this->has_segments)) {
-    stream << ", $fn = " << this->fn << ", $fa = " << this->fa << ", $fs = " << this->fs;
+  if (fragmentParameters && !(node.has_slices && node.has_segments)) {
+    stream << ", $fn = " << node.fn << ", $fa = " << node.fa << ", $fs = " << node.fs;
   }
-  if (this->convexity > 1) {
-    stream << ", convexity = " << this->convexity;
+  if (node.convexity > 1) {
+    stream << ", convexity = " << node.convexity;
   }
   stream << ")";
   return stream.str();
@@ -10,6 +10,7 @@ public:
   LinearExtrudeNode(const ModuleInstantiation *mi) : AbstractPolyNode(mi) {
   }
   std::string toString() const override;
+  std::string toIdString() const override;
   std::string name() const override { return "linear_extrude"; }
 
   double height = 100.0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <cassert>
 #include "node.h"
@@ -25,9 +26,14 @@ public:
   }
 
   std::string operator[](const AbstractNode& node) const {
+    return std::string(view(node));
+  }
+
+  // Valid until the root string is replaced
+  std::string_view view(const AbstractNode& node) const {
     // throws std::out_of_range on miss
     auto indexpair = this->cache.at(node.index());
-    return rootString.substr(indexpair.first, indexpair.second - indexpair.first);
+    return std::string_view(rootString).substr(indexpair.first, indexpair.second - indexpair.first);
   }
 
   void insertStart(const size_t nodeidx, const long startindex) {
@@ -0,0 +1,867 @@
+#include "NodeSerializer.h"
+#include "CgalAdvNode.h"
+#include "ColorNode.h"
+#include "CsgOpNode.h"
+#include "ImportNode.h"
+#include "LinearExtrudeNode.h"
+#include "ModuleInstantiation.h"
+#include "OffsetNode.h"
+#include "ProjectionNode.h"
+#include "RenderNode.h"
+#include "RoofNode.h"
+#include "RotateExtrudeNode.h"
+#include "SurfaceNode.h"
+#include "TextNode.h"
+#include "TransformNode.h"
+#include "boost-utils.h"
+#include "primitives.h"
+#include "printutils.h"
+
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const char MAGIC[4] = {'O', 'S', 'C', 'B'};
+
+// Never renumber: the values are stored in files
+enum class NodeType : uint8_t {
+  GROUP, ROOT, LIST, INTERSECTION,
+  CUBE, SPHERE, CYLINDER, POLYHEDRON, SQUARE, CIRCLE, POLYGON,
+  TRANSFORM, CSGOP, COLOR, RENDER, CGALADV,
+  LINEAR_EXTRUDE, ROTATE_EXTRUDE, OFFSET, PROJECTION, ROOF,
+  IMPORT, SURFACE, TEXT
+};
+const uint8_t NODE_TYPE_COUNT = static_cast<uint8_t>(NodeType::TEXT) + 1;
+
+// Flags of a module instantiation
+const uint8_t TAG_ROOT = 1;
+const uint8_t TAG_HIGHLIGHT = 2;
+const uint8_t TAG_BACKGROUND = 4;
+const uint8_t HAS_LOCATION = 8;
+
+class FormatError : public std::runtime_error
+{
+public:
+  FormatError(const std::string& what) : std::runtime_error(what) {}
+};
+
+// Most specific classes first, as some derive from others
+NodeType nodeType(const AbstractNode& node)
+{
+  if (dynamic_cast<const RootNode *>(&node)) return NodeType::ROOT;
+  if (dynamic_cast<const GroupNode *>(&node)) return NodeType::GROUP;
+  if (dynamic_cast<const ListNode *>(&node)) return NodeType::LIST;
+  if (dynamic_cast<const AbstractIntersectionNode *>(&node)) return NodeType::INTERSECTION;
+  if (dynamic_cast<const CubeNode *>(&node)) return NodeType::CUBE;
+  if (dynamic_cast<const SphereNode *>(&node)) return NodeType::SPHERE;
+  if (dynamic_cast<const CylinderNode *>(&node)) return NodeType::CYLINDER;
+  if (dynamic_cast<const PolyhedronNode *>(&node)) return NodeType::POLYHEDRON;
+  if (dynamic_cast<const SquareNode *>(&node)) return NodeType::SQUARE;
+  if (dynamic_cast<const CircleNode *>(&node)) return NodeType::CIRCLE;
+  if (dynamic_cast<const PolygonNode *>(&node)) return NodeType::POLYGON;
+  if (dynamic_cast<const TransformNode *>(&node)) return NodeType::TRANSFORM;
+  if (dynamic_cast<const CsgOpNode *>(&node)) return NodeType::CSGOP;
+  if (dynamic_cast<const ColorNode *>(&node)) return NodeType::COLOR;
+  if (dynamic_cast<const RenderNode *>(&node)) return NodeType::RENDER;
+  if (dynamic_cast<const CgalAdvNode *>(&node)) return NodeType::CGALADV;
+  if (dynamic_cast<const LinearExtrudeNode *>(&node)) return NodeType::LINEAR_EXTRUDE;
+  if (dynamic_cast<const RotateExtrudeNode *>(&node)) return NodeType::ROTATE_EXTRUDE;
+  if (dynamic_cast<const OffsetNode *>(&node)) return NodeType::OFFSET;
+  if (dynamic_cast<const ProjectionNode *>(&node)) return NodeType::PROJECTION;
+  if (dynamic_cast<const RoofNode *>(&node)) return NodeType::ROOF;
+  if (dynamic_cast<const ImportNode *>(&node)) return NodeType::IMPORT;
+  if (dynamic_cast<const SurfaceNode *>(&node)) return NodeType::SURFACE;
+  if (dynamic_cast<const TextNode *>(&node)) return NodeType::TEXT;
+  throw std::invalid_argument("Unsupported node type '" + node.name() + "'");
+}
+
+} // namespace
+
+class NodeSerializer::Writer
+{
+public:
+  Writer(std::ostream& output, const std::string& docPath) : output(output), docPath(docPath) {}
+
+  void tree(const AbstractNode& root);
+
+private:
+  void node(const AbstractNode& node);
+  void byte(uint8_t value) { output.put(static_cast<char>(value)); }
+  void boolean(bool value) { byte(value ? 1 : 0); }
+  void varint(uint64_t value);
+  void integer(int64_t value) { varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63)); }
+  void number(double value) { numbers(&value, 1); }
+  void numbers(const double *values, size_t count);
+  void string(const std::string& value);
+  void path(const std::string& value);
+  void location(const Location& loc);
+  void instantiation(const ModuleInstantiation *inst);
+  template <typename Points> void points(const Points& points);
+  void indices(const std::vector<std::vector<size_t>>& lists);
+  void payload(const AbstractNode& node, NodeType type);
+
+  std::ostream& output;
+  fs::path docPath;
+  std::unordered_map<std::string, uint64_t> strings;
+  std::unordered_map<const ModuleInstantiation *, uint64_t> instantiations;
+  std::unordered_map<const AbstractNode *, uint64_t> nodes;
+};
+
+void NodeSerializer::Writer::varint(uint64_t value)
+{
+  while (value >= 0x80) {
+    byte(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  byte(static_cast<uint8_t>(value));
+}
+
+void NodeSerializer::Writer::numbers(const double *values, size_t count)
+{
+  if constexpr (boost::endian::order::native == boost::endian::order::little) {
+    output.write(reinterpret_cast<const char *>(values), static_cast<std::streamsize>(count * sizeof(double)));
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t bits;
+      std::memcpy(&bits, values + i, sizeof(bits));
+      bits = boost::endian::native_to_little(bits);
+      output.write(reinterpret_cast<const char *>(&bits), sizeof(bits));
+    }
+  }
+}
+
+// Strings are written once, then referred to by index + 1
+void NodeSerializer::Writer::string(const std::string& value)
+{
+  auto it = strings.find(value);
+  if (it != strings.end()) {
+    varint(it->second + 1);
+    return;
+  }
+  varint(0);
+  varint(value.size());
+  output.write(value.data(), static_cast<std::streamsize>(value.size()));
+  strings.emplace(value, strings.size());
+}
+
+void NodeSerializer::Writer::path(const std::string& value)
+{
+  string(value.empty() ? value : boostfs_uncomplete(fs::path(value), docPath).generic_string());
+}
+
+void NodeSerializer::Writer::location(const Location& loc)
+{
+  path(loc.fileName());
+  integer(loc.firstLine());
+  integer(loc.firstColumn());
+  integer(loc.lastLine());
+  integer(loc.lastColumn());
+}
+
+void NodeSerializer::Writer::instantiation(const ModuleInstantiation *inst)
+{
+  auto it = instantiations.find(inst);
+  if (it != instantiations.end()) {
+    varint(it->second + 1);
+    return;
+  }
+  varint(0);
+  string(inst->name());
+  const bool hasLocation = !inst->location().isNone();
+  byte((inst->tag_root ? TAG_ROOT : 0) | (inst->tag_highlight ? TAG_HIGHLIGHT : 0) |
+       (inst->tag_background ? TAG_BACKGROUND : 0) | (hasLocation ? HAS_LOCATION : 0));
+  if (hasLocation) location(inst->location());
+  instantiations.emplace(inst, instantiations.size());
+}
+
+template <typename Points>
+void NodeSerializer::Writer::points(const Points& points)
+{
+  using Point = typename Points::value_type;
+  constexpr size_t dim = Point::SizeAtCompileTime;
+  static_assert(sizeof(Point) == dim * sizeof(double), "points are written as one array of doubles");
+  varint(points.size());
+  if (!points.empty()) numbers(points[0].data(), points.size() * dim);
+}
+
+void NodeSerializer::Writer::indices(const std::vector<std::vector<size_t>>& lists)
+{
+  varint(lists.size());
+  for (const auto& list : lists) {
+    varint(list.size());
+    for (const auto index : list) varint(index);
+  }
+}
+
+/*!
+   Writes a node and its children, or a back reference if it was
+   written before. Nodes are numbered after their children, so references
+   only ever point to complete subtrees.
+ */
+void NodeSerializer::Writer::node(const AbstractNode& node)
+{
+  auto it = nodes.find(&node);
+  if (it != nodes.end()) {
+    varint(it->second + 1);
+    return;
+  }
+  varint(0);
+
+  const auto type = nodeType(node);
+  byte(static_cast<uint8_t>(type));
+  instantiation(node.modinst);
+  payload(node, type);
+  varint(node.children.size());
+  for (const auto& child : node.children) this->node(*child);
+  nodes.emplace(&node, nodes.size());
+}
+
+void NodeSerializer::Writer::payload(const AbstractNode& node, NodeType type)
+{
+  switch (type) {
+  case NodeType::GROUP:
+    string(node.verbose_name());
+    break;
+  case NodeType::ROOT:
+  case NodeType::LIST:
+  case NodeType::INTERSECTION:
+    break;
+  case NodeType::CUBE: {
+    const auto& n = static_cast<const CubeNode&>(node);
+    number(n.x);
+    number(n.y);
+    number(n.z);
+    boolean(n.center);
+    break;
+  }
+  case NodeType::SPHERE: {
+    const auto& n = static_cast<const SphereNode&>(node);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.r);
+    break;
+  }
+  case NodeType::CYLINDER: {
+    const auto& n = static_cast<const CylinderNode&>(node);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.r1);
+    number(n.r2);
+    number(n.h);
+    boolean(n.center);
+    break;
+  }
+  case NodeType::POLYHEDRON: {
+    const auto& n = static_cast<const PolyhedronNode&>(node);
+    points(n.points);
+    indices(n.faces);
+    integer(n.convexity);
+    break;
+  }
+  case NodeType::SQUARE: {
+    const auto& n = static_cast<const SquareNode&>(node);
+    number(n.x);
+    number(n.y);
+    boolean(n.center);
+    break;
+  }
+  case NodeType::CIRCLE: {
+    const auto& n = static_cast<const CircleNode&>(node);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.r);
+    break;
+  }
+  case NodeType::POLYGON: {
+    const auto& n = static_cast<const PolygonNode&>(node);
+    points(n.points);
+    indices(n.paths);
+    integer(n.convexity);
+    break;
+  }
+  case NodeType::TRANSFORM: {
+    const auto& n = static_cast<const TransformNode&>(node);
+    string(n.verbose_name());
+    numbers(n.matrix.matrix().data(), 16);
+    break;
+  }
+  case NodeType::CSGOP:
+    byte(static_cast<uint8_t>(static_cast<const CsgOpNode&>(node).type));
+    break;
+  case NodeType::COLOR: {
+    const auto& n = static_cast<const ColorNode&>(node);
+    for (int i = 0; i < 4; ++i) number(n.color[i]);
+    break;
+  }
+  case NodeType::RENDER:
+    integer(static_cast<const RenderNode&>(node).convexity);
+    break;
+  case NodeType::CGALADV: {
+    const auto& n = static_cast<const CgalAdvNode&>(node);
+    byte(static_cast<uint8_t>(n.type));
+    varint(n.convexity);
+    numbers(n.newsize.data(), 3);
+    for (int i = 0; i < 3; ++i) boolean(n.autosize[i]);
+    break;
+  }
+  case NodeType::LINEAR_EXTRUDE: {
+    const auto& n = static_cast<const LinearExtrudeNode&>(node);
+    number(n.height);
+    number(n.origin_x);
+    number(n.origin_y);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.scale_x);
+    number(n.scale_y);
+    number(n.twist);
+    varint(n.convexity);
+    varint(n.slices);
+    varint(n.segments);
+    boolean(n.has_twist);
+    boolean(n.has_slices);
+    boolean(n.has_segments);
+    boolean(n.center);
+    path(n.filename);
+    string(n.layername);
+    break;
+  }
+  case NodeType::ROTATE_EXTRUDE: {
+    const auto& n = static_cast<const RotateExtrudeNode&>(node);
+    integer(n.convexity);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.origin_x);
+    number(n.origin_y);
+    number(n.scale);
+    number(n.angle);
+    path(n.filename);
+    string(n.layername);
+    break;
+  }
+  case NodeType::OFFSET: {
+    const auto& n = static_cast<const OffsetNode&>(node);
+    boolean(n.chamfer);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.delta);
+    number(n.miter_limit);
+    byte(static_cast<uint8_t>(n.join_type));
+    break;
+  }
+  case NodeType::PROJECTION: {
+    const auto& n = static_cast<const ProjectionNode&>(node);
+    integer(n.convexity);
+    boolean(n.cut_mode);
+    break;
+  }
+  case NodeType::ROOF: {
+    const auto& n = static_cast<const RoofNode&>(node);
+    number(n.fa);
+    number(n.fs);
+    number(n.fn);
+    integer(n.convexity);
+    string(n.method);
+    break;
+  }
+  case NodeType::IMPORT: {
+    const auto& n = static_cast<const ImportNode&>(node);
+    byte(static_cast<uint8_t>(n.type));
+    path(n.filename);
+    boolean(n.id.has_value());
+    if (n.id) string(*n.id);
+    boolean(n.layer.has_value());
+    if (n.layer) string(*n.layer);
+    integer(n.convexity);
+    boolean(n.center);
+    number(n.dpi);
+    number(n.fn);
+    number(n.fs);
+    number(n.fa);
+    number(n.origin_x);
+    number(n.origin_y);
+    number(n.scale);
+    number(n.width);
+    number(n.height);
+    break;
+  }
+  case NodeType::SURFACE: {
+    const auto& n = static_cast<const SurfaceNode&>(node);
+    path(n.filename);
+    boolean(n.center);
+    boolean(n.invert);
+    integer(n.convexity);
+    break;
+  }
+  case NodeType::TEXT: {
+    const auto& p = static_cast<const TextNode&>(node).params;
+    number(p.size);
+    number(p.spacing);
+    number(p.fn);
+    number(p.fa);
+    number(p.fs);
+    varint(p.segments);
+    string(p.text);
+    string(p.font);
+    string(p.direction);
+    string(p.language);
+    string(p.script);
+    string(p.halign);
+    string(p.valign);
+    boolean(!p.loc.isNone());
+    if (!p.loc.isNone()) location(p.loc);
+    break;
+  }
+  }
+}
+
+void NodeSerializer::Writer::tree(const AbstractNode& root)
+{
+  output.write(MAGIC, sizeof(MAGIC));
+  varint(VERSION);
+  node(root);
+}
+
+void NodeSerializer::write(const AbstractNode& root, const std::string& docPath, std::ostream& output)
+{
+  Writer(output, docPath).tree(root);
+}
+
+class NodeSerializer::Reader
+{
+public:
+  Reader(const std::string& data, const std::string& docPath) : pos(data.data()), end(data.data() + data.size()), docPath(docPath) {}
+
+  std::shared_ptr<AbstractNode> tree();
+
+  std::vector<std::unique_ptr<ModuleInstantiation>> ownedInstantiations;
+
+private:
+  std::shared_ptr<AbstractNode> node();
+  void need(size_t bytes) const
+  {
+    if (static_cast<size_t>(end - pos) < bytes) throw FormatError("Unexpected end of data");
+  }
+  uint8_t byte() { need(1); return static_cast<uint8_t>(*pos++); }
+  bool boolean() { return byte() != 0; }
+  uint64_t varint();
+  size_t count(size_t elementSize);
+  int64_t integer() { const auto value = varint(); return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+  int intValue();
+  double number() { double value; numbers(&value, 1); return value; }
+  void numbers(double *values, size_t count);
+  const std::string& string();
+  std::string path();
+  Location location();
+  const ModuleInstantiation *instantiation();
+  template <typename Points> void points(Points& points);
+  void indices(std::vector<std::vector<size_t>>& lists, size_t npoints);
+  template <typename E> E enumValue(E last);
+  std::shared_ptr<AbstractNode> payload(NodeType type, const ModuleInstantiation *inst);
+
+  const char *pos;
+  const char *end;
+  fs::path docPath;
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, std::shared_ptr<fs::path>> paths; // shared by the locations
+  std::vector<const ModuleInstantiation *> instantiations;
+  std::vector<std::shared_ptr<AbstractNode>> nodes;
+  // Nesting depth of the node being read, limited so a malformed file can't
+  // exhaust the stack
+  static constexpr size_t MAX_DEPTH = 10000;
+  size_t depth{0};
+};
+
+std::shared_ptr<AbstractNode> NodeSerializer::Reader::tree()
+{
+  need(sizeof(MAGIC));
+  if (std::memcmp(pos, MAGIC, sizeof(MAGIC)) != 0) throw FormatError("Not a binary node tree");
+  pos += sizeof(MAGIC);
+  const auto version = varint();
+  if (version != VERSION) throw FormatError("Unsupported format version " + std::to_string(version));
+  auto root = node();
+  if (pos != end) throw FormatError("Unexpected data after the tree");
+  return root;
+}
+
+uint64_t NodeSerializer::Reader::varint()
+{
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t b = byte();
+    value |= static_cast<uint64_t>(b & 0x7f) << shift;
+    if (!(b & 0x80)) return value;
+  }
+  throw FormatError("Invalid integer");
+}
+
+// Reads an element count, checking the elements can be there at all
+size_t NodeSerializer::Reader::count(size_t elementSize)
+{
+  const auto n = varint();
+  if (n > static_cast<uint64_t>(end - pos) / std::max<size_t>(elementSize, 1)) throw FormatError("Invalid element count");
+  return static_cast<size_t>(n);
+}
+
+int NodeSerializer::Reader::intValue()
+{
+  const auto value = integer();
+  if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) throw FormatError("Integer out of range");
+  return static_cast<int>(value);
+}
+
+void NodeSerializer::Reader::numbers(double *values, size_t count)
+{
+  need(count * sizeof(double));
+  std::memcpy(values, pos, count * sizeof(double));
+  pos += count * sizeof(double);
+  if constexpr (boost::endian::order::native != boost::endian::order::little) {
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t bits;
+      std::memcpy(&bits, values + i, sizeof(bits));
+      bits = boost::endian::little_to_native(bits);
+      std::memcpy(values + i, &bits, sizeof(bits));
+    }
+  }
+}
+
+const std::string& NodeSerializer::Reader::string()
+{
+  const auto ref = varint();
+  if (ref > 0) {
+    if (ref > strings.size()) throw FormatError("Invalid string reference");
+    return strings[ref - 1];
+  }
+  const auto length = count(1);
+  strings.emplace_back(pos, length);
+  pos += length;
+  return strings.back();
+}
+
+std::string NodeSerializer::Reader::path()
+{
+  const auto& value = string();
+  return value.empty() ? value : fs::absolute(fs::path(value), docPath).generic_string();
+}
+
+Location NodeSerializer::Reader::location()
+{
+  const auto filename = path();
+  auto& filepath = paths[filename];
+  if (!filepath) filepath = std::make_shared<fs::path>(filename);
+  const int firstLine = intValue(), firstColumn = intValue(), lastLine = intValue(), lastColumn = intValue();
+  return {firstLine, firstColumn, lastLine, lastColumn, filepath};
+}
+
+const ModuleInstantiation *NodeSerializer::Reader::instantiation()
+{
+  const auto ref = varint();
+  if (ref > 0) {
+    if (ref > instantiations.size()) throw FormatError("Invalid module instantiation reference");
+    return instantiations[ref - 1];
+  }
+  auto inst = std::make_unique<ModuleInstantiation>(string());
+  const auto flags = byte();
+  inst->tag_root = flags & TAG_ROOT;
+  inst->tag_highlight = flags & TAG_HIGHLIGHT;
+  inst->tag_background = flags & TAG_BACKGROUND;
+  if (flags & HAS_LOCATION) inst->setLocation(location());
+  instantiations.push_back(inst.get());
+  ownedInstantiations.push_back(std::move(inst));
+  return instantiations.back();
+}
+
+template <typename Points>
+void NodeSerializer::Reader::points(Points& points)
+{
+  using Point = typename Points::value_type;
+  constexpr size_t dim = Point::SizeAtCompileTime;
+  static_assert(sizeof(Point) == dim * sizeof(double), "points are read as one array of doubles");
+  points.resize(count(sizeof(Point)));
+  if (!points.empty()) numbers(points[0].data(), points.size() * dim);
+}
+
+// Reads index lists, checking the indices against the number of points
+void NodeSerializer::Reader::indices(std::vector<std::vector<size_t>>& lists, size_t npoints)
+{
+  lists.resize(count(1));
+  for (auto& list : lists) {
+    list.resize(count(1));
+    for (auto& index : list) {
+      const auto value = varint();
+      if (value >= npoints) throw FormatError("Point index out of bounds");
+      index = static_cast<size_t>(value);
+    }
+  }
+}
+
+template <typename E>
+E NodeSerializer::Reader::enumValue(E last)
+{
+  const auto value = byte();
+  if (value > static_cast<uint8_t>(last)) throw FormatError("Invalid enum value");
+  return static_cast<E>(value);
+}
+
+/*!
+   Reads a node and its children. Like the writer, registers the node only
+   once its children are read, so a reference can't create a cycle.
+ */
+std::shared_ptr<AbstractNode> NodeSerializer::Reader::node()
+{
+  const auto ref = varint();
+  if (ref > 0) {
+    if (ref > nodes.size()) throw FormatError("Invalid node reference");
+    return nodes[ref - 1];
+  }
+  const auto type = byte();
+  if (type >= NODE_TYPE_COUNT) throw FormatError("Invalid node type " + std::to_string(type));
+  const auto inst = instantiation();
+  auto node = payload(static_cast<NodeType>(type), inst);
+
+  if (++depth > MAX_DEPTH) throw FormatError("Nodes nested too deeply");
+  node->children.resize(count(1));
+  for (auto& child : node->children) child = this->node();
+  --depth;
+  nodes.push_back(node);
+  return node;
+}
+
+std::shared_ptr<AbstractNode> NodeSerializer::Reader::payload(NodeType type, const ModuleInstantiation *inst)
+{
+  switch (type) {
+  case NodeType::GROUP:
+    return std::make_shared<GroupNode>(inst, string());
+  case NodeType::ROOT:
+    return std::make_shared<RootNode>();
+  case NodeType::LIST:
+    return std::make_shared<ListNode>(inst);
+  case NodeType::INTERSECTION:
+    return std::make_shared<AbstractIntersectionNode>(inst);
+  case NodeType::CUBE: {
+    auto n = std::make_shared<CubeNode>(inst);
+    n->x = number();
+    n->y = number();
+    n->z = number();
+    n->center = boolean();
+    return n;
+  }
+  case NodeType::SPHERE: {
+    auto n = std::make_shared<SphereNode>(inst);
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->r = number();
+    return n;
+  }
+  case NodeType::CYLINDER: {
+    auto n = std::make_shared<CylinderNode>(inst);
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->r1 = number();
+    n->r2 = number();
+    n->h = number();
+    n->center = boolean();
+    return n;
+  }
+  case NodeType::POLYHEDRON: {
+    auto n = std::make_shared<PolyhedronNode>(inst);
+    points(n->points);
+    indices(n->faces, n->points.size());
+    n->convexity = intValue();
+    return n;
+  }
+  case NodeType::SQUARE: {
+    auto n = std::make_shared<SquareNode>(inst);
+    n->x = number();
+    n->y = number();
+    n->center = boolean();
+    return n;
+  }
+  case NodeType::CIRCLE: {
+    auto n = std::make_shared<CircleNode>(inst);
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->r = number();
+    return n;
+  }
+  case NodeType::POLYGON: {
+    auto n = std::make_shared<PolygonNode>(inst);
+    points(n->points);
+    indices(n->paths, n->points.size());
+    n->convexity = intValue();
+    return n;
+  }
+  case NodeType::TRANSFORM: {
+    auto n = std::make_shared<TransformNode>(inst, string());
+    numbers(n->matrix.matrix().data(), 16);
+    return n;
+  }
+  case NodeType::CSGOP:
+    return std::make_shared<CsgOpNode>(inst, enumValue(OpenSCADOperator::RESIZE));
+  case NodeType::COLOR: {
+    auto n = std::make_shared<ColorNode>(inst);
+    for (int i = 0; i < 4; ++i) n->color[i] = static_cast<float>(number());
+    return n;
+  }
+  case NodeType::RENDER: {
+    auto n = std::make_shared<RenderNode>(inst);
+    n->convexity = intValue();
+    return n;
+  }
+  case NodeType::CGALADV: {
+    auto n = std::make_shared<CgalAdvNode>(inst, enumValue(CgalAdvType::RESIZE));
+    n->convexity = static_cast<unsigned int>(varint());
+    numbers(n->newsize.data(), 3);
+    for (int i = 0; i < 3; ++i) n->autosize[i] = boolean();
+    return n;
+  }
+  case NodeType::LINEAR_EXTRUDE: {
+    auto n = std::make_shared<LinearExtrudeNode>(inst);
+    n->height = number();
+    n->origin_x = number();
+    n->origin_y = number();
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->scale_x = number();
+    n->scale_y = number();
+    n->twist = number();
+    n->convexity = static_cast<unsigned int>(varint());
+    n->slices = static_cast<unsigned int>(varint());
+    n->segments = static_cast<unsigned int>(varint());
+    n->has_twist = boolean();
+    n->has_slices = boolean();
+    n->has_segments = boolean();
+    n->center = boolean();
+    n->filename = path();
+    n->layername = string();
+    return n;
+  }
+  case NodeType::ROTATE_EXTRUDE: {
+    auto n = std::make_shared<RotateExtrudeNode>(inst);
+    n->convexity = intValue();
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->origin_x = number();
+    n->origin_y = number();
+    n->scale = number();
+    n->angle = number();
+    n->filename = path();
+    n->layername = string();
+    return n;
+  }
+  case NodeType::OFFSET: {
+    auto n = std::make_shared<OffsetNode>(inst);
+    n->chamfer = boolean();
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->delta = number();
+    n->miter_limit = number();
+    n->join_type = enumValue(ClipperLib::jtMiter);
+    return n;
+  }
+  case NodeType::PROJECTION: {
+    auto n = std::make_shared<ProjectionNode>(inst);
+    n->convexity = intValue();
+    n->cut_mode = boolean();
+    return n;
+  }
+  case NodeType::ROOF: {
+    auto n = std::make_shared<RoofNode>(inst);
+    n->fa = number();
+    n->fs = number();
+    n->fn = number();
+    n->convexity = intValue();
+    n->method = string();
+    return n;
+  }
+  case NodeType::IMPORT: {
+    auto n = std::make_shared<ImportNode>(inst, enumValue(ImportType::OBJ));
+    n->filename = path();
+    if (boolean()) n->id = string();
+    if (boolean()) n->layer = string();
+    n->convexity = intValue();
+    n->center = boolean();
+    n->dpi = number();
+    n->fn = number();
+    n->fs = number();
+    n->fa = number();
+    n->origin_x = number();
+    n->origin_y = number();
+    n->scale = number();
+    n->width = number();
+    n->height = number();
+    return n;
+  }
+  case NodeType::SURFACE: {
+    auto n = std::make_shared<SurfaceNode>(inst);
+    n->filename = path();
+    n->center = boolean();
+    n->invert = boolean();
+    n->convexity = intValue();
+    return n;
+  }
+  case NodeType::TEXT: {
+    auto n = std::make_shared<TextNode>(inst);
+    auto& p = n->params;
+    p.set_size(number());
+    p.set_spacing(number());
+    p.set_fn(number());
+    p.set_fa(number());
+    p.set_fs(number());
+    p.set_segments(static_cast<unsigned int>(varint()));
+    p.set_text(string());
+    p.set_font(string());
+    p.set_direction(string());
+    p.set_language(string());
+    p.set_script(string());
+    p.set_halign(string());
+    p.set_valign(string());
+    if (boolean()) p.set_loc(location());
+    p.set_documentPath(docPath.generic_string());
+    return n;
+  }
+  }
+  throw FormatError("Invalid node type");
+}
+
+std::shared_ptr<AbstractNode> NodeSerializer::read(std::istream& input, const std::string& docPath)
+{
+  const std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+  // Keeps the module instantiations alive as long as the nodes
+  struct Tree {
+    std::vector<std::unique_ptr<ModuleInstantiation>> instantiations;
+    std::shared_ptr<AbstractNode> root;
+  };
+  auto tree = std::make_shared<Tree>();
+  try {
+    AbstractNode::resetIndexCounter();
+    Reader reader(data, docPath);
+    auto root = reader.tree();
+    tree->instantiations = std::move(reader.ownedInstantiations);
+    tree->root = std::move(root);
+  } catch (const FormatError& e) {
+    LOG(message_group::Error, "Invalid binary node tree: %1$s", e.what());
+    return nullptr;
+  }
+  return {tree, tree->root.get()};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+#include "node.h"
+
+/*!
+   Binary interchange format of an evaluated node tree (.csgb).
+
+   Unlike the .csg export, loading doesn't lex, parse or evaluate anything:
+   nodes are created with the parameters they were evaluated to, point
+   arrays are stored packed, and the module instantiations keep their
+   locations so warnings still point into the original sources.
+   Evaluation and geometry rendering can so run on different machines.
+
+   Layout: "OSCB", format version, then the root node. Strings, module
+   instantiations and nodes are written in full the first time and as
+   back references after that, so shared subtrees are stored once. Nodes
+   are numbered after their children, so references can't form cycles.
+   Nesting is limited to a depth of 10000.
+   Numbers are little endian; integers are variable length.
+
+   File names (imports, surfaces, locations) are stored relative to the
+   document path and resolved against the document path given on reading.
+ */
+class NodeSerializer
+{
+public:
+  static const unsigned int VERSION = 2;
+
+  static void write(const AbstractNode& root, const std::string& docPath, std::ostream& output);
+
+  /*!
+     Returns nullptr, logging the reason, if \a input isn't a valid tree.
+     The returned pointer also owns the module instantiations the nodes
+     refer to, so it must outlive any other pointer into the tree.
+   */
+  static std::shared_ptr<AbstractNode> read(std::istream& input, const std::string& docPath);
+
+private:
+  class Writer;
+  class Reader;
+};
@@ -0,0 +1,61 @@
+#include "PathCache.h"
+#include "printutils.h"
+
+PathCache *PathCache::inst = nullptr;
+
+/*!
+   Returns the cached path for the given key, which may be empty for files
+   which couldn't be found. Counts the lookups and hits for print().
+ */
+boost::optional<std::string> PathCache::lookup(const std::string& key)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  ++this->lookup_count;
+  auto it = this->entries.find(key);
+  if (it == this->entries.end()) return boost::none;
+  ++this->hit_count;
+  return it->second;
+}
+
+void PathCache::insert(const std::string& key, const std::string& path)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->entries[key] = path;
+}
+
+size_t PathCache::size() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->entries.size();
+}
+
+size_t PathCache::lookups() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->lookup_count;
+}
+
+size_t PathCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hit_count;
+}
+
+/*!
+   Forgets all paths, and starts counting lookups anew.
+ */
+void PathCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->entries.clear();
+  this->lookup_count = 0;
+  this->hit_count = 0;
+}
+
+void PathCache::print()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->lookup_count == 0) return;
+  LOG("Path lookups: %1$d, cached: %2$d (%3$d%%)", this->lookup_count, this->hit_count,
+      100 * this->hit_count / this->lookup_count);
+}
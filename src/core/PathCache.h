@@ -0,0 +1,40 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <boost/optional.hpp>
+
+/*!
+   Caches the results of resolving file names against the filesystem, like
+   finding used libraries and imported files, which would otherwise probe
+   the same paths again for every lookup.
+
+   Results are kept until clear() is called, which must happen whenever
+   files may have appeared or disappeared, e.g. before an explicit reload or
+   when a file watcher reported a change. Access is serialized, as animation
+   frames may be instantiated on a worker thread.
+ */
+class PathCache
+{
+public:
+  static PathCache *instance() { if (!inst) inst = new PathCache; return inst; }
+
+  boost::optional<std::string> lookup(const std::string& key);
+  void insert(const std::string& key, const std::string& path);
+  size_t size() const;
+  size_t lookups() const;
+  size_t hits() const;
+  void clear();
+  void print();
+
+private:
+  PathCache() = default;
+
+  static PathCache *inst;
+
+  mutable std::mutex mutex;
+  std::unordered_map<std::string, std::string> entries;
+  size_t lookup_count{0};
+  size_t hit_count{0};
+};
@@ -99,6 +99,7 @@ UserModuleContext::UserModuleContext(const std::shared_ptr<const Context>& paren
   ScopeContext(parent, &module->body),
   children(std::move(children))
 {
+  this->children.module_context = this;
   set_variable("$children", Value(double(this->children.size())));
   set_variable("$parent_modules", Value(double(StaticModuleNameStack::size())));
   apply_variables(Parameters::parse(std::move(arguments), loc, module->parameters, parent).to_context_frame());
@@ -34,6 +34,7 @@
 #include "StatCache.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <algorithm>
 #include <utility>
 namespace fs = boost::filesystem;
 #include "FontCache.h"
@@ -166,6 +167,36 @@ time_t SourceFile::handleDependencies(bool is_root)
   return latest;
 }
 
+/*!
+   Adds the files included or used by this file, and by the files it uses, to \a files.
+   Call after handleDependencies(). Returns false if a used library couldn't be located.
+ */
+bool SourceFile::collectDependencies(std::unordered_set<std::string>& files) const
+{
+  auto complete = true;
+  for (const auto& item : this->includes) files.insert(item.second);
+  for (const auto& filename : this->usedlibs) {
+    if (!fs::path(filename).is_absolute()) {
+      complete = false;
+      continue;
+    }
+    if (!files.insert(filename).second) continue;
+    if (auto lib = SourceFileCache::instance()->lookup(filename)) {
+      if (!lib->collectDependencies(files)) complete = false;
+    } else {
+      // Compile error, so its includes are unknown
+      complete = false;
+    }
+  }
+  return complete;
+}
+
+bool SourceFile::hasInclude(const std::string& fullpath) const
+{
+  return std::any_of(this->includes.begin(), this->includes.end(),
+                     [&](const auto& item) { return item.second == fullpath; });
+}
+
 std::shared_ptr<AbstractNode> SourceFile::instantiate(const std::shared_ptr<const Context>& context, std::shared_ptr<const FileContext> *resulting_file_context) const
 {
   auto node = std::make_shared<RootNode>();
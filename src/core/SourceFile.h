@@ -23,6 +23,8 @@ public:
   void registerInclude(const std::string& localpath, const std::string& fullpath, const Location& loc);
   std::time_t includesChanged() const;
   std::time_t handleDependencies(bool is_root = true);
+  bool collectDependencies(std::unordered_set<std::string>& files) const;
+  bool hasInclude(const std::string& fullpath) const;
   bool hasIncludes() const { return !this->includes.empty(); }
   bool usesLibraries() const { return !this->usedlibs.empty(); }
   bool isHandlingDependencies() const { return this->is_handling_dependencies; }
@@ -117,6 +117,19 @@ std::time_t SourceFileCache::evaluate(const std::string& mainFile, const std::st
   return std::max({deps_mtime, cacheEntry.mtime, cacheEntry.includes_mtime});
 }
 
+/*!
+   Makes evaluate() recompile the given file and the files including it, e.g.
+   when a file watcher reported a change too quick to show in the modification time.
+ */
+void SourceFileCache::invalidate(const std::string& filename)
+{
+  for (auto& [name, entry] : this->entries) {
+    if (name == filename || (entry.parsed_file && entry.parsed_file->hasInclude(filename))) {
+      entry.cache_id.clear();
+    }
+  }
+}
+
 void SourceFileCache::clear()
 {
   this->entries.clear();
@@ -16,6 +16,7 @@ public:
 
   std::time_t evaluate(const std::string& mainFile, const std::string& filename, SourceFile *& sourceFile);
   SourceFile *lookup(const std::string& filename);
+  void invalidate(const std::string& filename);
   size_t size() const { return this->entries.size(); }
   void clear();
   static void clear_markers();
@@ -28,6 +28,8 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <chrono>
 
 namespace {
@@ -46,6 +48,7 @@ struct CacheEntry
 };
 
 std::unordered_map<std::string, CacheEntry> statMap;
+std::unordered_set<std::string> watchedPaths;
 
 } // namespace
 
@@ -55,7 +58,7 @@ int stat(const std::string& path, struct ::stat &st)
 {
   auto iter = statMap.find(path);
   if (iter != statMap.end()) {                // Have we got an entry for this file?
-    if (millis_clock() - iter->second.timestamp < stale) {
+    if (watchedPaths.count(path) || millis_clock() - iter->second.timestamp < stale) {
       st = iter->second.st;      // Not stale yet so return it
       return 0;
     }
@@ -66,4 +69,14 @@ int stat(const std::string& path, struct ::stat &st)
   return 0;
 }
 
+void setWatched(std::unordered_set<std::string> paths)
+{
+  watchedPaths = std::move(paths);
+}
+
+void invalidate(const std::string& path)
+{
+  statMap.erase(path);
+}
+
 } // namespace StatCache
@@ -27,10 +27,14 @@
 #pragma once
 
 #include <string>
+#include <unordered_set>
 #include <sys/stat.h>
 
 namespace StatCache {
 
 int stat(const std::string& path, struct ::stat& st);
+// Entries for watched paths don't expire, their changes are reported with invalidate()
+void setWatched(std::unordered_set<std::string> paths);
+void invalidate(const std::string& path);
 
 }
@@ -41,6 +41,16 @@ const std::string Tree::getString(const AbstractNode& node, const std::string& i
    strip to enable cache hits for equivalent nodes from different scopes.
  */
 const std::string Tree::getIdString(const AbstractNode& node) const
+{
+  return std::string(getIdView(node));
+}
+
+/*!
+   Like getIdString(), but without copying the ID string out of the cache.
+   The view stays valid until the cache is rebuilt, i.e. until an ID string
+   of a node which is not cached is requested or the root is replaced.
+ */
+std::string_view Tree::getIdView(const AbstractNode& node) const
 {
   assert(this->root_node);
   const std::string indent = "";
@@ -56,7 +66,7 @@ const std::string Tree::getIdString(const AbstractNode& node) const
     assert(nodecache.contains(*this->root_node) &&
            "NodeDumper failed to create id cache");
   }
-  return nodecache[node];
+  return nodecache.view(node);
 }
 
 /*!
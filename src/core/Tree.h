@@ -2,6 +2,7 @@
 
 #include "NodeCache.h"
 #include <map>
+#include <string_view>
 #include <utility>
 
 /*!
@@ -22,6 +23,7 @@ public:
 
   const std::string getString(const AbstractNode& node, const std::string& indent) const;
   const std::string getIdString(const AbstractNode& node) const;
+  std::string_view getIdView(const AbstractNode& node) const;
   const std::string getDocumentPath() const;
 
 private:
@@ -26,6 +26,7 @@
 
 #include "function.h"
 #include "Arguments.h"
+#include "EvaluationSession.h"
 #include "Expression.h"
 #include "Builtins.h"
 #include "printutils.h"
@@ -156,6 +157,8 @@ Value builtin_rands(Arguments arguments, const Location& loc)
   }
   auto numresults = boost_numeric_cast<size_t, double>(numresultsd);
 
+  // Seeded or not, the generator state is shared by all calls
+  if (arguments.session()) arguments.session()->add_side_effect();
   if (arguments.size() > 3) {
     auto seed = static_cast<uint32_t>(hash_floating_point(arguments[3]->toDouble() ));
     deterministic_rng.seed(seed);
@@ -1,6 +1,13 @@
 #include "ParameterSet.h"
+#include "compression.h"
 #include "printutils.h"
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
 
 static std::string parameterSetsKey("parameterSets");
 static std::string fileFormatVersionKey("fileFormatVersion");
@@ -54,3 +61,157 @@ void ParameterSets::writeFile(const std::string& filename) const
     LOG(message_group::Error, "Cannot write Parameter Set '%1$s': %2$s", filename, e.what());
   }
 }
+
+// Splits at commas which are not nested inside brackets or quotes
+static std::vector<std::string> splitValueList(const std::string& list)
+{
+  std::vector<std::string> values;
+  std::string current;
+  int depth = 0;
+  bool quoted = false;
+  for (char c : list) {
+    if (c == '"') quoted = !quoted;
+    else if (!quoted && c == '[') depth++;
+    else if (!quoted && c == ']') depth--;
+    if (c == ',' && depth == 0 && !quoted) {
+      values.push_back(boost::algorithm::trim_copy(current));
+      current.clear();
+    } else {
+      current += c;
+    }
+  }
+  values.push_back(boost::algorithm::trim_copy(current));
+
+  // Quotes only protect commas, string parameters take the raw value
+  for (auto& value : values) {
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+      value = value.substr(1, value.size() - 2);
+    }
+  }
+  return values;
+}
+
+static bool parseRange(const std::string& spec, std::vector<std::string>& values)
+{
+  if (spec.size() < 2 || spec.front() != '[' || spec.back() != ']') return false;
+  std::vector<std::string> parts;
+  const auto inner = spec.substr(1, spec.size() - 2);
+  boost::algorithm::split(parts, inner, boost::algorithm::is_any_of(":"));
+  if (parts.size() != 2 && parts.size() != 3) return false;
+
+  std::vector<double> numbers;
+  for (const auto& part : parts) {
+    std::istringstream stream(boost::algorithm::trim_copy(part));
+    double number;
+    stream >> number;
+    if (!stream || !stream.eof() || !std::isfinite(number)) return false;
+    numbers.push_back(number);
+  }
+  const double begin = numbers.front();
+  const double end = numbers.back();
+  const double step = numbers.size() == 3 ? numbers[1] : 1.0;
+  if (step <= 0 || end < begin) return false;
+
+  // Same tolerance as RangeType, to include the end value despite rounding
+  const double count = std::floor((end - begin) / step + 1e-9);
+  if (count >= ParameterSweep::maxVariants) {
+    LOG(message_group::Error, "Parameter sweep range '%1$s' has more than %2$d values", spec, ParameterSweep::maxVariants);
+    return true; // a range, but without values
+  }
+  const auto steps = static_cast<size_t>(count);
+  for (size_t i = 0; i <= steps; ++i) {
+    boost::property_tree::ptree value;
+    value.put_value<double>(begin + i * step);
+    values.push_back(value.data());
+  }
+  return true;
+}
+
+bool ParameterSweep::addSpec(const std::string& spec)
+{
+  const auto pos = spec.find('=');
+  if (pos == std::string::npos || pos == 0) {
+    LOG(message_group::Error, "Invalid parameter sweep '%1$s', expected name=values", spec);
+    return false;
+  }
+  const auto name = boost::algorithm::trim_copy(spec.substr(0, pos));
+  const auto valuespec = boost::algorithm::trim_copy(spec.substr(pos + 1));
+
+  std::vector<std::string> values;
+  // Vector parameters are given as a list of vectors, e.g. "[1,2],[3,4]"
+  const bool range = valuespec.find(',') == std::string::npos && parseRange(valuespec, values);
+  if (range && values.empty()) return false;
+  if (!range) values = splitValueList(valuespec);
+  if (values.empty() || (values.size() == 1 && values.front().empty())) {
+    LOG(message_group::Error, "Parameter sweep '%1$s' has no values", spec);
+    return false;
+  }
+  if (std::max<size_t>(size(), 1) * values.size() > maxVariants) {
+    LOG(message_group::Error, "Parameter sweep has more than %1$d variants", maxVariants);
+    return false;
+  }
+  this->values.emplace_back(name, std::move(values));
+  return true;
+}
+
+size_t ParameterSweep::size() const
+{
+  if (this->values.empty()) return 0;
+  size_t count = 1;
+  for (const auto& dimension : this->values) count *= dimension.second.size();
+  return count;
+}
+
+std::vector<size_t> ParameterSweep::indices(size_t index) const
+{
+  // The last dimension varies fastest
+  std::vector<size_t> result(this->values.size());
+  for (size_t i = this->values.size(); i-- > 0;) {
+    const auto n = this->values[i].second.size();
+    result[i] = index % n;
+    index /= n;
+  }
+  return result;
+}
+
+ParameterSet ParameterSweep::variant(const ParameterSet& base, size_t index) const
+{
+  ParameterSet result = base;
+  const auto idx = indices(index);
+  for (size_t i = 0; i < this->values.size(); ++i) {
+    boost::property_tree::ptree value;
+    value.data() = this->values[i].second[idx[i]];
+    result[this->values[i].first] = value;
+  }
+  return result;
+}
+
+std::string ParameterSweep::filename(const std::string& filenameTemplate, size_t index) const
+{
+  std::ostringstream oss;
+  oss << std::setw(5) << std::setfill('0') << index;
+  const std::string indexstr = oss.str();
+
+  if (filenameTemplate.find('{') == std::string::npos) {
+    // No placeholders, number the outputs like animation frames
+    const auto uncompressed = stripCompressionSuffix(filenameTemplate);
+    auto path = boost::filesystem::path(uncompressed);
+    const auto extension = path.extension();
+    path.replace_extension();
+    path += indexstr;
+    path.replace_extension(extension);
+    return path.generic_string() + filenameTemplate.substr(uncompressed.size());
+  }
+
+  std::string result = boost::algorithm::replace_all_copy(filenameTemplate, "{index}", indexstr);
+  const auto idx = indices(index);
+  for (size_t i = 0; i < this->values.size(); ++i) {
+    std::string value = this->values[i].second[idx[i]];
+    boost::algorithm::replace_all(value, " ", "");
+    for (auto& c : value) {
+      if (c == '/' || c == '\\' || c == ':' || c == ',') c = '_';
+    }
+    boost::algorithm::replace_all(result, "{" + this->values[i].first + "}", value);
+  }
+  return result;
+}
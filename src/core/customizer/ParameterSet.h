@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
 
@@ -20,3 +21,32 @@ public:
   bool readFile(const std::string& filename);
   void writeFile(const std::string& filename) const;
 };
+
+/*!
+   A set of value lists for customizer parameters, e.g. from repeated
+   --sweep command line options. Expands to the cartesian product of all
+   value lists.
+ */
+class ParameterSweep
+{
+public:
+  // Upper limit for the number of combinations, to catch typos like "[0:0.0001:100]"
+  static constexpr size_t maxVariants = 10000;
+
+  // Parses "name=values", where values is a range "[start:end]" or
+  // "[start:step:end]", or a comma separated list of values.
+  bool addSpec(const std::string& spec);
+
+  [[nodiscard]] bool empty() const { return values.empty(); }
+  [[nodiscard]] const std::vector<std::pair<std::string, std::vector<std::string>>>& dimensions() const { return this->values; }
+  [[nodiscard]] size_t size() const;
+  // Returns \a base with the values of the given variant applied
+  [[nodiscard]] ParameterSet variant(const ParameterSet& base, size_t index) const;
+  // Replaces {name} and {index} placeholders in \a filenameTemplate
+  [[nodiscard]] std::string filename(const std::string& filenameTemplate, size_t index) const;
+
+private:
+  [[nodiscard]] std::vector<size_t> indices(size_t index) const;
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> values;
+};
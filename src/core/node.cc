@@ -31,7 +31,7 @@
 #include <iostream>
 #include <algorithm>
 
-size_t AbstractNode::idx_counter;
+thread_local size_t AbstractNode::idx_counter;
 
 AbstractNode::AbstractNode(const ModuleInstantiation *mi) :
   modinst(mi),
@@ -29,11 +29,18 @@ class AbstractNode : public BaseVisitable, public std::enable_shared_from_this<A
   // We can hash on pointer value or smth. else.
   //  -> remove and
   // use smth. else to display node identifier in CSG tree output?
-  static size_t idx_counter; // Node instantiation index
+  // Node instantiation index, per thread so animation frames evaluated in
+  // the background don't renumber the nodes of the design shown in the GUI
+  static thread_local size_t idx_counter;
 public:
   VISITABLE();
   AbstractNode(const ModuleInstantiation *mi);
   virtual std::string toString() const;
+  /*! The representation used for the node's id string, i.e. its geometry cache key.
+      Defaults to toString(), but nodes should overload it to canonicalize parameters
+      which don't affect the resulting geometry (e.g. $fn/$fa/$fs resolving to the same
+      number of fragments), to increase cache hits. */
+  virtual std::string toIdString() const { return this->toString(); }
   /*! The 'OpenSCAD name' of this node, defaults to classname, but can be
       overloaded to provide specialization for e.g. CSG nodes, primitive nodes etc.
       Used for human-readable output. */
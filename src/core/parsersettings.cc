@@ -1,15 +1,22 @@
 #include "parsersettings.h"
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include "PlatformUtils.h"
+#include "PathCache.h"
 
 namespace fs = boost::filesystem;
 
 std::vector<std::string> librarypath;
 
+// Assignments appended to every parsed file, from -D on the command line
+std::string commandline_commands;
+
 static void add_librarydir(const std::string& libdir)
 {
   librarypath.push_back(libdir);
+  // Cached paths were resolved against the previous library path
+  PathCache::instance()->clear();
 }
 
 const std::vector<std::string>& get_library_path()
@@ -91,11 +98,26 @@ inline fs::path find_valid_path_(const fs::path& sourcepath,
   return {};
 }
 
+/*!
+   Like find_valid_path_(), but resolved paths are cached by source path and
+   local path, as the same libraries are usually used from many files.
+   The circular include check isn't cached, so if the cached path is already
+   open, the search is repeated to find the next valid file.
+ */
 fs::path find_valid_path(const fs::path& sourcepath,
                          const fs::path& localpath,
                          const std::vector<std::string> *openfilenames)
 {
-  return {find_valid_path_(sourcepath, localpath, openfilenames).generic_string()};
+  const auto key = "path\n" + sourcepath.generic_string() + "\n" + localpath.generic_string();
+  auto fullpath = PathCache::instance()->lookup(key);
+  if (!fullpath) {
+    fullpath = find_valid_path_(sourcepath, localpath, nullptr).generic_string();
+    PathCache::instance()->insert(key, *fullpath);
+  }
+  if (openfilenames && std::find(openfilenames->begin(), openfilenames->end(), *fullpath) != openfilenames->end()) {
+    return {find_valid_path_(sourcepath, localpath, openfilenames).generic_string()};
+  }
+  return {*fullpath};
 }
 
 
@@ -447,7 +447,7 @@ std::string PolyhedronNode::toString() const
     } else {
       stream << ", ";
     }
-    stream << "[" << point.x << ", " << point.y << ", " << point.z << "]";
+    stream << "[" << point[0] << ", " << point[1] << ", " << point[2] << "]";
   }
   stream << "], faces = [";
   bool firstFace = true;
@@ -483,7 +483,7 @@ const Geometry *PolyhedronNode::createGeometry() const
     for (const auto& index : face) {
       assert(index < this->points.size());
       const auto& point = points[index];
-      p->insert_vertex(point.x, point.y, point.z);
+      p->insert_vertex(point);
     }
   }
   return p;
@@ -506,12 +506,10 @@ static std::shared_ptr<AbstractNode> builtin_polyhedron(const ModuleInstantiatio
   }
   node->points.reserve(parameters["points"].toVector().size());
   for (const Value& pointValue : parameters["points"].toVector()) {
-    point3d point;
-    if (!pointValue.getVec3(point.x, point.y, point.z, 0.0) ||
-        !std::isfinite(point.x) || !std::isfinite(point.y) || !std::isfinite(point.z)
-        ) {
+    Vector3d point;
+    if (!pointValue.getVec3(point[0], point[1], point[2], 0.0) || !point.allFinite()) {
       LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert points[%1$d] = %2$s to a vec3 of numbers", node->points.size(), pointValue.toEchoStringNoThrow());
-      node->points.push_back({0, 0, 0});
+      node->points.push_back(Vector3d::Zero());
     } else {
       node->points.push_back(point);
     }
@@ -679,7 +677,7 @@ std::string PolygonNode::toString() const
     } else {
       stream << ", ";
     }
-    stream << "[" << point.x << ", " << point.y << "]";
+    stream << "[" << point[0] << ", " << point[1] << "]";
   }
   stream << "], paths = ";
   if (this->paths.empty()) {
@@ -716,17 +714,14 @@ const Geometry *PolygonNode::createGeometry() const
   auto p = new Polygon2d();
   if (this->paths.empty() && this->points.size() > 2) {
     Outline2d outline;
-    for (const auto& point : this->points) {
-      outline.vertices.emplace_back(point.x, point.y);
-    }
+    outline.vertices.assign(this->points.begin(), this->points.end());
     p->addOutline(outline);
   } else {
     for (const auto& path : this->paths) {
       Outline2d outline;
       for (const auto& index : path) {
         assert(index < this->points.size());
-        const auto& point = points[index];
-        outline.vertices.emplace_back(point.x, point.y);
+        outline.vertices.push_back(points[index]);
       }
       p->addOutline(outline);
     }
@@ -753,12 +748,10 @@ static std::shared_ptr<AbstractNode> builtin_polygon(const ModuleInstantiation *
     return node;
   }
   for (const Value& pointValue : parameters["points"].toVector()) {
-    point2d point;
-    if (!pointValue.getVec2(point.x, point.y) ||
-        !std::isfinite(point.x) || !std::isfinite(point.y)
-        ) {
+    Vector2d point;
+    if (!pointValue.getVec2(point[0], point[1]) || !point.allFinite()) {
       LOG(message_group::Error, inst->location(), parameters.documentRoot(), "Unable to convert points[%1$d] = %2$s to a vec2 of numbers", node->points.size(), pointValue.toEchoStringNoThrow());
-      node->points.push_back({0, 0});
+      node->points.push_back(Vector2d::Zero());
     } else {
       node->points.push_back(point);
     }
@@ -24,7 +24,11 @@
  *
  */
 
+#pragma once
+
 #include "node.h"
+#include "calc.h"
+#include "linalg.h"
 #include <sstream>
 
 
@@ -32,10 +36,6 @@ struct point2d {
   double x, y;
 };
 
-struct point3d {
-  double x, y, z;
-};
-
 class CubeNode : public LeafNode
 {
 public:
@@ -73,6 +73,15 @@ public:
            << ")";
     return stream.str();
   }
+  std::string toIdString() const override
+  {
+    std::ostringstream stream;
+    stream << "sphere"
+           << "(fragments = " << Calc::get_fragments_from_r(r, fn, fs, fa)
+           << ", r = " << r
+           << ")";
+    return stream.str();
+  }
   std::string name() const override { return "sphere"; }
   const Geometry *createGeometry() const override;
 
@@ -99,6 +108,18 @@ public:
            << ")";
     return stream.str();
   }
+  std::string toIdString() const override
+  {
+    std::ostringstream stream;
+    stream << "cylinder"
+           << "(fragments = " << Calc::get_fragments_from_r(std::fmax(r1, r2), fn, fs, fa)
+           << ", h = " << h
+           << ", r1 = " << r1
+           << ", r2 = " << r2
+           << ", center = " << (center ? "true" : "false")
+           << ")";
+    return stream.str();
+  }
   std::string name() const override { return "cylinder"; }
   const Geometry *createGeometry() const override;
 
@@ -116,7 +137,7 @@ public:
   std::string name() const override { return "polyhedron"; }
   const Geometry *createGeometry() const override;
 
-  std::vector<point3d> points;
+  std::vector<Vector3d> points;
   std::vector<std::vector<size_t>> faces;
   int convexity = 1;
 };
@@ -158,6 +179,15 @@ public:
            << ")";
     return stream.str();
   }
+  std::string toIdString() const override
+  {
+    std::ostringstream stream;
+    stream << "circle"
+           << "(fragments = " << Calc::get_fragments_from_r(r, fn, fs, fa)
+           << ", r = " << r
+           << ")";
+    return stream.str();
+  }
   std::string name() const override { return "circle"; }
   const Geometry *createGeometry() const override;
 
@@ -174,7 +204,7 @@ public:
   std::string name() const override { return "polygon"; }
   const Geometry *createGeometry() const override;
 
-  std::vector<point2d> points;
+  VectorOfVector2d points;
   std::vector<std::vector<size_t>> paths;
   int convexity = 1;
 };
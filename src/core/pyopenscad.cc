@@ -24,13 +24,952 @@
  *
  */
 
-#include <string>
+/*
+   The "openscad" Python module.
+
+   Python scripts build the node tree directly, the same nodes the builtin
+   modules create, so no SCAD expressions are evaluated:
+
+     from openscad import *
+     c = cube([10, 20, 30]).translate([5, 0, 0])
+     output(c - sphere(12, fn=64))
+
+   Point and face arrays can be anything with the buffer protocol (numpy
+   arrays, array.array, memoryview), read in place without creating a
+   Python object per number. Nested sequences work too.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "ColorNode.h"
+#include "CsgOpNode.h"
+#include "LinearExtrudeNode.h"
+#include "ModuleInstantiation.h"
+#include "RotateExtrudeNode.h"
+#include "TransformNode.h"
+#include "degree_trig.h"
+#include "node.h"
+#include "primitives.h"
+#include "printutils.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <cmath>
+#include <cstring>
 #include <memory>
-#include <node.h>
+#include <string>
+#include <vector>
+
+std::shared_ptr<AbstractNode> python_result_node;
+
+#define F_MINIMUM 0.01
+
+namespace {
 
-std::shared_ptr<AbstractNode> python_result_node; 
+struct PyOpenSCADObject {
+  PyObject_HEAD
+  std::shared_ptr<AbstractNode> node;
+};
+
+PyTypeObject *PyOpenSCADType = nullptr;
+
+// All nodes made from Python share one instantiation, without a location
+const ModuleInstantiation *instantiation()
+{
+  static auto inst = new ModuleInstantiation("python");
+  return inst;
+}
+
+PyObject *wrap(std::shared_ptr<AbstractNode> node)
+{
+  auto self = (PyOpenSCADObject *)PyType_GenericAlloc(PyOpenSCADType, 0);
+  if (!self) return nullptr;
+  new (&self->node) std::shared_ptr<AbstractNode>(std::move(node));
+  return (PyObject *)self;
+}
+
+void PyOpenSCADObject_dealloc(PyOpenSCADObject *self)
+{
+  PyTypeObject *type = Py_TYPE(self);
+  self->node.~shared_ptr();
+  type->tp_free((PyObject *)self);
+  Py_DECREF(type);
+}
+
+std::shared_ptr<AbstractNode> getNode(PyObject *obj, const char *name)
+{
+  if (!PyObject_TypeCheck(obj, PyOpenSCADType)) {
+    PyErr_Format(PyExc_TypeError, "%s expects an openscad object, got %s", name, Py_TYPE(obj)->tp_name);
+    return nullptr;
+  }
+  return ((PyOpenSCADObject *)obj)->node;
+}
 
-std::string evaluatePython(const std::string &code, double time)
+bool getDouble(PyObject *obj, double& value, const char *name)
+{
+  if (!PyNumber_Check(obj)) {
+    PyErr_Format(PyExc_TypeError, "%s must be a number", name);
+    return false;
+  }
+  value = PyFloat_AsDouble(obj);
+  if (PyErr_Occurred()) return false;
+  if (!std::isfinite(value)) {
+    PyErr_Format(PyExc_ValueError, "%s must be finite", name);
+    return false;
+  }
+  return true;
+}
+
+/*
+   Reads a vector of 1 to size numbers, leaving the missing elements
+   as they are, or a single number used for all elements if \a scalar.
+ */
+bool getVector(PyObject *obj, double *values, Py_ssize_t size, bool scalar, const char *name)
+{
+  if (scalar && PyNumber_Check(obj)) {
+    double value;
+    if (!getDouble(obj, value, name)) return false;
+    std::fill(values, values + size, value);
+    return true;
+  }
+  PyObject *seq = PySequence_Fast(obj, "");
+  if (!seq) {
+    PyErr_Format(PyExc_TypeError, scalar ? "%s must be a number or a vector of numbers" : "%s must be a vector of numbers", name);
+    return false;
+  }
+  const auto n = PySequence_Fast_GET_SIZE(seq);
+  bool ok = n >= 1 && n <= size;
+  if (!ok) PyErr_Format(PyExc_ValueError, "%s must have 1 to %zd elements", name, size);
+  for (Py_ssize_t i = 0; ok && i < n; ++i) {
+    ok = getDouble(PySequence_Fast_GET_ITEM(seq, i), values[i], name);
+  }
+  Py_DECREF(seq);
+  return ok;
+}
+
+bool getVector3(PyObject *obj, Vector3d& v, bool scalar, const char *name)
+{
+  return getVector(obj, v.data(), 3, scalar, name);
+}
+
+// Strips the byte order of a buffer format, nullptr if it isn't native
+const char *nativeFormat(const char *format)
+{
+  if (!format) return "B";
+  switch (*format) {
+  case '@': case '=': return format + 1;
+  case '<': return PY_LITTLE_ENDIAN ? format + 1 : nullptr;
+  case '>': case '!': return PY_LITTLE_ENDIAN ? nullptr : format + 1;
+  default: return format;
+  }
+}
+
+template <typename T>
+double element(const char *p)
+{
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  return static_cast<double>(value);
+}
+
+using ElementReader = double (*)(const char *);
+
+ElementReader elementReader(const char *format, Py_ssize_t itemsize)
+{
+  if (!format || format[0] == '\0' || format[1] != '\0') return nullptr;
+  ElementReader reader = nullptr;
+  Py_ssize_t size = 0;
+  switch (format[0]) {
+  case 'd': reader = element<double>; size = sizeof(double); break;
+  case 'f': reader = element<float>; size = sizeof(float); break;
+  case 'b': reader = element<signed char>; size = sizeof(signed char); break;
+  case 'B': reader = element<unsigned char>; size = sizeof(unsigned char); break;
+  case 'h': reader = element<short>; size = sizeof(short); break;
+  case 'H': reader = element<unsigned short>; size = sizeof(unsigned short); break;
+  case 'i': reader = element<int>; size = sizeof(int); break;
+  case 'I': reader = element<unsigned int>; size = sizeof(unsigned int); break;
+  case 'l': reader = element<long>; size = sizeof(long); break;
+  case 'L': reader = element<unsigned long>; size = sizeof(unsigned long); break;
+  case 'q': reader = element<long long>; size = sizeof(long long); break;
+  case 'Q': reader = element<unsigned long long>; size = sizeof(unsigned long long); break;
+  }
+  // Standard sizes ("=l" is 4 bytes) may differ from the native ones
+  return size == itemsize ? reader : nullptr;
+}
+
+/*
+   Reads a 2D buffer of numbers in place, following its strides.
+ */
+bool getBufferMatrix(PyObject *obj, size_t& columns, std::vector<double>& values, size_t& rows, const char *name)
+{
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) < 0) return false;
+  bool ok = false;
+  const auto reader = elementReader(nativeFormat(view.format), view.itemsize);
+  if (view.ndim != 2) {
+    PyErr_Format(PyExc_ValueError, "%s must be a 2D array, got %d dimensions", name, view.ndim);
+  } else if (!reader) {
+    PyErr_Format(PyExc_TypeError, "%s has unsupported element type '%s'", name, view.format ? view.format : "B");
+  } else if (columns != 0 && view.shape[1] != (Py_ssize_t)columns) {
+    PyErr_Format(PyExc_ValueError, "%s must have %zu columns, got %zd", name, columns, view.shape[1]);
+  } else {
+    rows = view.shape[0];
+    columns = view.shape[1];
+    values.resize(rows * columns);
+    auto value = values.begin();
+    const auto base = static_cast<const char *>(view.buf);
+    for (Py_ssize_t i = 0; i < view.shape[0]; ++i) {
+      for (Py_ssize_t j = 0; j < view.shape[1]; ++j) {
+        *value++ = reader(base + i * view.strides[0] + j * view.strides[1]);
+      }
+    }
+    ok = true;
+  }
+  PyBuffer_Release(&view);
+  return ok;
+}
+
+/*
+   Reads rows of numbers, all \a columns long. If \a columns is 0 it's set
+   from the first row. Rows of sequences of different lengths set \a columns
+   to 0 if \a ragged, with \a lengths holding the length of each row.
+ */
+bool getMatrix(PyObject *obj, size_t& columns, std::vector<double>& values, size_t& rows, const char *name,
+               std::vector<size_t> *lengths = nullptr)
+{
+  if (PyObject_CheckBuffer(obj)) return getBufferMatrix(obj, columns, values, rows, name);
+
+  PyObject *seq = PySequence_Fast(obj, "");
+  if (!seq) {
+    PyErr_Format(PyExc_TypeError, "%s must be an array or a sequence of sequences of numbers", name);
+    return false;
+  }
+  rows = PySequence_Fast_GET_SIZE(seq);
+  values.clear();
+  bool ok = true;
+  const bool fixed = columns != 0;
+  for (size_t i = 0; ok && i < rows; ++i) {
+    PyObject *row = PySequence_Fast(PySequence_Fast_GET_ITEM(seq, i), "");
+    if (!row) {
+      PyErr_Format(PyExc_TypeError, "%s[%zu] must be a sequence of numbers", name, i);
+      ok = false;
+      break;
+    }
+    const size_t n = PySequence_Fast_GET_SIZE(row);
+    if (i == 0 && !fixed) columns = n;
+    if (lengths) lengths->push_back(n);
+    if (n != columns) {
+      if (lengths && !fixed) {
+        columns = 0;
+      } else {
+        PyErr_Format(PyExc_ValueError, "%s[%zu] must have %zu elements, got %zu", name, i, columns, n);
+        ok = false;
+      }
+    }
+    for (size_t j = 0; ok && j < n; ++j) {
+      double value;
+      ok = getDouble(PySequence_Fast_GET_ITEM(row, j), value, name);
+      values.push_back(value);
+    }
+    Py_DECREF(row);
+  }
+  Py_DECREF(seq);
+  return ok;
+}
+
+template <typename Points>
+bool getPoints(PyObject *obj, Points& points, const char *name)
+{
+  using Point = typename Points::value_type;
+  constexpr size_t dim = Point::SizeAtCompileTime;
+  static_assert(sizeof(Point) == dim * sizeof(double), "points are read as dim doubles each");
+  size_t columns = dim, rows = 0;
+  std::vector<double> values;
+  if (!getMatrix(obj, columns, values, rows, name)) return false;
+  points.resize(rows);
+  for (size_t i = 0; i < rows; ++i) {
+    double *point = points[i].data();
+    for (size_t j = 0; j < dim; ++j) {
+      point[j] = values[i * dim + j];
+      if (!std::isfinite(point[j])) {
+        PyErr_Format(PyExc_ValueError, "%s[%zu] is not finite", name, i);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Reads lists of point indices, like the faces of a polyhedron
+bool getIndices(PyObject *obj, size_t npoints, std::vector<std::vector<size_t>>& lists, const char *name)
+{
+  size_t columns = 0, rows = 0;
+  std::vector<double> values;
+  std::vector<size_t> lengths;
+  if (!getMatrix(obj, columns, values, rows, name, &lengths)) return false;
+  lists.resize(rows);
+  auto value = values.begin();
+  for (size_t i = 0; i < rows; ++i) {
+    const size_t n = lengths.empty() ? columns : lengths[i];
+    lists[i].reserve(n);
+    for (size_t j = 0; j < n; ++j, ++value) {
+      if (*value != std::floor(*value)) {
+        PyErr_Format(PyExc_ValueError, "%s[%zu][%zu] is not an integer", name, i, j);
+        return false;
+      }
+      if (*value < 0 || *value >= npoints) {
+        PyErr_Format(PyExc_IndexError, "Point index %lld is out of bounds (from %s[%zu][%zu])",
+                     static_cast<long long>(*value), name, i, j);
+        return false;
+      }
+      lists[i].push_back(static_cast<size_t>(*value));
+    }
+  }
+  return true;
+}
+
+template <typename Node>
+void setFragments(Node& node, double fn, double fs, double fa)
+{
+  node.fn = fn;
+  node.fs = std::max(fs, F_MINIMUM);
+  node.fa = std::max(fa, F_MINIMUM);
+}
+
+// Optional keyword arguments default to nullptr; None counts as missing
+bool given(PyObject *obj)
+{
+  return obj && obj != Py_None;
+}
+
+PyObject *python_cube(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"size", "center", nullptr};
+  PyObject *size = nullptr;
+  int center = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Op", const_cast<char **>(kwlist), &size, &center)) return nullptr;
+
+  auto node = std::make_shared<CubeNode>(instantiation());
+  Vector3d v(1, 1, 1);
+  if (given(size) && !getVector3(size, v, true, "cube(size)")) return nullptr;
+  node->x = v[0];
+  node->y = v[1];
+  node->z = v[2];
+  node->center = center;
+  return wrap(node);
+}
+
+PyObject *python_sphere(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"r", "d", "fn", "fs", "fa", nullptr};
+  PyObject *r = nullptr, *d = nullptr;
+  double fn = 0, fs = 2, fa = 12;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOddd", const_cast<char **>(kwlist), &r, &d, &fn, &fs, &fa)) return nullptr;
+
+  auto node = std::make_shared<SphereNode>(instantiation());
+  setFragments(*node, fn, fs, fa);
+  if (given(d)) {
+    if (!getDouble(d, node->r, "sphere(d)")) return nullptr;
+    node->r /= 2;
+  } else if (given(r) && !getDouble(r, node->r, "sphere(r)")) {
+    return nullptr;
+  }
+  return wrap(node);
+}
+
+PyObject *python_cylinder(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"h", "r1", "r2", "center", "r", "d", "d1", "d2", "fn", "fs", "fa", nullptr};
+  PyObject *h = nullptr, *r1 = nullptr, *r2 = nullptr, *r = nullptr, *d = nullptr, *d1 = nullptr, *d2 = nullptr;
+  int center = 0;
+  double fn = 0, fs = 2, fa = 12;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOOpOOOOddd", const_cast<char **>(kwlist),
+                                   &h, &r1, &r2, &center, &r, &d, &d1, &d2, &fn, &fs, &fa)) return nullptr;
+
+  auto node = std::make_shared<CylinderNode>(instantiation());
+  setFragments(*node, fn, fs, fa);
+  node->center = center;
+  if (given(h) && !getDouble(h, node->h, "cylinder(h)")) return nullptr;
+
+  // Diameters take precedence over radii, specific ends over both ends
+  double radius = 1;
+  if (given(d)) {
+    if (!getDouble(d, radius, "cylinder(d)")) return nullptr;
+    radius /= 2;
+  } else if (given(r) && !getDouble(r, radius, "cylinder(r)")) {
+    return nullptr;
+  }
+  node->r1 = node->r2 = radius;
+  if (given(d1)) {
+    if (!getDouble(d1, node->r1, "cylinder(d1)")) return nullptr;
+    node->r1 /= 2;
+  } else if (given(r1) && !getDouble(r1, node->r1, "cylinder(r1)")) {
+    return nullptr;
+  }
+  if (given(d2)) {
+    if (!getDouble(d2, node->r2, "cylinder(d2)")) return nullptr;
+    node->r2 /= 2;
+  } else if (given(r2) && !getDouble(r2, node->r2, "cylinder(r2)")) {
+    return nullptr;
+  }
+  return wrap(node);
+}
+
+PyObject *python_polyhedron(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"points", "faces", "convexity", nullptr};
+  PyObject *points = nullptr, *faces = nullptr;
+  int convexity = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|i", const_cast<char **>(kwlist), &points, &faces, &convexity)) return nullptr;
+
+  auto node = std::make_shared<PolyhedronNode>(instantiation());
+  if (!getPoints(points, node->points, "polyhedron(points)")) return nullptr;
+  if (!getIndices(faces, node->points.size(), node->faces, "polyhedron(faces)")) return nullptr;
+  // Like the builtin, drop what can't be a face
+  node->faces.erase(std::remove_if(node->faces.begin(), node->faces.end(),
+                                   [](const auto& face) { return face.size() < 3; }), node->faces.end());
+  node->convexity = std::max(convexity, 1);
+  return wrap(node);
+}
+
+PyObject *python_square(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"size", "center", nullptr};
+  PyObject *size = nullptr;
+  int center = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|Op", const_cast<char **>(kwlist), &size, &center)) return nullptr;
+
+  auto node = std::make_shared<SquareNode>(instantiation());
+  double v[2] = {1, 1};
+  if (given(size) && !getVector(size, v, 2, true, "square(size)")) return nullptr;
+  node->x = v[0];
+  node->y = v[1];
+  node->center = center;
+  return wrap(node);
+}
+
+PyObject *python_circle(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"r", "d", "fn", "fs", "fa", nullptr};
+  PyObject *r = nullptr, *d = nullptr;
+  double fn = 0, fs = 2, fa = 12;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OOddd", const_cast<char **>(kwlist), &r, &d, &fn, &fs, &fa)) return nullptr;
+
+  auto node = std::make_shared<CircleNode>(instantiation());
+  setFragments(*node, fn, fs, fa);
+  if (given(d)) {
+    if (!getDouble(d, node->r, "circle(d)")) return nullptr;
+    node->r /= 2;
+  } else if (given(r) && !getDouble(r, node->r, "circle(r)")) {
+    return nullptr;
+  }
+  return wrap(node);
+}
+
+PyObject *python_polygon(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"points", "paths", "convexity", nullptr};
+  PyObject *points = nullptr, *paths = nullptr;
+  int convexity = 1;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oi", const_cast<char **>(kwlist), &points, &paths, &convexity)) return nullptr;
+
+  auto node = std::make_shared<PolygonNode>(instantiation());
+  if (!getPoints(points, node->points, "polygon(points)")) return nullptr;
+  if (given(paths) && !getIndices(paths, node->points.size(), node->paths, "polygon(paths)")) return nullptr;
+  node->convexity = std::max(convexity, 1);
+  return wrap(node);
+}
+
+/*
+   Makes a CSG node of the objects given as arguments, or of the objects in
+   a single iterable argument.
+ */
+PyObject *csg(OpenSCADOperator type, PyObject *args, const char *name)
 {
-  return "Python not yet  fully  inside";
+  auto node = std::make_shared<CsgOpNode>(instantiation(), type);
+  PyObject *items = args;
+  if (PyTuple_GET_SIZE(args) == 1 && !PyObject_TypeCheck(PyTuple_GET_ITEM(args, 0), PyOpenSCADType)) {
+    items = PySequence_Fast(PyTuple_GET_ITEM(args, 0), "");
+    if (!items) {
+      PyErr_Format(PyExc_TypeError, "%s expects openscad objects or an iterable of them", name);
+      return nullptr;
+    }
+  } else {
+    Py_INCREF(items);
+  }
+  const auto n = PySequence_Fast_GET_SIZE(items);
+  node->children.reserve(n);
+  for (Py_ssize_t i = 0; i < n; ++i) {
+    auto child = getNode(PySequence_Fast_GET_ITEM(items, i), name);
+    if (!child) {
+      Py_DECREF(items);
+      return nullptr;
+    }
+    node->children.push_back(child);
+  }
+  Py_DECREF(items);
+  return wrap(node);
+}
+
+PyObject *python_union(PyObject *, PyObject *args)
+{
+  return csg(OpenSCADOperator::UNION, args, "union()");
+}
+
+PyObject *python_difference(PyObject *, PyObject *args)
+{
+  return csg(OpenSCADOperator::DIFFERENCE, args, "difference()");
+}
+
+PyObject *python_intersection(PyObject *, PyObject *args)
+{
+  return csg(OpenSCADOperator::INTERSECTION, args, "intersection()");
+}
+
+PyObject *binaryCsg(OpenSCADOperator type, PyObject *a, PyObject *b)
+{
+  if (!PyObject_TypeCheck(a, PyOpenSCADType) || !PyObject_TypeCheck(b, PyOpenSCADType)) {
+    Py_RETURN_NOTIMPLEMENTED;
+  }
+  auto node = std::make_shared<CsgOpNode>(instantiation(), type);
+  node->children = {((PyOpenSCADObject *)a)->node, ((PyOpenSCADObject *)b)->node};
+  return wrap(node);
+}
+
+PyObject *python_or(PyObject *a, PyObject *b)
+{
+  return binaryCsg(OpenSCADOperator::UNION, a, b);
+}
+
+PyObject *python_subtract(PyObject *a, PyObject *b)
+{
+  return binaryCsg(OpenSCADOperator::DIFFERENCE, a, b);
+}
+
+PyObject *python_and(PyObject *a, PyObject *b)
+{
+  return binaryCsg(OpenSCADOperator::INTERSECTION, a, b);
+}
+
+/*
+   The functions below take the object they apply to as self, and are both
+   methods of openscad objects and module functions taking the object as
+   first argument.
+ */
+
+PyObject *transform(PyObject *self, const char *name, const Transform3d& matrix)
+{
+  auto child = getNode(self, name);
+  if (!child) return nullptr;
+  auto node = std::make_shared<TransformNode>(instantiation(), name);
+  node->matrix = matrix;
+  node->children.push_back(child);
+  return wrap(node);
+}
+
+PyObject *python_translate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"v", nullptr};
+  PyObject *v = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char **>(kwlist), &v)) return nullptr;
+
+  Vector3d translation(0, 0, 0);
+  if (!getVector3(v, translation, false, "translate(v)")) return nullptr;
+  Transform3d matrix = Transform3d::Identity();
+  matrix.translate(translation);
+  return transform(self, "translate", matrix);
+}
+
+PyObject *python_rotate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"a", "v", nullptr};
+  PyObject *a = nullptr, *v = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char **>(kwlist), &a, &v)) return nullptr;
+
+  Transform3d matrix = Transform3d::Identity();
+  if (PyNumber_Check(a)) {
+    double angle;
+    if (!getDouble(a, angle, "rotate(a)")) return nullptr;
+    Vector3d axis(0, 0, 1);
+    if (given(v)) {
+      axis.setZero();
+      if (!getVector3(v, axis, false, "rotate(v)")) return nullptr;
+    }
+    matrix.rotate(angle_axis_degrees(angle, axis));
+  } else {
+    // Euler angles, applied about x, then y, then z like rotate([x, y, z])
+    Vector3d angles(0, 0, 0);
+    if (!getVector3(a, angles, false, "rotate(a)")) return nullptr;
+    const double sx = sin_degrees(angles[0]), cx = cos_degrees(angles[0]);
+    const double sy = sin_degrees(angles[1]), cy = cos_degrees(angles[1]);
+    const double sz = sin_degrees(angles[2]), cz = cos_degrees(angles[2]);
+    Matrix3d M;
+    M << cy * cz,  cz *sx *sy - cx * sz,   cx *cz *sy + sx * sz,
+      cy *sz,  cx *cz + sx * sy * sz,  -cz * sx + cx * sy * sz,
+      -sy,       cy *sx,                  cx *cy;
+    matrix.rotate(M);
+  }
+  return transform(self, "rotate", matrix);
+}
+
+PyObject *python_scale(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"v", nullptr};
+  PyObject *v = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char **>(kwlist), &v)) return nullptr;
+
+  Vector3d scale(1, 1, 1);
+  if (!getVector3(v, scale, true, "scale(v)")) return nullptr;
+  Transform3d matrix = Transform3d::Identity();
+  matrix.scale(scale);
+  return transform(self, "scale", matrix);
+}
+
+PyObject *python_mirror(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"v", nullptr};
+  PyObject *v = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char **>(kwlist), &v)) return nullptr;
+
+  Vector3d n(0, 0, 0);
+  if (!getVector3(v, n, false, "mirror(v)")) return nullptr;
+  Transform3d matrix = Transform3d::Identity();
+  const double x = n[0], y = n[1], z = n[2];
+  if (x != 0.0 || y != 0.0 || z != 0.0) {
+    // Same as builtin mirror(): normalized within each element
+    const double a = x * x + y * y + z * z;
+    Matrix4d m;
+    m << 1 - 2 * x * x / a, -2 * y * x / a, -2 * z * x / a, 0,
+      -2 * x * y / a, 1 - 2 * y * y / a, -2 * z * y / a, 0,
+      -2 * x * z / a, -2 * y * z / a, 1 - 2 * z * z / a, 0,
+      0, 0, 0, 1;
+    matrix = m;
+  }
+  return transform(self, "mirror", matrix);
+}
+
+PyObject *python_multmatrix(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"m", nullptr};
+  PyObject *m = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", const_cast<char **>(kwlist), &m)) return nullptr;
+
+  size_t columns = 4, rows = 0;
+  std::vector<double> values;
+  if (!getMatrix(m, columns, values, rows, "multmatrix(m)")) return nullptr;
+  if (rows < 3 || rows > 4) {
+    PyErr_SetString(PyExc_ValueError, "multmatrix(m) must be a 3x4 or 4x4 matrix");
+    return nullptr;
+  }
+  Transform3d matrix = Transform3d::Identity();
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < 4; ++j) matrix(i, j) = values[i * 4 + j];
+  }
+  return transform(self, "multmatrix", matrix);
+}
+
+PyObject *python_color(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"c", "alpha", nullptr};
+  PyObject *c = nullptr, *alpha = nullptr;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char **>(kwlist), &c, &alpha)) return nullptr;
+
+  auto child = getNode(self, "color()");
+  if (!child) return nullptr;
+  auto node = std::make_shared<ColorNode>(instantiation());
+  if (PyUnicode_Check(c)) {
+    const char *utf8 = PyUnicode_AsUTF8(c);
+    if (!utf8) return nullptr;
+    auto colorname = boost::algorithm::to_lower_copy(std::string(utf8));
+    auto it = webcolors.find(colorname);
+    if (it != webcolors.end()) {
+      node->color = it->second;
+    } else if (const auto hexColor = parse_hex_color(colorname)) {
+      node->color = *hexColor;
+    } else {
+      PyErr_Format(PyExc_ValueError, "Unable to parse color \"%s\"", utf8);
+      return nullptr;
+    }
+  } else {
+    double rgba[4] = {1, 1, 1, 1};
+    if (!getVector(c, rgba, 4, false, "color(c)")) return nullptr;
+    for (size_t i = 0; i < 4; ++i) node->color[i] = (float)rgba[i];
+  }
+  if (given(alpha)) {
+    double value;
+    if (!getDouble(alpha, value, "color(alpha)")) return nullptr;
+    node->color[3] = (float)value;
+  }
+  node->children.push_back(child);
+  return wrap(node);
+}
+
+PyObject *python_linear_extrude(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"height", "center", "convexity", "twist", "slices", "segments", "scale", "fn", "fs", "fa", nullptr};
+  double height = 100, twist = 0;
+  int center = 0, convexity = 1, slices = -1, segments = -1;
+  PyObject *scale = nullptr;
+  double fn = 0, fs = 2, fa = 12;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|dpidiiOddd", const_cast<char **>(kwlist),
+                                   &height, &center, &convexity, &twist, &slices, &segments, &scale, &fn, &fs, &fa)) return nullptr;
+
+  auto child = getNode(self, "linear_extrude()");
+  if (!child) return nullptr;
+  auto node = std::make_shared<LinearExtrudeNode>(instantiation());
+  node->fn = fn;
+  node->fs = fs;
+  node->fa = fa;
+  node->height = std::isfinite(height) && height > 0 ? height : 0;
+  node->center = center;
+  node->convexity = std::max(convexity, 1);
+  if (std::isfinite(twist) && twist != 0.0) {
+    node->twist = twist;
+    node->has_twist = true;
+  }
+  if (slices >= 0) {
+    node->slices = std::max(slices, 1);
+    node->has_slices = true;
+  }
+  if (segments >= 0) {
+    node->segments = segments;
+    node->has_segments = true;
+  }
+  if (given(scale)) {
+    double v[2];
+    if (!getVector(scale, v, 2, true, "linear_extrude(scale)")) return nullptr;
+    node->scale_x = std::max(v[0], 0.0);
+    node->scale_y = std::max(v[1], 0.0);
+  }
+  node->children.push_back(child);
+  return wrap(node);
+}
+
+PyObject *python_rotate_extrude(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+  static const char *kwlist[] = {"angle", "convexity", "fn", "fs", "fa", nullptr};
+  double angle = 360;
+  int convexity = 0;
+  double fn = 0, fs = 2, fa = 12;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|diddd", const_cast<char **>(kwlist),
+                                   &angle, &convexity, &fn, &fs, &fa)) return nullptr;
+
+  auto child = getNode(self, "rotate_extrude()");
+  if (!child) return nullptr;
+  auto node = std::make_shared<RotateExtrudeNode>(instantiation());
+  node->fn = fn;
+  node->fs = fs;
+  node->fa = fa;
+  node->convexity = convexity > 0 ? convexity : 2;
+  node->scale = 1;
+  node->angle = std::isfinite(angle) && angle > -360 && angle <= 360 ? angle : 360;
+  node->children.push_back(child);
+  return wrap(node);
+}
+
+// Makes the object the result of the script
+PyObject *python_output(PyObject *self, PyObject *)
+{
+  auto node = getNode(self, "output()");
+  if (!node) return nullptr;
+  python_result_node = node;
+  Py_RETURN_NONE;
+}
+
+// Logs the arguments like echo() in the console
+PyObject *python_echo(PyObject *, PyObject *args)
+{
+  std::string text;
+  for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(args); ++i) {
+    PyObject *str = PyObject_Str(PyTuple_GET_ITEM(args, i));
+    if (!str) return nullptr;
+    const char *utf8 = PyUnicode_AsUTF8(str);
+    if (i > 0) text += ", ";
+    if (utf8) text += utf8;
+    Py_DECREF(str);
+    if (!utf8) return nullptr;
+  }
+  LOG(message_group::Echo, "%1$s", text);
+  Py_RETURN_NONE;
+}
+
+PyObject *PyOpenSCADObject_repr(PyOpenSCADObject *self)
+{
+  return PyUnicode_FromFormat("<openscad.Object %s>", self->node->toString().c_str());
+}
+
+/*
+   Module functions taking the object as first argument, calling the method
+   of the same name.
+ */
+template <PyObject *(*Method)(PyObject *, PyObject *, PyObject *)>
+PyObject *objectFunction(PyObject *, PyObject *args, PyObject *kwargs)
+{
+  if (PyTuple_GET_SIZE(args) < 1) {
+    PyErr_SetString(PyExc_TypeError, "missing the openscad object to apply to");
+    return nullptr;
+  }
+  PyObject *rest = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args));
+  if (!rest) return nullptr;
+  PyObject *result = Method(PyTuple_GET_ITEM(args, 0), rest, kwargs);
+  Py_DECREF(rest);
+  return result;
+}
+
+PyObject *python_output_function(PyObject *, PyObject *obj)
+{
+  return python_output(obj, nullptr);
+}
+
+#define KEYWORDS(f) reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(f)), METH_VARARGS | METH_KEYWORDS
+
+PyMethodDef PyOpenSCADMethods[] = {
+  {"translate", KEYWORDS(python_translate), "translate(v): moves the object by v"},
+  {"rotate", KEYWORDS(python_rotate), "rotate(a, v=None): rotates by Euler angles a, or by angle a about axis v"},
+  {"scale", KEYWORDS(python_scale), "scale(v): scales by a number or a vector"},
+  {"mirror", KEYWORDS(python_mirror), "mirror(v): mirrors on the plane through the origin with normal v"},
+  {"multmatrix", KEYWORDS(python_multmatrix), "multmatrix(m): transforms by a 3x4 or 4x4 matrix"},
+  {"color", KEYWORDS(python_color), "color(c, alpha=None): colors by name, hex string or RGB(A) vector"},
+  {"linear_extrude", KEYWORDS(python_linear_extrude), "linear_extrude(height=100, center=False, ...): extrudes a 2D object"},
+  {"rotate_extrude", KEYWORDS(python_rotate_extrude), "rotate_extrude(angle=360, ...): revolves a 2D object about the Z axis"},
+  {"output", python_output, METH_NOARGS, "output(): makes the object the result of the script"},
+  {nullptr, nullptr, 0, nullptr}
+};
+
+PyMethodDef PyOpenSCADFunctions[] = {
+  {"cube", KEYWORDS(python_cube), "cube(size=1, center=False)"},
+  {"sphere", KEYWORDS(python_sphere), "sphere(r=1, d=None, fn=0, fs=2, fa=12)"},
+  {"cylinder", KEYWORDS(python_cylinder), "cylinder(h=1, r1=None, r2=None, center=False, r=1, d=None, d1=None, d2=None, fn=0, fs=2, fa=12)"},
+  {"polyhedron", KEYWORDS(python_polyhedron), "polyhedron(points, faces, convexity=1): points is an N x 3 array"},
+  {"square", KEYWORDS(python_square), "square(size=1, center=False)"},
+  {"circle", KEYWORDS(python_circle), "circle(r=1, d=None, fn=0, fs=2, fa=12)"},
+  {"polygon", KEYWORDS(python_polygon), "polygon(points, paths=None, convexity=1): points is an N x 2 array"},
+  {"union", python_union, METH_VARARGS, "union(*objects)"},
+  {"difference", python_difference, METH_VARARGS, "difference(*objects): the first object minus the others"},
+  {"intersection", python_intersection, METH_VARARGS, "intersection(*objects)"},
+  {"translate", KEYWORDS(objectFunction<python_translate>), "translate(obj, v)"},
+  {"rotate", KEYWORDS(objectFunction<python_rotate>), "rotate(obj, a, v=None)"},
+  {"scale", KEYWORDS(objectFunction<python_scale>), "scale(obj, v)"},
+  {"mirror", KEYWORDS(objectFunction<python_mirror>), "mirror(obj, v)"},
+  {"multmatrix", KEYWORDS(objectFunction<python_multmatrix>), "multmatrix(obj, m)"},
+  {"color", KEYWORDS(objectFunction<python_color>), "color(obj, c, alpha=None)"},
+  {"linear_extrude", KEYWORDS(objectFunction<python_linear_extrude>), "linear_extrude(obj, height=100, center=False, convexity=1, twist=0, slices=None, segments=None, scale=1, fn=0, fs=2, fa=12)"},
+  {"rotate_extrude", KEYWORDS(objectFunction<python_rotate_extrude>), "rotate_extrude(obj, angle=360, convexity=2, fn=0, fs=2, fa=12)"},
+  {"output", python_output_function, METH_O, "output(obj): makes obj the result of the script"},
+  {"echo", python_echo, METH_VARARGS, "echo(*args): prints to the console"},
+  {nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef OpenSCADModule = {
+  PyModuleDef_HEAD_INIT, "openscad", "Builds OpenSCAD node trees", -1, PyOpenSCADFunctions,
+  nullptr, nullptr, nullptr, nullptr
+};
+
+PyType_Slot PyOpenSCADSlots[] = {
+  {Py_tp_dealloc, reinterpret_cast<void *>(PyOpenSCADObject_dealloc)},
+  {Py_tp_repr, reinterpret_cast<void *>(PyOpenSCADObject_repr)},
+  {Py_tp_methods, PyOpenSCADMethods},
+  {Py_tp_doc, const_cast<char *>("An OpenSCAD node tree. Combine with | (union), - (difference) and & (intersection).")},
+  {Py_nb_or, reinterpret_cast<void *>(python_or)},
+  {Py_nb_subtract, reinterpret_cast<void *>(python_subtract)},
+  {Py_nb_and, reinterpret_cast<void *>(python_and)},
+  {0, nullptr}
+};
+
+// Objects are only made by the module functions
+PyType_Spec PyOpenSCADSpec = {
+  "openscad.Object", sizeof(PyOpenSCADObject), 0, Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION, PyOpenSCADSlots
+};
+
+PyObject *PyInit_openscad()
+{
+  if (!PyOpenSCADType) {
+    PyOpenSCADType = (PyTypeObject *)PyType_FromSpec(&PyOpenSCADSpec);
+    if (!PyOpenSCADType) return nullptr;
+  }
+
+  PyObject *module = PyModule_Create(&OpenSCADModule);
+  if (!module) return nullptr;
+  Py_INCREF(PyOpenSCADType);
+  if (PyModule_AddObject(module, "Object", (PyObject *)PyOpenSCADType) < 0) {
+    Py_DECREF(PyOpenSCADType);
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
+
+// The interpreter lives as long as the process, keeping imported modules
+void initializePython()
+{
+  static bool initialized = false;
+  if (initialized) return;
+  PyImport_AppendInittab("openscad", &PyInit_openscad);
+  Py_InitializeEx(0);
+  initialized = true;
+}
+
+// Formats the pending Python exception like the interpreter does
+std::string formatException()
+{
+  PyObject *type, *value, *traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+  PyErr_NormalizeException(&type, &value, &traceback);
+  std::string error;
+  PyObject *module = PyImport_ImportModule("traceback");
+  PyObject *lines = module ? PyObject_CallMethod(module, "format_exception", "OOO",
+                                                 type, value ? value : Py_None, traceback ? traceback : Py_None) : nullptr;
+  PyObject *separator = PyUnicode_FromString("");
+  PyObject *text = lines && separator ? PyUnicode_Join(separator, lines) : nullptr;
+  Py_XDECREF(separator);
+  if (!text && value) {
+    PyErr_Clear();
+    text = PyObject_Str(value);
+  }
+  if (text) {
+    if (const char *utf8 = PyUnicode_AsUTF8(text)) error = utf8;
+  }
+  if (error.empty()) error = "Python error";
+  PyErr_Clear();
+  Py_XDECREF(text);
+  Py_XDECREF(lines);
+  Py_XDECREF(module);
+  Py_XDECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(traceback);
+  return error;
+}
+
+} // namespace
+
+/*!
+   Runs a Python script, which sets python_result_node with output().
+   $t is available as openscad.t. Returns the Python error, empty on success.
+ */
+std::string evaluatePython(const std::string& code, double time)
+{
+  initializePython();
+  python_result_node.reset();
+  AbstractNode::resetIndexCounter();
+
+  PyObject *module = PyImport_ImportModule("openscad");
+  if (!module) return formatException();
+  PyObject *t = PyFloat_FromDouble(time);
+  PyObject_SetAttrString(module, "t", t);
+  Py_DECREF(t);
+  Py_DECREF(module);
+
+  // Each run starts with fresh globals, so no state is left from a previous run
+  PyObject *globals = PyDict_New();
+  PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+  PyObject *name = PyUnicode_FromString("__main__");
+  PyDict_SetItemString(globals, "__name__", name);
+  Py_DECREF(name);
+
+  std::string error;
+  PyObject *result = PyRun_String(code.c_str(), Py_file_input, globals, globals);
+  if (!result) error = formatException();
+  Py_XDECREF(result);
+  Py_DECREF(globals);
+  return error;
 }
@@ -0,0 +1,324 @@
+#ifdef ENABLE_CGAL
+
+#include "CSGKernelSelector.h"
+#include "cgal.h"
+#include "cgalutils.h"
+#include "CGAL_Nef_polyhedron.h"
+#include "CGALHybridPolyhedron.h"
+#include "PolySet.h"
+#include "node.h"
+#include "printutils.h"
+#include "progress.h"
+#ifdef ENABLE_MANIFOLD
+#include "ManifoldGeometry.h"
+#include "manifoldutils.h"
+#endif
+
+#include <array>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+
+namespace CSGKernelSelector {
+
+namespace {
+
+enum class Representation { POLYSET, NEF, HYBRID, MANIFOLD };
+
+// Rough cost per facet of the operation itself, indexed by Kernel
+const std::array<double, 3> operationCost = {1, 8, 60};
+
+// Rough cost per facet of converting an operand, indexed by Representation
+// then Kernel. Getting a mesh out of a Nef polyhedron costs about as much as
+// a Nef operation, so operands which are Nef polyhedra already keep the
+// operation in Nef unless the other operands are much larger.
+const std::array<std::array<double, 3>, 4> conversionCost = {{
+  {2, 4, 30},    // PolySet
+  {60, 60, 0},   // Nef, through a PolySet
+  {10, 0, 30},   // Hybrid
+  {0, 10, 60},   // Manifold, through a PolySet
+}};
+
+// Cost per facet of converting a convex PolySet to a Nef polyhedron, which
+// skips the general construction, see createNefPolyhedronFromPolySet()
+const double convexToNefCost = 8;
+
+std::mutex statistics_mutex;
+std::map<Kernel, KernelStatistic> kernel_statistics;
+
+// Thrown when a kernel gives up, to try the next one
+class KernelFailure : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+struct Operand {
+  Representation representation;
+  size_t facets;
+  bool nonManifold;
+  bool convex;
+};
+
+// Checking whether a Nef polyhedron is simple is linear in its size, so each
+// operand is described once per operation
+Operand describe(const shared_ptr<const Geometry>& geom)
+{
+  if (const auto *N = dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get())) {
+    return {Representation::NEF, N->numFacets(), !N->p3->is_simple(), false};
+  }
+  if (const auto *hybrid = dynamic_cast<const CGALHybridPolyhedron *>(geom.get())) {
+    return {Representation::HYBRID, hybrid->numFacets(), !hybrid->isManifold(), false};
+  }
+#ifdef ENABLE_MANIFOLD
+  if (dynamic_cast<const ManifoldGeometry *>(geom.get())) {
+    return {Representation::MANIFOLD, geom->numFacets(), false, false};
+  }
+#endif
+  // Whether a PolySet is closed is only known after converting it, and only
+  // convexity set when creating it is trusted, like in the Nef conversion
+  const auto *ps = dynamic_cast<const PolySet *>(geom.get());
+  const bool convex = ps && bool(ps->convexValue());
+  return {Representation::POLYSET, geom->numFacets(), false, convex};
+}
+
+double estimatedCost(Kernel kernel, const Operand& operand)
+{
+  const auto k = static_cast<size_t>(kernel);
+  double conversion = conversionCost[static_cast<size_t>(operand.representation)][k];
+  if (kernel == Kernel::NEF && operand.convex) conversion = convexToNefCost;
+  return operand.facets * (operationCost[k] + conversion);
+}
+
+// Operands of the non-empty children
+std::vector<Operand> describeAll(const Geometry::Geometries& children)
+{
+  std::vector<Operand> operands;
+  for (const auto& item : children) {
+    if (item.second && !item.second->isEmpty()) operands.push_back(describe(item.second));
+  }
+  return operands;
+}
+
+#ifdef ENABLE_MANIFOLD
+const bool manifoldAvailable = true;
+#else
+const bool manifoldAvailable = false;
+#endif
+
+bool available(Kernel kernel)
+{
+  return kernel != Kernel::MANIFOLD || manifoldAvailable;
+}
+
+Representation representationOf(Kernel kernel)
+{
+  switch (kernel) {
+  case Kernel::MANIFOLD: return Representation::MANIFOLD;
+  case Kernel::COREFINEMENT: return Representation::HYBRID;
+  default: return Representation::NEF;
+  }
+}
+
+template <class G>
+void checkValid(const G&) {}
+
+#ifdef ENABLE_MANIFOLD
+void checkValid(const ManifoldGeometry& geom)
+{
+  if (!geom.isValid()) throw KernelFailure("invalid manifold");
+}
+#endif
+
+// Pairs the smallest operands first, like CGALUtils::applyUnion3D()
+template <class G>
+shared_ptr<G> unionOf(std::vector<shared_ptr<G>> operands)
+{
+  auto greater = [](const shared_ptr<G>& lhs, const shared_ptr<G>& rhs) {
+    return lhs->numFacets() > rhs->numFacets();
+  };
+  std::priority_queue<shared_ptr<G>, std::vector<shared_ptr<G>>, decltype(greater)> q(greater, std::move(operands));
+  progress_tick();
+  while (q.size() > 1) {
+    auto smaller = q.top();
+    q.pop();
+    auto larger = q.top();
+    q.pop();
+    *larger += *smaller;
+    q.push(larger);
+    progress_tick();
+  }
+  return q.empty() ? nullptr : q.top();
+}
+
+/*!
+   Applies op with the kernel operating on G, converting the children with
+   \a convert. Unlike the CGALUtils and ManifoldUtils functions, errors are
+   thrown rather than logged so the next kernel can be tried.
+ */
+template <class G, class Convert>
+shared_ptr<const Geometry> applyWith(const Geometry::Geometries& children, OpenSCADOperator op, Convert convert)
+{
+  std::vector<shared_ptr<G>> operands;
+  std::vector<shared_ptr<const AbstractNode>> nodes;
+  for (const auto& item : children) {
+    shared_ptr<G> operand;
+    if (item.second && !item.second->isEmpty()) {
+      operand = convert(item.second);
+      if (!operand) throw KernelFailure("conversion failed");
+      checkValid(*operand);
+    }
+    if (!operand || operand->isEmpty()) {
+      // Intersecting with nothing, or subtracting from nothing, gives nothing
+      if (op == OpenSCADOperator::INTERSECTION) return nullptr;
+      if (op == OpenSCADOperator::DIFFERENCE && operands.empty()) return nullptr;
+      continue;
+    }
+    operands.push_back(operand);
+    nodes.push_back(item.first);
+  }
+  if (operands.empty()) return nullptr;
+
+  shared_ptr<G> result;
+  if (op == OpenSCADOperator::UNION) {
+    result = unionOf(std::move(operands));
+  } else {
+    result = operands.front();
+    for (size_t i = 1; i < operands.size(); ++i) {
+      if (op == OpenSCADOperator::INTERSECTION) *result *= *operands[i];
+      else *result -= *operands[i];
+      if (nodes[i]) nodes[i]->progress_report();
+    }
+  }
+  checkValid(*result);
+  return result;
+}
+
+shared_ptr<const Geometry> applyKernel(Kernel kernel, const Geometry::Geometries& children, OpenSCADOperator op)
+{
+  switch (kernel) {
+#ifdef ENABLE_MANIFOLD
+  case Kernel::MANIFOLD:
+    return applyWith<ManifoldGeometry>(children, op, ManifoldUtils::createMutableManifoldFromGeometry);
+#endif
+  case Kernel::COREFINEMENT:
+    return applyWith<CGALHybridPolyhedron>(children, op, CGALUtils::createMutableHybridPolyhedronFromGeometry);
+  default:
+    return applyWith<CGAL_Nef_polyhedron>(children, op, [](const shared_ptr<const Geometry>& geom) {
+      auto N = CGALUtils::getNefPolyhedronFromGeometry(geom);
+      return N ? std::make_shared<CGAL_Nef_polyhedron>(*N) : nullptr;
+    });
+  }
+}
+
+const char *operatorName(OpenSCADOperator op)
+{
+  switch (op) {
+  case OpenSCADOperator::UNION: return "union";
+  case OpenSCADOperator::INTERSECTION: return "intersection";
+  case OpenSCADOperator::DIFFERENCE: return "difference";
+  default: return "UNKNOWN";
+  }
+}
+
+// Kernels to try for op on operands, cheapest first
+std::vector<Kernel> rankOperands(const std::vector<Operand>& operands, OpenSCADOperator op)
+{
+  // Only Nef polyhedra represent non-manifold solids
+  for (const auto& operand : operands) {
+    if (operand.nonManifold) return {Kernel::NEF};
+  }
+
+  std::vector<std::pair<double, Kernel>> costs;
+  for (auto kernel : {Kernel::MANIFOLD, Kernel::COREFINEMENT, Kernel::NEF}) {
+    if (!available(kernel)) continue;
+    double total = 0;
+    for (const auto& operand : operands) total += estimatedCost(kernel, operand);
+    costs.emplace_back(total, kernel);
+  }
+  std::stable_sort(costs.begin(), costs.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+
+  std::vector<Kernel> kernels;
+  for (const auto& cost : costs) {
+    PRINTDB("%s: %s estimated at %.0f", operatorName(op) % kernelName(cost.second) % cost.first);
+    kernels.push_back(cost.second);
+  }
+  return kernels;
+}
+
+} // namespace
+
+const char *kernelName(Kernel kernel)
+{
+  switch (kernel) {
+  case Kernel::MANIFOLD: return "Manifold";
+  case Kernel::COREFINEMENT: return "Corefinement";
+  default: return "Nef";
+  }
+}
+
+std::vector<Kernel> rankKernels(const Geometry::Geometries& children, OpenSCADOperator op)
+{
+  return rankOperands(describeAll(children), op);
+}
+
+shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& children, OpenSCADOperator op)
+{
+  const auto operands = describeAll(children);
+  const auto kernels = rankOperands(operands, op);
+  for (auto kernel : kernels) {
+    const auto representation = representationOf(kernel);
+    size_t conversions = 0;
+    for (const auto& operand : operands) {
+      if (operand.representation != representation) ++conversions;
+    }
+
+    std::string error;
+    shared_ptr<const Geometry> result;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      result = applyKernel(kernel, children, op);
+    } catch (const KernelFailure& e) {
+      error = e.what();
+    } catch (const CGAL::Failure_exception& e) {
+      error = e.what();
+    } catch (const std::exception& e) {
+      // boost any_cast throws exceptions inside CGAL code, see CGALUtils::applyOperator3D()
+      error = e.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(statistics_mutex);
+      auto& statistic = kernel_statistics[kernel];
+      statistic.operations++;
+      statistic.conversions += conversions;
+      statistic.time += std::chrono::steady_clock::now() - start;
+      if (!error.empty()) statistic.failures++;
+    }
+    if (error.empty()) return result;
+
+    if (kernel == kernels.back()) {
+      LOG(message_group::Error, "[auto-csg] %1$s %2$s failed: %3$s", kernelName(kernel), operatorName(op), error);
+    } else {
+      LOG("[auto-csg] %1$s %2$s failed (%3$s), falling back to the next kernel.", kernelName(kernel), operatorName(op), error);
+    }
+  }
+  return nullptr;
+}
+
+std::map<Kernel, KernelStatistic> statistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex);
+  return kernel_statistics;
+}
+
+void resetStatistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex);
+  kernel_statistics.clear();
+}
+
+} // namespace CSGKernelSelector
+
+#endif // ENABLE_CGAL
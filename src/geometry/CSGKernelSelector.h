@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include "Geometry.h"
+#include "enums.h"
+
+/*!
+   Chooses the kernel of each 3D union, intersection and difference for the
+   auto-csg feature, instead of one kernel for the whole render.
+
+   The cost of each kernel is estimated from the operand sizes, the
+   representation the operands are already in (converting costs too, less so
+   for convex primitives becoming Nef polyhedra) and whether an operand is
+   known not to be manifold, which only Nef polyhedra handle. The cheapest kernel runs first; if it fails, the next cheapest
+   one is tried.
+ */
+namespace CSGKernelSelector {
+
+enum class Kernel { MANIFOLD, COREFINEMENT, NEF };
+
+const char *kernelName(Kernel kernel);
+
+// Kernels to try for op on children, cheapest first
+std::vector<Kernel> rankKernels(const Geometry::Geometries& children, OpenSCADOperator op);
+
+// Applies a union, intersection or difference to the children
+shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& children, OpenSCADOperator op);
+
+struct KernelStatistic {
+  size_t operations{0};  // operations the kernel was run for
+  size_t failures{0};    // operations it failed, handing them to the next kernel
+  size_t conversions{0}; // operands which weren't in the kernel's representation yet
+  std::chrono::steady_clock::duration time{};
+};
+
+// What the kernels did since the last reset, for the render statistic
+std::map<Kernel, KernelStatistic> statistics();
+void resetStatistics();
+
+} // namespace CSGKernelSelector
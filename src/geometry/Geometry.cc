@@ -1,12 +1,48 @@
 #include "Geometry.h"
 #include "printutils.h"
 #include <boost/foreach.hpp>
+#include <cassert>
+#include <memory>
 #include <utility>
 
 GeometryList::GeometryList(Geometry::Geometries geometries) : children(std::move(geometries))
 {
 }
 
+GeometryList::GeometryList(Geometry::Geometries geometries, Instances instances) :
+  instances(std::move(instances)), children(std::move(geometries))
+{
+  assert(this->instances.size() == this->children.size());
+}
+
+const Geometry::Geometries& GeometryList::getChildren() const
+{
+  if (this->instances.empty()) return this->children;
+
+  auto transformed = std::atomic_load(&this->transformedchildren);
+  if (!transformed) {
+    auto result = std::make_shared<Geometries>();
+    auto instance = this->instances.begin();
+    for (const auto& item : this->children) {
+      const Transform3d& matrix = (instance++)->matrix;
+      if (matrix.matrix().isIdentity()) {
+        result->push_back(item);
+      } else {
+        shared_ptr<Geometry> geom(item.second->copy());
+        geom->transform(matrix);
+        result->emplace_back(item.first, geom);
+      }
+    }
+    // Keep the first result if another thread got here at the same time
+    shared_ptr<const Geometries> expected;
+    transformed = result;
+    if (!std::atomic_compare_exchange_strong(&this->transformedchildren, &expected, transformed)) {
+      transformed = expected;
+    }
+  }
+  return *transformed;
+}
+
 size_t GeometryList::memsize() const
 {
   size_t sum = 0;
@@ -19,7 +55,7 @@ size_t GeometryList::memsize() const
 BoundingBox GeometryList::getBoundingBox() const
 {
   BoundingBox bbox;
-  for (const auto& item : this->children) {
+  for (const auto& item : getChildren()) {
     bbox.extend(item.second->getBoundingBox());
   }
   return bbox;
@@ -28,7 +64,7 @@ BoundingBox GeometryList::getBoundingBox() const
 std::string GeometryList::dump() const
 {
   std::stringstream out;
-  for (const auto& item : this->children) {
+  for (const auto& item : getChildren()) {
     out << item.second->dump();
   }
   return out.str();
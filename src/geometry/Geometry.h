@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <string>
 #include <list>
+#include <vector>
 
 #include "linalg.h"
 #include "memory.h"
@@ -78,10 +79,24 @@ class GeometryList : public Geometry
 {
 public:
   VISITABLE_GEOMETRY();
-  Geometries children;
+
+  // A child as its untransformed geometry and placement
+  struct Instance {
+    shared_ptr<const Geometry> geom;
+    Transform3d matrix;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  using Instances = std::vector<Instance, Eigen::aligned_allocator<Instance>>;
+  // Either empty or one entry per child, in the same order.
+  // Lets exporters write geometry which is placed repeatedly only once.
+  Instances instances;
 
   GeometryList();
   GeometryList(Geometry::Geometries geometries);
+  // Children with the untransformed geometry of \a instances. They are only
+  // transformed on the first call to getChildren(), so exporters writing
+  // the instances never build the transformed copies.
+  GeometryList(Geometry::Geometries geometries, Instances instances);
 
   [[nodiscard]] size_t memsize() const override;
   [[nodiscard]] BoundingBox getBoundingBox() const override;
@@ -91,10 +106,13 @@ public:
   [[nodiscard]] Geometry *copy() const override { return new GeometryList(*this); }
   [[nodiscard]] size_t numFacets() const override { assert(false && "not implemented"); return 0; }
 
-  [[nodiscard]] const Geometries& getChildren() const {
-    return this->children;
-  }
+  [[nodiscard]] size_t size() const { return this->children.size(); }
+  [[nodiscard]] const Geometries& getChildren() const;
 
   [[nodiscard]] Geometries flatten() const;
 
+private:
+  Geometries children;
+  // Children with the instance transforms applied, created on demand
+  mutable shared_ptr<const Geometries> transformedchildren;
 };
@@ -11,17 +11,34 @@
 
 GeometryCache *GeometryCache::inst = nullptr;
 
-shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
+bool GeometryCache::contains(const std::string& id) const
 {
-  const auto& geom = this->cache[id]->geom;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->cache.contains(id);
+}
+
+/*!
+   Returns false on a miss. Unlike contains() followed by get(), this can't
+   be raced by an eviction, and tells a miss apart from a cached empty geometry.
+   Counts the lookups and hits for the cache summary.
+ */
+bool GeometryCache::get(const std::string& id, shared_ptr<const Geometry>& geom) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  ++this->lookup_count;
+  const auto *entry = this->cache[id];
+  if (!entry) return false;
+  ++this->hit_count;
+  geom = entry->geom;
 #ifdef DEBUG
   PRINTDB("Geometry Cache hit: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
 #endif
-  return geom;
+  return true;
 }
 
 bool GeometryCache::insert(const std::string& id, const shared_ptr<const Geometry>& geom)
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
 #ifdef DEBUG
   assert(!dynamic_cast<const CGAL_Nef_polyhedron *>(geom.get()));
@@ -35,26 +52,54 @@ bool GeometryCache::insert(const std::string& id, const shared_ptr<const Geometr
 
 size_t GeometryCache::size() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.size();
 }
 
 size_t GeometryCache::totalCost() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.totalCost();
 }
 
+size_t GeometryCache::lookups() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->lookup_count;
+}
+
+size_t GeometryCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hit_count;
+}
+
 size_t GeometryCache::maxSizeMB() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return this->cache.maxCost() / (1024ul * 1024ul);
 }
 
 void GeometryCache::setMaxSizeMB(size_t limit)
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   this->cache.setMaxCost(limit * 1024ul * 1024ul);
 }
 
+/*!
+   Removes all entries, and starts counting lookups anew.
+ */
+void GeometryCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  cache.clear();
+  this->lookup_count = 0;
+  this->hit_count = 0;
+}
+
 void GeometryCache::print()
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   LOG("Geometries in cache: %1$d", this->cache.size());
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
 }
@@ -4,6 +4,12 @@
 #include "memory.h"
 #include "Geometry.h"
 
+#include <mutex>
+
+/*!
+   Access is serialized, as animation frames may be evaluated on a worker
+   thread while the GUI changes the size limit.
+ */
 class GeometryCache
 {
 public:
@@ -11,14 +17,16 @@ public:
 
   static GeometryCache *instance() { if (!inst) inst = new GeometryCache; return inst; }
 
-  bool contains(const std::string& id) const { return this->cache.contains(id); }
-  shared_ptr<const class Geometry> get(const std::string& id) const;
+  bool contains(const std::string& id) const;
+  bool get(const std::string& id, shared_ptr<const Geometry>& geom) const;
   bool insert(const std::string& id, const shared_ptr<const Geometry>& geom);
   size_t size() const;
   size_t totalCost() const;
+  size_t lookups() const;
+  size_t hits() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
-  void clear() { cache.clear(); }
+  void clear();
   void print();
 
 private:
@@ -30,5 +38,8 @@ private:
     cache_entry(const shared_ptr<const Geometry>& geom);
   };
 
+  mutable std::mutex mutex;
   Cache<std::string, cache_entry> cache;
+  mutable size_t lookup_count{0};
+  mutable size_t hit_count{0};
 };
@@ -16,7 +16,10 @@
 #include "ProjectionNode.h"
 #include "CsgOpNode.h"
 #include "TextNode.h"
+#include "ImportNode.h"
+#include "SurfaceNode.h"
 #include "CGALHybridPolyhedron.h"
+#include "CSGKernelSelector.h"
 #include "cgalutils.h"
 #include "RenderNode.h"
 #include "ClipperUtils.h"
@@ -29,6 +32,10 @@
 #include "degree_trig.h"
 #include <ciso646> // C alternative tokens (xor)
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string_view>
+#include <thread>
 #include "boost-utils.h"
 #ifdef ENABLE_MANIFOLD
 #include "ManifoldGeometry.h"
@@ -51,16 +58,21 @@ shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNod
                                                                bool allownef)
 {
   const std::string& key = this->tree.getIdString(node);
-  if (!GeometryCache::instance()->contains(key)) {
+  shared_ptr<const Geometry> cached;
+  if (!GeometryCache::instance()->get(key, cached)) {
     shared_ptr<const Geometry> N;
-    if (CGALCache::instance()->contains(key)) {
-      N = CGALCache::instance()->get(key);
-    }
+    CGALCache::instance()->get(key, N);
 
     // If not found in any caches, we need to evaluate the geometry
     if (N) {
       this->root = N;
     } else {
+      this->cachedgeometries.clear();
+      this->lazyroots.clear();
+      this->streaminglists.clear();
+      this->pendingtransforms.clear();
+      this->partialunions.clear();
+      this->unfoldedunions.clear();
       this->traverse(node);
     }
 
@@ -68,7 +80,8 @@ shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNod
       this->root = CGALUtils::getGeometryAsPolySet(this->root);
     }
 #ifdef ENABLE_MANIFOLD
-    if (dynamic_pointer_cast<const ManifoldGeometry>(this->root)) {
+    // Rendered manifolds are exported and displayed as is, only previews need a PolySet
+    if (!allownef && dynamic_pointer_cast<const ManifoldGeometry>(this->root)) {
       this->root = CGALUtils::getGeometryAsPolySet(this->root);
     }
 #endif
@@ -92,7 +105,7 @@ shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNod
     smartCacheInsert(node, this->root);
     return this->root;
   }
-  return GeometryCache::instance()->get(key);
+  return cached;
 }
 
 bool GeometryEvaluator::isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const {
@@ -117,6 +130,16 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren(const Abstrac
   return {};
 }
 
+/*!
+   Returns two independent 64 bit hashes (FNV-1a and std::hash) of a node id.
+ */
+static std::array<uint64_t, 2> digestId(std::string_view id)
+{
+  uint64_t fnv = 14695981039346656037ull;
+  for (const unsigned char c : id) fnv = (fnv ^ c) * 1099511628211ull;
+  return {fnv, static_cast<uint64_t>(std::hash<std::string_view>{}(id))};
+}
+
 /*!
    Applies the operator to all child nodes of the given node.
 
@@ -165,21 +188,28 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
     }
     if (actualchildren.empty()) return {};
     if (actualchildren.size() == 1) return {actualchildren.front().second};
-#ifdef ENABLE_MANIFOLD
-    if (Feature::ExperimentalManifold.is_enabled()) {
-      return {ManifoldUtils::applyOperator3DManifold(actualchildren, op)};
+    if (Feature::ExperimentalIncrementalUnion.is_enabled()) {
+      std::vector<Geometry::GeometryItem> items(actualchildren.begin(), actualchildren.end());
+      std::vector<IdDigest> digests;
+      digests.reserve(items.size());
+      for (const auto& item : items) digests.push_back(digestId(this->tree.getIdView(*item.first)));
+      return {applyIncrementalUnion3D(items, digests, 0, items.size())};
     }
-#endif
-    return {CGALUtils::applyUnion3D(actualchildren.begin(), actualchildren.end())};
+    convertChildrenToNef(node, actualchildren);
+    return {applyUnion3D(actualchildren)};
     break;
   }
   default:
   {
+    if (Feature::ExperimentalAutoCsg.is_enabled() && (op == OpenSCADOperator::INTERSECTION || op == OpenSCADOperator::DIFFERENCE)) {
+      return {CSGKernelSelector::applyOperator3D(children, op)};
+    }
 #ifdef ENABLE_MANIFOLD
     if (Feature::ExperimentalManifold.is_enabled()) {
       return {ManifoldUtils::applyOperator3DManifold(children, op)};
     }
 #endif
+    convertChildrenToNef(node, children);
     return {CGALUtils::applyOperator3D(children, op)};
     break;
   }
@@ -187,6 +217,69 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
 }
 
 
+shared_ptr<const Geometry> GeometryEvaluator::applyUnion3D(const Geometry::Geometries& children)
+{
+  if (Feature::ExperimentalAutoCsg.is_enabled()) {
+    return CSGKernelSelector::applyOperator3D(children, OpenSCADOperator::UNION);
+  }
+#ifdef ENABLE_MANIFOLD
+  if (Feature::ExperimentalManifold.is_enabled()) {
+    return ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::UNION);
+  }
+#endif
+  Geometry::Geometries operands(children);
+  return CGALUtils::applyUnion3D(operands.begin(), operands.end());
+}
+
+/*!
+   Unions children[begin, end) along a merge tree that is picked by the
+   children themselves: the child with the largest digest splits the range,
+   and the parts before and after it are unioned recursively. Each partial
+   union is cached under a key made only from the digests of the children it
+   covers, so it neither depends on the position of the range nor on the
+   number of children around it. Concatenating the ids themselves would make
+   the keys of all partial unions O(n log n) times the id length.
+
+   As in a treap, changing, inserting or removing a single child of a large
+   union only changes the expected O(log n) partial unions on the path from
+   that child to the root of the merge tree; all other partial unions are
+   cache hits.
+ */
+shared_ptr<const Geometry> GeometryEvaluator::applyIncrementalUnion3D(const std::vector<Geometry::GeometryItem>& children,
+                                                                      const std::vector<IdDigest>& digests,
+                                                                      size_t begin, size_t end)
+{
+  if (begin == end) return nullptr;
+  if (end - begin == 1) return children[begin].second;
+
+  // Order dependent combination of the digests of the range, independent of its position
+  IdDigest range = {0, 0};
+  for (size_t i = begin; i < end; ++i) {
+    for (size_t lane = 0; lane < range.size(); ++lane) {
+      range[lane] = (range[lane] ^ digests[i][lane]) * 0x9e3779b97f4a7c15ull + (range[lane] >> 29);
+    }
+  }
+  const std::string key = (boost::format("union_range{%016x%016x}") % range[0] % range[1]).str();
+  shared_ptr<const Geometry> cached;
+  if (smartCacheGet(key, cached)) return cached;
+
+  // Split at the largest digest. Among equal digests, i.e. repeated children,
+  // take the middle one to keep the merge tree balanced.
+  std::vector<size_t> pivots = {begin};
+  for (size_t i = begin + 1; i < end; ++i) {
+    if (digests[i][0] > digests[pivots.front()][0]) pivots = {i};
+    else if (digests[i][0] == digests[pivots.front()][0]) pivots.push_back(i);
+  }
+  const size_t pivot = pivots[pivots.size() / 2];
+
+  Geometry::Geometries operands;
+  if (auto before = applyIncrementalUnion3D(children, digests, begin, pivot)) operands.emplace_back(nullptr, before);
+  operands.push_back(children[pivot]);
+  if (auto after = applyIncrementalUnion3D(children, digests, pivot + 1, end)) operands.emplace_back(nullptr, after);
+  auto result = applyUnion3D(operands);
+  if (result) smartCacheInsert(key, result);
+  return result;
+}
 
 /*!
    Apply 2D hull.
@@ -286,7 +379,9 @@ std::vector<const Polygon2d *> GeometryEvaluator::collectChildren2D(const Abstra
     // a node is a valid object. If we inserted as we created them, the
     // cache could have been modified before we reach this point due to a large
     // sibling object.
-    smartCacheInsert(*chnode, chgeom);
+    // Geometries with a deferred transform don't match their node yet,
+    // and neither do partial unions, which are stored under the node itself.
+    if (chnode.get() != &node && !this->pendingtransforms.count(chnode->index())) smartCacheInsert(*chnode, chgeom);
 
     if (chgeom) {
       if (chgeom->getDimension() == 3) {
@@ -316,8 +411,12 @@ std::vector<const Polygon2d *> GeometryEvaluator::collectChildren2D(const Abstra
 void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
                                          const shared_ptr<const Geometry>& geom)
 {
-  const std::string& key = this->tree.getIdString(node);
+  smartCacheInsert(this->tree.getIdString(node), geom);
+}
 
+void GeometryEvaluator::smartCacheInsert(const std::string& key,
+                                         const shared_ptr<const Geometry>& geom)
+{
   if (CGALCache::acceptsGeometry(geom)) {
     if (!CGALCache::instance()->contains(key)) CGALCache::instance()->insert(key, geom);
   } else {
@@ -336,15 +435,42 @@ bool GeometryEvaluator::isSmartCached(const AbstractNode& node)
           CGALCache::instance()->contains(key));
 }
 
-shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const AbstractNode& node, bool preferNef)
+/*!
+   Returns false if key is in neither cache. Each cache is looked up once, so
+   an entry can't be evicted by another thread between checking and fetching
+   it, and a cached empty geometry is told apart from a miss.
+ */
+bool GeometryEvaluator::smartCacheGet(const std::string& key, shared_ptr<const Geometry>& geom) const
+{
+  return CGALCache::instance()->get(key, geom) || GeometryCache::instance()->get(key, geom);
+}
+
+bool GeometryEvaluator::smartCacheGet(const AbstractNode& node, bool preferNef, shared_ptr<const Geometry>& geom)
 {
   const std::string& key = this->tree.getIdString(node);
+  if (preferNef) return smartCacheGet(key, geom);
+  return GeometryCache::instance()->get(key, geom) || CGALCache::instance()->get(key, geom);
+}
+
+/*!
+   Looks up node when deciding whether to prune its subtree, and keeps the
+   result for takeCached() in postfix, where it must not be looked up again.
+ */
+bool GeometryEvaluator::pruneCached(const AbstractNode& node, bool preferNef)
+{
   shared_ptr<const Geometry> geom;
-  bool hasgeom = GeometryCache::instance()->contains(key);
-  bool hascgal = CGALCache::instance()->contains(key);
-  if (hascgal && (preferNef || !hasgeom)) geom = CGALCache::instance()->get(key);
-  else if (hasgeom) geom = GeometryCache::instance()->get(key);
-  return geom;
+  if (!smartCacheGet(node, preferNef, geom)) return false;
+  this->cachedgeometries[node.index()] = geom;
+  return true;
+}
+
+bool GeometryEvaluator::takeCached(const AbstractNode& node, shared_ptr<const Geometry>& geom)
+{
+  auto cached = this->cachedgeometries.find(node.index());
+  if (cached == this->cachedgeometries.end()) return false;
+  geom = cached->second;
+  this->cachedgeometries.erase(cached);
+  return true;
 }
 
 /*!
@@ -363,7 +489,9 @@ Geometry::Geometries GeometryEvaluator::collectChildren3D(const AbstractNode& no
     // a node is a valid object. If we inserted as we created them, the
     // cache could have been modified before we reach this point due to a large
     // sibling object.
-    smartCacheInsert(*chnode, chgeom);
+    // Geometries with a deferred transform don't match their node yet,
+    // and neither do partial unions, which are stored under the node itself.
+    if (chnode.get() != &node && !this->pendingtransforms.count(chnode->index())) smartCacheInsert(*chnode, chgeom);
 
     if (chgeom && chgeom->getDimension() == 2) {
       LOG(message_group::Warning, item.first->modinst->location(), this->tree.getDocumentPath(), "Ignoring 2D child object for 3D operation");
@@ -375,6 +503,42 @@ Geometry::Geometries GeometryEvaluator::collectChildren3D(const AbstractNode& no
   }
   return children;
 }
+/*!
+   Converts the children of node to Nef polyhedra when the Nef kernel is
+   going to operate on them, and caches each conversion in CGALCache under
+   the id of the child. A child reused as an operand, e.g. in the next render
+   after an edit elsewhere, then is a cache hit for smartCacheGet() with
+   preferNef instead of being converted again.
+ */
+void GeometryEvaluator::convertChildrenToNef(const AbstractNode& node, Geometry::Geometries& children)
+{
+  if (Feature::ExperimentalFastCsg.is_enabled() || Feature::ExperimentalAutoCsg.is_enabled()) return;
+#ifdef ENABLE_MANIFOLD
+  if (Feature::ExperimentalManifold.is_enabled()) return;
+#endif
+
+  for (auto& item : children) {
+    const auto& chnode = item.first;
+    // Same restrictions as for caching in collectChildren3D()
+    if (!chnode || chnode.get() == &node || this->pendingtransforms.count(chnode->index())) continue;
+    if (!item.second || item.second->isEmpty() || CGALCache::acceptsGeometry(item.second)) continue;
+    shared_ptr<const CGAL_Nef_polyhedron> N;
+    try {
+      N = CGALUtils::getNefPolyhedronFromGeometry(item.second);
+    } catch (const CGAL::Failure_exception&) {
+      // Left unconverted, the CGALUtils operation converts it again
+      // and reports the error the same way as without this cache
+      continue;
+    } catch (const std::exception&) {
+      continue;
+    }
+    if (N) {
+      smartCacheInsert(*chnode, N);
+      item.second = N;
+    }
+  }
+}
+
 /*!
 
  */
@@ -438,7 +602,12 @@ void GeometryEvaluator::addToParent(const State& state,
 {
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
-    this->visitedchildren[state.parent()->index()].push_back(std::make_pair(node.shared_from_this(), geom));
+    if (geom && !node.modinst->isBackground() && isStreamingUnion(*state.parent()) &&
+        foldsDimension(state.parent()->index(), geom->getDimension())) {
+      foldIntoUnion(*state.parent(), node, geom);
+    } else {
+      this->visitedchildren[state.parent()->index()].push_back(std::make_pair(node.shared_from_this(), geom));
+    }
   } else {
     // Root node
     this->root = geom;
@@ -446,21 +615,127 @@ void GeometryEvaluator::addToParent(const State& state,
   }
 }
 
+/*!
+   Returns true if 3D children of \a node are unioned as they are added,
+   instead of being kept until the postfix visit of \a node.
+
+   Only union and group nodes stream: the union of their 3D children doesn't
+   depend on the order in which the children are merged, and a partial union
+   stands in for the children it covers. Difference and intersection treat
+   their first child differently, and minkowski, hull and the 2D operations
+   need all children at once.
+ */
+bool GeometryEvaluator::isStreamingUnion(const AbstractNode& node) const
+{
+  if (!Feature::ExperimentalStreamingUnion.is_enabled() ||
+      Feature::ExperimentalIncrementalUnion.is_enabled()) return false;
+  if (this->streaminglists.count(node.index())) return true;
+  if (this->lazyroots.count(node.index())) return false;
+  if (const auto *csgop = dynamic_cast<const CsgOpNode *>(&node)) return csgop->type == OpenSCADOperator::UNION;
+  return dynamic_cast<const GroupNode *>(&node) != nullptr;
+}
+
+/*!
+   Returns true if a child of dimension \a dim is folded into the streaming
+   union with the given node index.
+
+   Like applyToChildren(), the first child with a dimension decides whether
+   the union is 2D or 3D. The children of a 2D union are kept as usual, so
+   that the same children are ignored with the same warnings, and so are
+   those of a ListNode passing its children on to one.
+ */
+bool GeometryEvaluator::foldsDimension(int index, unsigned int dim)
+{
+  if (this->partialunions.count(index)) return dim == 3;
+  if (isUnfoldedUnion(index)) return false;
+  if (dim == 2) this->unfoldedunions.insert(index);
+  return dim == 3;
+}
+
+bool GeometryEvaluator::isUnfoldedUnion(int index) const
+{
+  if (this->unfoldedunions.count(index)) return true;
+  auto list = this->streaminglists.find(index);
+  return list != this->streaminglists.end() && isUnfoldedUnion(list->second);
+}
+
+/*!
+   Adds \a geom as a child of the streaming union \a parent.
+
+   The first folded child leaves an entry of \a parent itself in its list of
+   children, which finishStreamingUnion() fills with the union of all folded
+   children, so they keep their position relative to the other children.
+
+   Children are merged like a binary counter: a new child is pushed as a
+   partial union of level 0, and the top two partial unions are merged
+   while they have the same level. This gives a balanced merge tree while
+   only O(log n) partial results are kept alive, and each child is
+   released as soon as it has been merged.
+ */
+void GeometryEvaluator::foldIntoUnion(const AbstractNode& parent, const AbstractNode& node,
+                                      const shared_ptr<const Geometry>& geom)
+{
+  // Partial unions forwarded by a ListNode don't match its id
+  if (!this->streaminglists.count(node.index())) smartCacheInsert(node, geom);
+
+  auto partialsit = this->partialunions.find(parent.index());
+  if (partialsit == this->partialunions.end()) {
+    this->visitedchildren[parent.index()].emplace_back(parent.shared_from_this(), geom);
+    partialsit = this->partialunions.emplace(parent.index(), PartialUnions()).first;
+  }
+  if (geom->isEmpty()) return;
+
+  auto& partials = partialsit->second;
+  partials.emplace_back(geom, 0);
+  while (partials.size() >= 2 && partials[partials.size() - 2].second == partials.back().second) {
+    Geometry::Geometries operands;
+    operands.emplace_back(nullptr, partials[partials.size() - 2].first);
+    operands.emplace_back(nullptr, partials.back().first);
+    const unsigned int level = partials.back().second + 1;
+    partials.pop_back();
+    partials.pop_back();
+    partials.emplace_back(applyUnion3D(operands), level);
+    if (!partials.back().first) partials.pop_back();
+  }
+}
+
+/*!
+   Replaces the entry of \a node in its own list of children by the union of
+   the remaining partial unions. If all folded children were empty, the entry
+   keeps the first of them.
+ */
+void GeometryEvaluator::finishStreamingUnion(const AbstractNode& node)
+{
+  this->unfoldedunions.erase(node.index());
+  auto partials = this->partialunions.find(node.index());
+  if (partials == this->partialunions.end()) return;
+
+  Geometry::Geometries operands;
+  for (const auto& partial : partials->second) operands.emplace_back(nullptr, partial.first);
+  this->partialunions.erase(partials);
+  if (operands.empty()) return;
+  for (auto& item : this->visitedchildren[node.index()]) {
+    if (item.first.get() == &node) {
+      item.second = operands.size() == 1 ? operands.front().second : applyUnion3D(operands);
+      break;
+    }
+  }
+}
+
 /*!
    Custom nodes are handled here => implicit union
  */
 Response GeometryEvaluator::visit(State& state, const AbstractNode& node)
 {
   if (state.isPrefix()) {
-    if (isSmartCached(node)) return Response::PruneTraversal;
+    if (pruneCached(node, state.preferNef())) return Response::PruneTraversal;
     state.setPreferNef(true); // Improve quality of CSG by avoiding conversion loss
   }
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
+      finishStreamingUnion(node);
       geom = applyToChildren(node, OpenSCADOperator::UNION).constptr();
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -478,15 +753,26 @@ Response GeometryEvaluator::visit(State& state, const ListNode& node)
       if (node.modinst->isBackground()) state.setBackground(true);
       return Response::PruneTraversal;
     }
+    // Children of a ListNode directly below a lazy root also end up in the root
+    if (state.isPrefix() && this->lazyroots.count(state.parent()->index())) {
+      this->lazyroots.insert(node.index());
+    }
+    // The same goes for streaming unions; the ListNode passes its partial union on
+    if (state.isPrefix() && isStreamingUnion(*state.parent())) {
+      this->streaminglists.emplace(node.index(), state.parent()->index());
+    }
     if (state.isPostfix()) {
+      finishStreamingUnion(node);
+      // The entry of the ListNode itself, if any, passes on its partial union
+      const Geometry::Geometries children = std::move(this->visitedchildren[node.index()]);
+      this->visitedchildren.erase(node.index());
       unsigned int dim = 0;
-      for (const auto& item : this->visitedchildren[node.index()]) {
+      for (const auto& item : children) {
         if (!isValidDim(item, dim)) break;
         auto& chnode = item.first;
         const shared_ptr<const Geometry>& chgeom = item.second;
         addToParent(state, *chnode, chgeom);
       }
-      this->visitedchildren.erase(node.index());
     }
     return Response::ContinueTraversal;
   } else {
@@ -508,30 +794,62 @@ Response GeometryEvaluator::lazyEvaluateRootNode(State& state, const AbstractNod
       state.setBackground(true);
       return Response::PruneTraversal;
     }
-    if (isSmartCached(node)) {
+    if (pruneCached(node, state.preferNef())) {
       return Response::PruneTraversal;
     }
+    this->lazyroots.insert(node.index());
   }
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
+    if (takeCached(node, geom)) {
+      this->root = geom;
+      return Response::ContinueTraversal;
+    }
 
     unsigned int dim = 0;
     GeometryList::Geometries geometries;
+    GeometryList::Instances instances;
     for (const auto& item : this->visitedchildren[node.index()]) {
       if (!isValidDim(item, dim)) break;
       auto& chnode = item.first;
       const shared_ptr<const Geometry>& chgeom = item.second;
       if (chnode->modinst->isBackground()) continue;
+      // Top-level transforms are deferred to us, so repeated placements
+      // of the same geometry can be recognized as instances of it.
+      auto pending = this->pendingtransforms.find(chnode->index());
+      if (pending != this->pendingtransforms.end()) {
+        const Transform3d matrix = pending->second;
+        this->pendingtransforms.erase(pending);
+        if (chgeom && !chgeom->isEmpty()) {
+          if (chgeom->getDimension() == 3) {
+            // Transformed by the GeometryList, only if a consumer needs it
+            geometries.emplace_back(chnode, chgeom);
+            instances.push_back({chgeom, matrix});
+          } else {
+            ResultObject res(chgeom);
+            geometries.emplace_back(chnode, applyTransform(res, matrix));
+            instances.push_back({geometries.back().second, Transform3d::Identity()});
+          }
+        }
+        continue;
+      }
       // NB! We insert into the cache here to ensure that all children of
       // a node is a valid object. If we inserted as we created them, the
       // cache could have been modified before we reach this point due to a large
       // sibling object.
       smartCacheInsert(*chnode, chgeom);
       // Only use valid geometries
-      if (chgeom && !chgeom->isEmpty()) geometries.push_back(item);
+      if (chgeom && !chgeom->isEmpty()) {
+        geometries.push_back(item);
+        instances.push_back({chgeom, Transform3d::Identity()});
+      }
+    }
+    if (geometries.size() == 1) {
+      ResultObject res(geometries.front().second);
+      geom = applyTransform(res, instances.front().matrix);
+    } else if (geometries.size() > 1) {
+      geom = std::make_shared<GeometryList>(geometries, std::move(instances));
     }
-    if (geometries.size() == 1) geom = geometries.front().second;
-    else if (geometries.size() > 1) geom.reset(new GeometryList(geometries));
 
     this->root = geom;
   }
@@ -556,10 +874,10 @@ Response GeometryEvaluator::visit(State& state, const RootNode& node)
 
 Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, false)) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       const Geometry *geometry = applyToChildren2D(node, OpenSCADOperator::UNION);
       if (geometry) {
         const auto *polygon = dynamic_cast<const Polygon2d *>(geometry);
@@ -572,8 +890,6 @@ Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
         geom.reset(result);
         delete geometry;
       }
-    } else {
-      geom = smartCacheGet(node, false);
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -587,18 +903,16 @@ Response GeometryEvaluator::visit(State& state, const OffsetNode& node)
 Response GeometryEvaluator::visit(State& state, const RenderNode& node)
 {
   if (state.isPrefix()) {
-    if (isSmartCached(node)) return Response::PruneTraversal;
+    if (pruneCached(node, state.preferNef())) return Response::PruneTraversal;
     state.setPreferNef(true); // Improve quality of CSG by avoiding conversion loss
   }
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       ResultObject res = applyToChildren(node, OpenSCADOperator::UNION);
       auto mutableGeom = res.asMutableGeometry();
       if (mutableGeom) mutableGeom->setConvexity(node.convexity);
       geom = mutableGeom;
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
     }
     node.progress_report();
     addToParent(state, node, geom);
@@ -606,6 +920,85 @@ Response GeometryEvaluator::visit(State& state, const RenderNode& node)
   return Response::ContinueTraversal;
 }
 
+/*!
+   Returns true for leaves which are expensive to create and whose
+   createGeometry() doesn't touch state shared with other threads.
+ */
+static bool isConcurrentLeaf(const AbstractNode& node)
+{
+  if (dynamic_cast<const SurfaceNode *>(&node)) return true;
+  if (const auto *import = dynamic_cast<const ImportNode *>(&node)) {
+    switch (import->type) {
+    case ImportType::STL:
+    case ImportType::OFF:
+    case ImportType::OBJ:
+    case ImportType::_3MF:
+      return true;
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+/*!
+   Collects the concurrent leaves below node. Cached subtrees are skipped:
+   their leaves are taken from the cache as well, or created serially if
+   only the leaf was evicted.
+ */
+void GeometryEvaluator::collectConcurrentLeaves(const AbstractNode& node, std::vector<const LeafNode *>& leaves)
+{
+  if (isSmartCached(node)) return;
+  if (isConcurrentLeaf(node)) leaves.push_back(static_cast<const LeafNode *>(&node));
+  for (const auto& child : node.children) collectConcurrentLeaves(*child, leaves);
+}
+
+/*!
+   Creates the geometry of all uncached surface() and mesh import() leaves
+   below \a node on a pool of threads. The results are picked up by
+   visit(LeafNode), so subsequent evaluation of these leaves is cheap. An
+   exception thrown while creating a leaf, e.g. for a hard warning, is
+   rethrown there too, so leaves which aren't used can't fail evaluation.
+ */
+void GeometryEvaluator::precomputeLeaves(const AbstractNode& node)
+{
+  std::vector<const LeafNode *> candidates;
+  collectConcurrentLeaves(node, candidates);
+
+  // Identical leaves are only created once
+  std::vector<const LeafNode *> leaves;
+  std::vector<std::string> keys;
+  std::set<std::string> seen;
+  for (const auto *leaf : candidates) {
+    const std::string& key = this->tree.getIdString(*leaf);
+    if (this->precomputedleaves.count(key) || !seen.insert(key).second) continue;
+    leaves.push_back(leaf);
+    keys.push_back(key);
+  }
+  // A single leaf is created serially as usual
+  if (leaves.size() < 2) return;
+
+  std::vector<PrecomputedLeaf> results(leaves.size());
+  std::atomic<size_t> next{0};
+  auto worker = [&]() {
+      for (size_t i = next++; i < leaves.size(); i = next++) {
+        try {
+          results[i].geometry.reset(leaves[i]->createGeometry());
+        } catch (...) {
+          results[i].error = std::current_exception();
+        }
+      }
+    };
+  const size_t numthreads = std::min<size_t>(leaves.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < numthreads; ++i) threads.emplace_back(worker);
+  for (auto& thread : threads) thread.join();
+
+  for (size_t i = 0; i < leaves.size(); ++i) {
+    this->precomputedleaves[keys[i]] = std::move(results[i]);
+  }
+}
+
 /*!
    Leaf nodes can create their own geometry, so let them do that
 
@@ -616,8 +1009,16 @@ Response GeometryEvaluator::visit(State& state, const LeafNode& node)
 {
   if (state.isPrefix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
-      const Geometry *geometry = node.createGeometry();
+    if (!smartCacheGet(node, state.preferNef(), geom)) {
+      const Geometry *geometry = nullptr;
+      auto precomputed = this->precomputedleaves.find(this->tree.getIdString(node));
+      if (precomputed != this->precomputedleaves.end()) {
+        const auto error = precomputed->second.error;
+        geometry = precomputed->second.geometry.release();
+        this->precomputedleaves.erase(precomputed);
+        if (error) std::rethrow_exception(error);
+      }
+      if (!geometry) geometry = node.createGeometry();
       assert(geometry);
       if (const auto *polygon = dynamic_cast<const Polygon2d *>(geometry)) {
         if (!polygon->isSanitized()) {
@@ -627,7 +1028,7 @@ Response GeometryEvaluator::visit(State& state, const LeafNode& node)
         }
       }
       geom.reset(geometry);
-    } else geom = smartCacheGet(node, state.preferNef());
+    }
     addToParent(state, node, geom);
     node.progress_report();
   }
@@ -638,7 +1039,7 @@ Response GeometryEvaluator::visit(State& state, const TextNode& node)
 {
   if (state.isPrefix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!GeometryCache::instance()->get(this->tree.getIdString(node), geom)) {
       std::vector<const Geometry *> geometrylist = node.createGeometryList();
       std::vector<const Polygon2d *> polygonlist;
       for (const auto& geometry : geometrylist) {
@@ -647,7 +1048,7 @@ Response GeometryEvaluator::visit(State& state, const TextNode& node)
         polygonlist.push_back(polygon);
       }
       geom.reset(ClipperUtils::apply(polygonlist, ClipperLib::ctUnion));
-    } else geom = GeometryCache::instance()->get(this->tree.getIdString(node));
+    }
     addToParent(state, node, geom);
     node.progress_report();
   }
@@ -664,15 +1065,14 @@ Response GeometryEvaluator::visit(State& state, const TextNode& node)
 Response GeometryEvaluator::visit(State& state, const CsgOpNode& node)
 {
   if (state.isPrefix()) {
-    if (isSmartCached(node)) return Response::PruneTraversal;
+    if (pruneCached(node, state.preferNef())) return Response::PruneTraversal;
     state.setPreferNef(true); // Improve quality of CSG by avoiding conversion loss
   }
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
+      finishStreamingUnion(node);
       geom = applyToChildren(node, node.type).constptr();
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -680,6 +1080,62 @@ Response GeometryEvaluator::visit(State& state, const CsgOpNode& node)
   return Response::ContinueTraversal;
 }
 
+/*!
+   Returns the geometry of \a res transformed by \a matrix.
+   Const geometries are copied, mutable ones are transformed in place.
+ */
+shared_ptr<const Geometry> GeometryEvaluator::applyTransform(ResultObject& res, const Transform3d& matrix)
+{
+  shared_ptr<const Geometry> geom = res.constptr();
+  if (!geom || matrix.matrix().isIdentity()) {
+    // Nothing to do, and no need to copy a const geometry
+  } else if (geom->getDimension() == 2) {
+    shared_ptr<const Polygon2d> polygons = dynamic_pointer_cast<const Polygon2d>(geom);
+    assert(polygons);
+
+    // If we got a const object, make a copy
+    shared_ptr<Polygon2d> newpoly;
+    if (res.isConst()) newpoly.reset(new Polygon2d(*polygons));
+    else newpoly = dynamic_pointer_cast<Polygon2d>(res.ptr());
+
+    Transform2d mat2;
+    mat2.matrix() <<
+      matrix(0, 0), matrix(0, 1), matrix(0, 3),
+      matrix(1, 0), matrix(1, 1), matrix(1, 3),
+      matrix(3, 0), matrix(3, 1), matrix(3, 3);
+    newpoly->transform(mat2);
+    // A 2D transformation may flip the winding order of a polygon.
+    // If that happens with a sanitized polygon, we need to reverse
+    // the winding order for it to be correct.
+    if (newpoly->isSanitized() && mat2.matrix().determinant() <= 0) {
+      geom.reset(ClipperUtils::sanitize(*newpoly));
+    } else {
+      geom = newpoly;
+    }
+  } else if (geom->getDimension() == 3) {
+    auto mutableGeom = res.asMutableGeometry();
+    if (mutableGeom) mutableGeom->transform(matrix);
+    geom = mutableGeom;
+  }
+  return geom;
+}
+
+/*!
+   Returns true if the transform of \a node can be deferred to its parent,
+   i.e. if the parent is a TransformNode with \a node as its only child,
+   or a lazily evaluated root node (see lazyroots).
+   The parent will then apply the composed matrix, so nested transforms
+   of a cached geometry only copy and transform it once.
+ */
+bool GeometryEvaluator::canDeferTransform(const State& state, const TransformNode& node) const
+{
+  if (node.modinst->isBackground() || !state.parent()) return false;
+  // A lazily evaluated root keeps the untransformed geometry as an instance
+  if (this->lazyroots.count(state.parent()->index())) return true;
+  const auto *parent = dynamic_cast<const TransformNode *>(state.parent().get());
+  return parent && parent->getChildren().size() == 1;
+}
+
 /*!
    input: List of 2D or 3D objects (not mixed)
    output: Polygon2d or 3D PolySet
@@ -689,47 +1145,30 @@ Response GeometryEvaluator::visit(State& state, const CsgOpNode& node)
  */
 Response GeometryEvaluator::visit(State& state, const TransformNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, state.preferNef())) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
-      if (matrix_contains_infinity(node.matrix) || matrix_contains_nan(node.matrix)) {
+    if (!takeCached(node, geom)) {
+      // Compose with the transform deferred by our child, if any
+      Transform3d matrix = node.matrix;
+      const auto& children = this->visitedchildren[node.index()];
+      const int deferredchild = children.size() == 1 ? children.front().first->index() : -1;
+      auto pending = this->pendingtransforms.find(deferredchild);
+      if (pending != this->pendingtransforms.end()) matrix = matrix * pending->second;
+
+      if (matrix_contains_infinity(matrix) || matrix_contains_nan(matrix)) {
         // due to the way parse/eval works we can't currently distinguish between NaN and Inf
         LOG(message_group::Warning, node.modinst->location(), this->tree.getDocumentPath(), "Transformation matrix contains Not-a-Number and/or Infinity - removing object.");
+      } else if (canDeferTransform(state, node)) {
+        // Pass the untransformed geometry on, our parent will apply the matrix
+        geom = applyToChildren(node, OpenSCADOperator::UNION).constptr();
+        if (geom) this->pendingtransforms.emplace(node.index(), matrix);
       } else {
         // First union all children
         ResultObject res = applyToChildren(node, OpenSCADOperator::UNION);
-        if ((geom = res.constptr())) {
-          if (geom->getDimension() == 2) {
-            shared_ptr<const Polygon2d> polygons = dynamic_pointer_cast<const Polygon2d>(geom);
-            assert(polygons);
-
-            // If we got a const object, make a copy
-            shared_ptr<Polygon2d> newpoly;
-            if (res.isConst()) newpoly.reset(new Polygon2d(*polygons));
-            else newpoly = dynamic_pointer_cast<Polygon2d>(res.ptr());
-
-            Transform2d mat2;
-            mat2.matrix() <<
-              node.matrix(0, 0), node.matrix(0, 1), node.matrix(0, 3),
-              node.matrix(1, 0), node.matrix(1, 1), node.matrix(1, 3),
-              node.matrix(3, 0), node.matrix(3, 1), node.matrix(3, 3);
-            newpoly->transform(mat2);
-            // A 2D transformation may flip the winding order of a polygon.
-            // If that happens with a sanitized polygon, we need to reverse
-            // the winding order for it to be correct.
-            if (newpoly->isSanitized() && mat2.matrix().determinant() <= 0) {
-              geom.reset(ClipperUtils::sanitize(*newpoly));
-            }
-          } else if (geom->getDimension() == 3) {
-            auto mutableGeom = res.asMutableGeometry();
-            if (mutableGeom) mutableGeom->transform(node.matrix);
-            geom = mutableGeom;
-          }
-        }
+        geom = applyTransform(res, matrix);
       }
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
+      if (pending != this->pendingtransforms.end()) this->pendingtransforms.erase(pending);
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1185,10 +1624,10 @@ static Geometry *extrudePolygon(const LinearExtrudeNode& node, const Polygon2d&
  */
 Response GeometryEvaluator::visit(State& state, const LinearExtrudeNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, false)) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       const Geometry *geometry = nullptr;
       if (!node.filename.empty()) {
         DxfData dxf(node.fn, node.fs, node.fa, node.filename, node.layername, node.origin_x, node.origin_y, node.scale_x);
@@ -1206,8 +1645,6 @@ Response GeometryEvaluator::visit(State& state, const LinearExtrudeNode& node)
         geom.reset(extruded);
         delete geometry;
       }
-    } else {
-      geom = smartCacheGet(node, false);
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1340,10 +1777,10 @@ static Geometry *rotatePolygon(const RotateExtrudeNode& node, const Polygon2d& p
  */
 Response GeometryEvaluator::visit(State& state, const RotateExtrudeNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, false)) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       const Geometry *geometry = nullptr;
       if (!node.filename.empty()) {
         DxfData dxf(node.fn, node.fs, node.fa, node.filename, node.layername, node.origin_x, node.origin_y, node.scale);
@@ -1359,8 +1796,6 @@ Response GeometryEvaluator::visit(State& state, const RotateExtrudeNode& node)
         geom.reset(rotated);
         delete geometry;
       }
-    } else {
-      geom = smartCacheGet(node, false);
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1453,12 +1888,10 @@ shared_ptr<const Geometry> GeometryEvaluator::projectionNoCut(const ProjectionNo
  */
 Response GeometryEvaluator::visit(State& state, const ProjectionNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, false)) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (isSmartCached(node)) {
-      geom = smartCacheGet(node, false);
-    } else {
+    if (!takeCached(node, geom)) {
       if (node.cut_mode) {
         geom = projectionCut(node);
       } else {
@@ -1479,10 +1912,10 @@ Response GeometryEvaluator::visit(State& state, const ProjectionNode& node)
  */
 Response GeometryEvaluator::visit(State& state, const CgalAdvNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, state.preferNef())) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       switch (node.type) {
       case CgalAdvType::MINKOWSKI: {
         ResultObject res = applyToChildren(node, OpenSCADOperator::MINKOWSKI);
@@ -1519,8 +1952,6 @@ Response GeometryEvaluator::visit(State& state, const CgalAdvNode& node)
       default:
         assert(false && "not implemented");
       }
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1531,15 +1962,13 @@ Response GeometryEvaluator::visit(State& state, const CgalAdvNode& node)
 Response GeometryEvaluator::visit(State& state, const AbstractIntersectionNode& node)
 {
   if (state.isPrefix()) {
-    if (isSmartCached(node)) return Response::PruneTraversal;
+    if (pruneCached(node, state.preferNef())) return Response::PruneTraversal;
     state.setPreferNef(true); // Improve quality of CSG by avoiding conversion loss
   }
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       geom = applyToChildren(node, OpenSCADOperator::INTERSECTION).constptr();
-    } else {
-      geom = smartCacheGet(node, state.preferNef());
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1565,10 +1994,10 @@ static Geometry *roofOverPolygon(const RoofNode& node, const Polygon2d& poly)
 
 Response GeometryEvaluator::visit(State& state, const RoofNode& node)
 {
-  if (state.isPrefix() && isSmartCached(node)) return Response::PruneTraversal;
+  if (state.isPrefix() && pruneCached(node, false)) return Response::PruneTraversal;
   if (state.isPostfix()) {
     shared_ptr<const Geometry> geom;
-    if (!isSmartCached(node)) {
+    if (!takeCached(node, geom)) {
       const Geometry *geometry = applyToChildren2D(node, OpenSCADOperator::UNION);
       if (geometry) {
         auto *polygons = dynamic_cast<const Polygon2d *>(geometry);
@@ -1584,8 +2013,6 @@ Response GeometryEvaluator::visit(State& state, const RoofNode& node)
         geom.reset(roof);
         delete geometry;
       }
-    } else {
-      geom = smartCacheGet(node, false);
     }
     addToParent(state, node, geom);
   }
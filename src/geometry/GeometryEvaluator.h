@@ -5,10 +5,16 @@
 #include "memory.h"
 #include "Geometry.h"
 
+#include <array>
+#include <cstdint>
+#include <exception>
 #include <utility>
 #include <list>
 #include <vector>
 #include <map>
+#include <memory>
+#include <string>
+#include <set>
 
 class CGAL_Nef_polyhedron;
 class Polygon2d;
@@ -20,6 +26,7 @@ public:
   GeometryEvaluator(const Tree& tree);
 
   shared_ptr<const Geometry> evaluateGeometry(const AbstractNode& node, bool allownef);
+  void precomputeLeaves(const AbstractNode& node);
 
   Response visit(State& state, const AbstractNode& node) override;
   Response visit(State& state, const AbstractIntersectionNode& node) override;
@@ -68,11 +75,17 @@ private:
   };
 
   void smartCacheInsert(const AbstractNode& node, const shared_ptr<const Geometry>& geom);
-  shared_ptr<const Geometry> smartCacheGet(const AbstractNode& node, bool preferNef);
+  void smartCacheInsert(const std::string& key, const shared_ptr<const Geometry>& geom);
+  bool smartCacheGet(const std::string& key, shared_ptr<const Geometry>& geom) const;
+  bool smartCacheGet(const AbstractNode& node, bool preferNef, shared_ptr<const Geometry>& geom);
   bool isSmartCached(const AbstractNode& node);
+  bool pruneCached(const AbstractNode& node, bool preferNef);
+  bool takeCached(const AbstractNode& node, shared_ptr<const Geometry>& geom);
   bool isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const;
   std::vector<const Polygon2d *> collectChildren2D(const AbstractNode& node);
   Geometry::Geometries collectChildren3D(const AbstractNode& node);
+  void collectConcurrentLeaves(const AbstractNode& node, std::vector<const LeafNode *>& leaves);
+  void convertChildrenToNef(const AbstractNode& node, Geometry::Geometries& children);
   Polygon2d *applyMinkowski2D(const AbstractNode& node);
   Polygon2d *applyHull2D(const AbstractNode& node);
   Polygon2d *applyFill2D(const AbstractNode& node);
@@ -80,14 +93,47 @@ private:
   void applyResize3D(CGAL_Nef_polyhedron& N, const Vector3d& newsize, const Eigen::Matrix<bool, 3, 1>& autosize);
   Polygon2d *applyToChildren2D(const AbstractNode& node, OpenSCADOperator op);
   ResultObject applyToChildren3D(const AbstractNode& node, OpenSCADOperator op);
+  shared_ptr<const Geometry> applyUnion3D(const Geometry::Geometries& children);
+  // Two independent 64 bit hashes of a node id
+  using IdDigest = std::array<uint64_t, 2>;
+  shared_ptr<const Geometry> applyIncrementalUnion3D(const std::vector<Geometry::GeometryItem>& children,
+                                                     const std::vector<IdDigest>& digests,
+                                                     size_t begin, size_t end);
   ResultObject applyToChildren(const AbstractNode& node, OpenSCADOperator op);
   shared_ptr<const Geometry> projectionCut(const ProjectionNode& node);
   shared_ptr<const Geometry> projectionNoCut(const ProjectionNode& node);
 
   void addToParent(const State& state, const AbstractNode& node, const shared_ptr<const Geometry>& geom);
   Response lazyEvaluateRootNode(State& state, const AbstractNode& node);
+  static shared_ptr<const Geometry> applyTransform(ResultObject& res, const Transform3d& matrix);
+  bool canDeferTransform(const State& state, const TransformNode& node) const;
+  bool isStreamingUnion(const AbstractNode& node) const;
+  bool foldsDimension(int index, unsigned int dim);
+  bool isUnfoldedUnion(int index) const;
+  void foldIntoUnion(const AbstractNode& parent, const AbstractNode& node, const shared_ptr<const Geometry>& geom);
+  void finishStreamingUnion(const AbstractNode& node);
 
   std::map<int, Geometry::Geometries> visitedchildren;
+  // Cached geometries of pruned nodes, found by pruneCached(), by node index
+  std::map<int, shared_ptr<const Geometry>> cachedgeometries;
+  // Transforms deferred by TransformNodes to their TransformNode parent, by node index
+  std::map<int, Transform3d, std::less<int>, Eigen::aligned_allocator<std::pair<const int, Transform3d>>> pendingtransforms;
+  // Lazily evaluated root nodes, and ListNodes passing their children on to one
+  std::set<int> lazyroots;
+  // ListNodes whose children are folded into a streaming union, and the index of their parent
+  std::map<int, int> streaminglists;
+  // Partial unions of streaming union nodes and their merge level, by node index
+  using PartialUnions = std::vector<std::pair<shared_ptr<const Geometry>, unsigned int>>;
+  std::map<int, PartialUnions> partialunions;
+  // Streaming unions whose first child was 2D, which keep their children
+  std::set<int> unfoldedunions;
+  // Leaf geometries created ahead of time by precomputeLeaves(), or the
+  // exception creating one threw, by id string
+  struct PrecomputedLeaf {
+    std::unique_ptr<const Geometry> geometry;
+    std::exception_ptr error;
+  };
+  std::map<std::string, PrecomputedLeaf> precomputedleaves;
   const Tree& tree;
   shared_ptr<const Geometry> root;
 
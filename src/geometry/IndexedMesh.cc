@@ -29,6 +29,7 @@
 
 #ifdef ENABLE_MANIFOLD
 #include "ManifoldGeometry.h"
+#include "manifold.h"
 #endif
 
 #ifdef ENABLE_CGAL
@@ -52,6 +53,28 @@ void IndexedMesh::append_geometry(const PolySet& ps)
   }
 }
 
+#ifdef ENABLE_MANIFOLD
+// Uses the manifold's own indices, so each vertex is looked up once rather than once per triangle
+void IndexedMesh::append_geometry(const ManifoldGeometry& mani)
+{
+  IndexedMesh& mesh = *this;
+  const manifold::Mesh m = mani.getManifold().GetMesh();
+  std::vector<int> vertexIndices;
+  vertexIndices.reserve(m.vertPos.size());
+  for (const auto& v : m.vertPos) {
+    vertexIndices.push_back(mesh.vertices.lookup(Vector3d(v.x, v.y, v.z)));
+  }
+  mesh.indices.reserve(mesh.indices.size() + 4 * m.triVerts.size());
+  for (const auto& tv : m.triVerts) {
+    for (const int j : {0, 1, 2}) {
+      mesh.indices.push_back(vertexIndices[tv[j]]);
+    }
+    mesh.numfaces++;
+    mesh.indices.push_back(-1);
+  }
+}
+#endif
+
 void IndexedMesh::append_geometry(const shared_ptr<const Geometry>& geom)
 {
   IndexedMesh& mesh = *this;
@@ -74,7 +97,7 @@ void IndexedMesh::append_geometry(const shared_ptr<const Geometry>& geom)
     mesh.append_geometry(hybrid->toPolySet());
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani = dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    mesh.append_geometry(mani->toPolySet());
+    mesh.append_geometry(*mani);
 #endif
   } else if (dynamic_pointer_cast<const Polygon2d>(geom)) { // NOLINT(bugprone-branch-clone)
     assert(false && "Unsupported file format");
@@ -40,6 +40,9 @@ struct IndexedMesh {
   size_t numfaces{0};
 
   void append_geometry(const PolySet& ps);
+#ifdef ENABLE_MANIFOLD
+  void append_geometry(const class ManifoldGeometry& mani);
+#endif
   void append_geometry(const shared_ptr<const Geometry>& geom);
 };
 
@@ -2,6 +2,9 @@
 #include "printutils.h"
 #include "CGAL_Nef_polyhedron.h"
 #include "CGALHybridPolyhedron.h"
+#ifdef ENABLE_MANIFOLD
+#include "ManifoldGeometry.h"
+#endif
 
 CGALCache *CGALCache::inst = nullptr;
 
@@ -9,24 +12,42 @@ CGALCache::CGALCache(size_t limit) : cache(limit)
 {
 }
 
-shared_ptr<const Geometry> CGALCache::get(const std::string& id) const
+bool CGALCache::contains(const std::string& id) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->cache.contains(id);
+}
+
+/*!
+   Returns false on a miss, see GeometryCache::get()
+ */
+bool CGALCache::get(const std::string& id, shared_ptr<const Geometry>& N) const
 {
-  const auto& N = this->cache[id]->N;
+  std::lock_guard<std::mutex> lock(this->mutex);
+  ++this->lookup_count;
+  const auto *entry = this->cache[id];
+  if (!entry) return false;
+  ++this->hit_count;
+  N = entry->N;
 #ifdef DEBUG
   LOG("CGAL Cache hit: %1$s (%2$d bytes)", id.substr(0, 40), N ? N->memsize() : 0);
 #endif
-  return N;
+  return true;
 }
 
 bool CGALCache::acceptsGeometry(const shared_ptr<const Geometry>& geom) {
   return
     dynamic_pointer_cast<const CGALHybridPolyhedron>(geom).get() ||
+#ifdef ENABLE_MANIFOLD
+    dynamic_pointer_cast<const ManifoldGeometry>(geom).get() ||
+#endif
     dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom).get();
 }
 
 bool CGALCache::insert(const std::string& id, const shared_ptr<const Geometry>& N)
 {
   assert(acceptsGeometry(N));
+  std::lock_guard<std::mutex> lock(this->mutex);
   auto inserted = this->cache.insert(id, new cache_entry(N), N ? N->memsize() : 0);
 #ifdef DEBUG
   if (inserted) LOG("CGAL Cache insert: %1$s (%2$d bytes)", id.substr(0, 40), (N ? N->memsize() : 0));
@@ -37,31 +58,54 @@ bool CGALCache::insert(const std::string& id, const shared_ptr<const Geometry>&
 
 size_t CGALCache::size() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.size();
 }
 
 size_t CGALCache::totalCost() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.totalCost();
 }
 
+size_t CGALCache::lookups() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->lookup_count;
+}
+
+size_t CGALCache::hits() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->hit_count;
+}
+
 size_t CGALCache::maxSizeMB() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return this->cache.maxCost() / (1024ul * 1024ul);
 }
 
 void CGALCache::setMaxSizeMB(size_t limit)
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   this->cache.setMaxCost(limit * 1024ul * 1024ul);
 }
 
+/*!
+   Removes all entries, and starts counting lookups anew.
+ */
 void CGALCache::clear()
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   cache.clear();
+  this->lookup_count = 0;
+  this->hit_count = 0;
 }
 
 void CGALCache::print()
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   LOG("CGAL Polyhedrons in cache: %1$d", this->cache.size());
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
 }
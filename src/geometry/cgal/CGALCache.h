@@ -3,9 +3,15 @@
 #include "Cache.h"
 #include "memory.h"
 
+#include <mutex>
+
 class Geometry;
 
 /*!
+   Besides the results of CGAL operations, this also holds the Nef polyhedra
+   converted from the PolySet results of nodes used as Nef operands, under
+   the id of the node. Access is serialized, as preview leaves and animation
+   frames may be created on other threads.
  */
 class CGALCache
 {
@@ -15,11 +21,13 @@ public:
   static CGALCache *instance() { if (!inst) inst = new CGALCache; return inst; }
   static bool acceptsGeometry(const shared_ptr<const Geometry>& geom);
 
-  bool contains(const std::string& id) const { return this->cache.contains(id); }
-  shared_ptr<const Geometry> get(const std::string& id) const;
+  bool contains(const std::string& id) const;
+  bool get(const std::string& id, shared_ptr<const Geometry>& N) const;
   bool insert(const std::string& id, const shared_ptr<const Geometry>& N);
   size_t size() const;
   size_t totalCost() const;
+  size_t lookups() const;
+  size_t hits() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
   void clear();
@@ -34,5 +42,8 @@ private:
     cache_entry(const shared_ptr<const Geometry>& N);
   };
 
+  mutable std::mutex mutex;
   Cache<std::string, cache_entry> cache;
+  mutable size_t lookup_count{0};
+  mutable size_t hit_count{0};
 };
@@ -35,11 +35,47 @@
 
 namespace CGALUtils {
 
+/*!
+   Direct construction for PolySets whose creator guarantees convexity
+   (e.g. cube, sphere and cylinder). All their faces are convex, so a
+   fan triangulation is exact and we can skip quantizing, tessellating
+   and recomputing the hull.
+
+   Returns nullptr if the result isn't a valid closed polyhedron; the caller
+   should then fall back to the generic construction.
+ */
+static CGAL_Nef_polyhedron *createNefPolyhedronFromConvexPolySet(const PolySet& ps)
+{
+  PolySet ps_tri(3, true);
+  ps_tri.reserve(ps.polygons.size());
+  for (const auto& poly : ps.polygons) {
+    for (size_t i = 2; i < poly.size(); ++i) {
+      ps_tri.append_poly({poly[0], poly[i - 1], poly[i]});
+    }
+  }
+  if (ps_tri.polygons.size() < 4) return nullptr;
+
+  try {
+    CGAL_Polyhedron P;
+    if (CGALUtils::createPolyhedronFromPolySet(ps_tri, P)) return nullptr;
+    if (!P.is_closed() || !P.is_valid(false, 0)) return nullptr;
+    return new CGAL_Nef_polyhedron(new CGAL_Nef_polyhedron3(P));
+  } catch (const CGAL::Assertion_exception& e) {
+    PRINTDB("Direct convex Nef construction failed: %s", e.what());
+    return nullptr;
+  }
+}
+
 CGAL_Nef_polyhedron *createNefPolyhedronFromPolySet(const PolySet& ps)
 {
   if (ps.isEmpty()) return new CGAL_Nef_polyhedron();
   assert(ps.getDimension() == 3);
 
+  // convexValue() is only true if explicitly set, not if computed
+  if (ps.convexValue()) {
+    if (auto N = createNefPolyhedronFromConvexPolySet(ps)) return N;
+  }
+
   // Since is_convex doesn't work well with non-planar faces,
   // we tessellate the polyset before checking.
   PolySet psq(ps);
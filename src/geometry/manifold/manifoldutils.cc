@@ -67,6 +67,43 @@ std::shared_ptr<manifold::Manifold> trustedPolySetToManifold(const PolySet& ps)
   return make_shared<manifold::Manifold>(std::move(mesh));
 }
 
+std::shared_ptr<manifold::Manifold> indexedMeshToManifold(const std::vector<Vector3d>& vertices, const std::vector<IndexedFace>& faces)
+{
+  manifold::Mesh mesh;
+  mesh.vertPos.reserve(vertices.size());
+  for (const auto& v : vertices) {
+    mesh.vertPos.emplace_back((float) v.x(), (float) v.y(), (float) v.z());
+  }
+
+  // Only faces with more than 3 vertices need tessellating
+  std::vector<Vector3f> verticesf;
+  std::vector<IndexedTriangle> triangles;
+  mesh.triVerts.reserve(faces.size());
+  for (const auto& face : faces) {
+    if (face.size() == 3) {
+      mesh.triVerts.emplace_back(face[0], face[1], face[2]);
+      continue;
+    }
+    if (face.size() < 3) return nullptr;
+    if (verticesf.empty()) {
+      verticesf.reserve(vertices.size());
+      for (const auto& v : vertices) verticesf.push_back(v.cast<float>());
+    }
+    triangles.clear();
+    if (GeometryUtils::tessellatePolygonWithHoles(verticesf, {face}, triangles)) return nullptr;
+    for (const auto& t : triangles) mesh.triVerts.emplace_back(t[0], t[1], t[2]);
+  }
+
+  auto mani = std::make_shared<manifold::Manifold>(std::move(mesh));
+  if (mani->Status() != Error::NoError) {
+    PRINTDB("Indexed mesh -> Manifold conversion failed: %s", statusToString(mani->Status()));
+    return nullptr;
+  }
+  // An inside out mesh is a valid manifold too
+  if (mani->GetProperties().volume < 0) return nullptr;
+  return mani;
+}
+
 template <class TriangleMesh>
 std::shared_ptr<ManifoldGeometry> createMutableManifoldFromSurfaceMesh(const TriangleMesh& tm)
 {
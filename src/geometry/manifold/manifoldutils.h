@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Geometry.h"
+#include "GeometryUtils.h"
 #include "enums.h"
 #include "ManifoldGeometry.h"
 #include "manifold.h"
@@ -19,6 +20,11 @@ namespace ManifoldUtils {
   /*! If the PolySet isn't trusted, use createMutableManifoldFromPolySet which will triangulate and reorient it. */
   std::shared_ptr<manifold::Manifold> trustedPolySetToManifold(const PolySet& ps);
 
+  /*! Builds a manifold straight from the indexed faces of an imported mesh.
+      Returns nullptr unless the mesh is a closed, outward facing manifold;
+      createMutableManifoldFromPolySet repairs the other ones. */
+  std::shared_ptr<manifold::Manifold> indexedMeshToManifold(const std::vector<Vector3d>& vertices, const std::vector<IndexedFace>& faces);
+
   std::shared_ptr<ManifoldGeometry> createMutableManifoldFromPolySet(const PolySet& ps);
   std::shared_ptr<ManifoldGeometry> createMutableManifoldFromGeometry(const std::shared_ptr<const Geometry>& geom);
 
@@ -199,3 +199,44 @@ std::string Camera::statusText() const
   % viewer_distance % fov;
   return fmt.str();
 }
+
+/*!
+   Inverts the view set up by GLView::setupCamera() for the given pixel.
+ */
+void Camera::pixelRay(double x, double y, Eigen::Vector3d& origin, Eigen::Vector3d& direction) const
+{
+  const double aspectratio = pixel_height ? 1.0 * pixel_width / pixel_height : 1.0;
+  const double ndc_x = pixel_width ? 2.0 * x / pixel_width - 1.0 : 0.0;
+  const double ndc_y = pixel_height ? 1.0 - 2.0 * y / pixel_height : 0.0;
+  const double dist = zoomValue();
+
+  // Ray in eye coordinates, looking down the negative z axis
+  Eigen::Vector3d eye_origin, eye_direction;
+  if (projection == ProjectionType::PERSPECTIVE) {
+    const double height = tan_degrees(fov / 2);
+    eye_origin << 0, 0, 0;
+    eye_direction << ndc_x * height * aspectratio, ndc_y * height, -1;
+  } else {
+    // Start on the near clipping plane, which is behind the eye at 100 * dist,
+    // so objects between it and the eye are hit at a positive distance
+    const double height = dist * tan_degrees(fov / 2);
+    eye_origin << ndc_x * height * aspectratio, ndc_y * height, 100 * dist;
+    eye_direction << 0, 0, -1;
+  }
+
+  // gluLookAt from (0, -dist, 0) towards the origin with z up, then the gimbal rotation and translation
+  Eigen::Affine3d modelview;
+  modelview.matrix() <<
+    1, 0, 0, 0,
+    0, 0, 1, 0,
+    0, -1, 0, -dist,
+    0, 0, 0, 1;
+  modelview.rotate(angle_axis_degrees(object_rot.x(), Eigen::Vector3d::UnitX()));
+  modelview.rotate(angle_axis_degrees(object_rot.y(), Eigen::Vector3d::UnitY()));
+  modelview.rotate(angle_axis_degrees(object_rot.z(), Eigen::Vector3d::UnitZ()));
+  modelview.translate(object_trans);
+
+  const Eigen::Affine3d inverse = modelview.inverse();
+  origin = inverse * eye_origin;
+  direction = (inverse.linear() * eye_direction).normalized();
+}
@@ -36,6 +36,8 @@ public:
   void updateView(const std::shared_ptr<const class FileContext>& context, bool enableWarning);
   void viewAll(const BoundingBox& bbox);
   [[nodiscard]] std::string statusText() const;
+  // The ray through the pixel at (x, y), counted from the top left, in world coordinates
+  void pixelRay(double x, double y, Eigen::Vector3d& origin, Eigen::Vector3d& direction) const;
 
   // accessors to get and set camera settings in the user space format (different for historical reasons)
   [[nodiscard]] Eigen::Vector3d getVpt() const;
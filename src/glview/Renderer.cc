@@ -243,7 +243,6 @@ static void draw_triangle(const Renderer::shaderinfo_t *shaderinfo, const Vector
     }
     break;
   default:
-  case Renderer::SELECT_RENDERING:
     glVertex3d(p0[0], p0[1], p0[2] + z);
     if (!mirror) {
       glVertex3d(p1[0], p1[1], p1[2] + z);
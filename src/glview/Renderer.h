@@ -16,7 +16,6 @@ public:
     NONE,
     CSG_RENDERING,
     EDGE_RENDERING,
-    SELECT_RENDERING,
   };
 
   /// Shader attribute identifiers
@@ -30,9 +29,6 @@ public:
         // barycentric coordinates of the current vertex
         int barycentric;
       } csg_rendering;
-      struct {
-        int identifier;
-      } select_rendering;
     } data;
   };
 
@@ -0,0 +1,228 @@
+#include "CSGPicker.h"
+#include "CSGNode.h"
+#include "PolySet.h"
+
+#include <algorithm>
+#include <limits>
+
+/*!
+   \class CSGPicker
+
+   Picking by ray casting on the CPU, as a replacement for rendering the
+   scene with object ids as colors and reading back a pixel.
+ */
+
+void CSGPicker::import(const shared_ptr<CSGProducts>& products)
+{
+  if (!products) return;
+  this->products.push_back(products);
+  for (const auto& product : products->products) {
+    for (const auto *objects : {&product.intersections, &product.subtractions}) {
+      for (const auto& csgobj : *objects) {
+        if (const auto *ps = dynamic_cast<const PolySet *>(csgobj.leaf->geom.get())) getMesh(*ps);
+      }
+    }
+  }
+}
+
+void CSGPicker::clear()
+{
+  this->products.clear();
+  this->meshes.clear();
+}
+
+const CSGPicker::Mesh& CSGPicker::getMesh(const PolySet& ps)
+{
+  auto it = this->meshes.find(&ps);
+  if (it != this->meshes.end()) return it->second;
+
+  Mesh& mesh = this->meshes[&ps];
+  mesh.solid = ps.getDimension() == 3;
+  for (const auto& polygon : ps.polygons) {
+    for (size_t i = 2; i < polygon.size(); ++i) {
+      mesh.triangles.push_back({polygon[0], polygon[i - 1] - polygon[0], polygon[i] - polygon[0]});
+    }
+  }
+  if (!mesh.triangles.empty()) buildNode(mesh, 0, mesh.triangles.size());
+  return mesh;
+}
+
+/*!
+   Builds the subtree over the given triangles by splitting them at the median
+   of the longest axis of their bounding box. Returns the index of the node.
+ */
+size_t CSGPicker::buildNode(Mesh& mesh, size_t first, size_t count)
+{
+  const size_t index = mesh.nodes.size();
+  mesh.nodes.push_back({BoundingBox(), first, count});
+  BoundingBox bbox;
+  for (size_t i = first; i < first + count; ++i) {
+    const auto& tri = mesh.triangles[i];
+    bbox.extend(tri.p0);
+    bbox.extend(tri.p0 + tri.e1);
+    bbox.extend(tri.p0 + tri.e2);
+  }
+  mesh.nodes[index].bbox = bbox;
+  if (count <= 4) return index;
+
+  int axis;
+  bbox.sizes().maxCoeff(&axis);
+  auto centroid = [axis](const Triangle& tri) {
+      return 3 * tri.p0[axis] + tri.e1[axis] + tri.e2[axis];
+    };
+  const auto begin = mesh.triangles.begin() + first;
+  std::nth_element(begin, begin + count / 2, begin + count,
+                   [&](const Triangle& a, const Triangle& b) { return centroid(a) < centroid(b); });
+
+  buildNode(mesh, first, count / 2);
+  const size_t right = buildNode(mesh, first + count / 2, count - count / 2);
+  mesh.nodes[index].first = right;
+  mesh.nodes[index].count = 0;
+  return index;
+}
+
+static bool intersectsBox(const BoundingBox& bbox, const Vector3d& origin, const Vector3d& invdir)
+{
+  double tmin = -std::numeric_limits<double>::infinity();
+  double tmax = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < 3; ++i) {
+    double t0 = (bbox.min()[i] - origin[i]) * invdir[i];
+    double t1 = (bbox.max()[i] - origin[i]) * invdir[i];
+    if (t0 > t1) std::swap(t0, t1);
+    // NaN (zero direction on the slab boundary) keeps the current bounds
+    if (t0 > tmin) tmin = t0;
+    if (t1 < tmax) tmax = t1;
+  }
+  return tmin <= tmax;
+}
+
+/*!
+   Returns the spans of the ray inside \a leaf, sorted by distance.
+   Flat (2D) geometry gives an empty span at each hit.
+ */
+CSGPicker::Spans CSGPicker::intersect(const CSGLeaf& leaf, const Vector3d& origin, const Vector3d& direction) const
+{
+  Spans spans;
+  const auto *ps = dynamic_cast<const PolySet *>(leaf.geom.get());
+  if (!ps) return spans;
+  auto it = this->meshes.find(ps);
+  if (it == this->meshes.end() || it->second.nodes.empty()) return spans;
+  const Mesh& mesh = it->second;
+
+  // Affine transforms keep distances along the ray, so intersect in leaf coordinates
+  const Transform3d inverse = leaf.matrix.inverse();
+  const Vector3d o = inverse * origin;
+  const Vector3d d = inverse.linear() * direction;
+  const Vector3d invdir = d.cwiseInverse();
+
+  std::vector<std::pair<double, bool>> hits; // distance, entering
+  std::vector<size_t> stack{0};
+  while (!stack.empty()) {
+    const BVHNode& node = mesh.nodes[stack.back()];
+    const size_t nodeindex = stack.back();
+    stack.pop_back();
+    if (!intersectsBox(node.bbox, o, invdir)) continue;
+    if (node.count == 0) {
+      stack.push_back(nodeindex + 1);
+      stack.push_back(node.first);
+      continue;
+    }
+    for (size_t i = node.first; i < node.first + node.count; ++i) {
+      // Möller-Trumbore
+      const Triangle& tri = mesh.triangles[i];
+      const Vector3d p = d.cross(tri.e2);
+      const double det = tri.e1.dot(p);
+      if (std::abs(det) < 1e-14) continue;
+      const Vector3d s = o - tri.p0;
+      const double u = s.dot(p) / det;
+      if (u < 0 || u > 1) continue;
+      const Vector3d q = s.cross(tri.e1);
+      const double v = d.dot(q) / det;
+      if (v < 0 || u + v > 1) continue;
+      hits.emplace_back(tri.e2.dot(q) / det, det > 0);
+    }
+  }
+  std::sort(hits.begin(), hits.end());
+
+  const double inf = std::numeric_limits<double>::infinity();
+  if (!mesh.solid) {
+    for (const auto& hit : hits) spans.push_back({hit.first, hit.first, leaf.index});
+    return spans;
+  }
+  int depth = 0;
+  double start = -inf;
+  for (const auto& [t, entering] : hits) {
+    if (entering) {
+      if (depth++ == 0) start = t;
+    } else if (depth == 0) {
+      // The ray starts inside the object
+      spans.push_back({-inf, t, leaf.index});
+    } else if (--depth == 0) {
+      spans.push_back({start, t, leaf.index});
+    }
+  }
+  if (depth > 0) spans.push_back({start, inf, leaf.index});
+  return spans;
+}
+
+static std::vector<CSGPicker::Span> intersectSpans(const std::vector<CSGPicker::Span>& a, const std::vector<CSGPicker::Span>& b)
+{
+  std::vector<CSGPicker::Span> result;
+  size_t i = 0, j = 0;
+  while (i < a.size() && j < b.size()) {
+    const double start = std::max(a[i].start, b[j].start);
+    const double end = std::min(a[i].end, b[j].end);
+    if (start <= end) result.push_back({start, end, a[i].start >= b[j].start ? a[i].index : b[j].index});
+    if (a[i].end < b[j].end) ++i;
+    else ++j;
+  }
+  return result;
+}
+
+static std::vector<CSGPicker::Span> subtractSpans(const std::vector<CSGPicker::Span>& a, const std::vector<CSGPicker::Span>& b)
+{
+  std::vector<CSGPicker::Span> result;
+  for (auto span : a) {
+    bool remaining = true;
+    for (const auto& cut : b) {
+      if (cut.end < span.start || cut.start > span.end) continue;
+      if (cut.start > span.start) result.push_back({span.start, cut.start, span.index});
+      if (cut.end >= span.end) {
+        remaining = false;
+        break;
+      }
+      // What remains starts on the surface of the subtracted object
+      span.start = cut.end;
+      span.index = cut.index;
+    }
+    if (remaining) result.push_back(span);
+  }
+  return result;
+}
+
+boost::optional<CSGPicker::Hit> CSGPicker::pick(const Vector3d& origin, const Vector3d& direction) const
+{
+  boost::optional<Hit> result;
+  for (const auto& products : this->products) {
+    for (const auto& product : products->products) {
+      if (product.intersections.empty()) continue;
+      auto spans = intersect(*product.intersections.front().leaf, origin, direction);
+      for (size_t i = 1; i < product.intersections.size() && !spans.empty(); ++i) {
+        spans = intersectSpans(spans, intersect(*product.intersections[i].leaf, origin, direction));
+      }
+      for (size_t i = 0; i < product.subtractions.size() && !spans.empty(); ++i) {
+        spans = subtractSpans(spans, intersect(*product.subtractions[i].leaf, origin, direction));
+      }
+
+      for (const auto& span : spans) {
+        if (span.end < 0) continue;
+        const double distance = std::max(span.start, 0.0);
+        if (!result || distance < result->distance) {
+          result = Hit{span.index, distance, origin + distance * direction};
+        }
+        break;
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "linalg.h"
+#include "memory.h"
+
+#include <boost/optional.hpp>
+#include <unordered_map>
+#include <vector>
+
+class CSGProducts;
+class PolySet;
+
+/*!
+   Finds the object visible along a ray through the preview, without rendering.
+
+   A bounding volume hierarchy is built over the triangles of each leaf geometry
+   of the imported CSG products. A ray is intersected with each leaf, and the
+   resulting spans are combined like OpenCSG combines the products, so the hit
+   is on the surface actually visible in the preview.
+ */
+class CSGPicker
+{
+public:
+  struct Hit {
+    int index;       // AbstractNode index of the leaf owning the hit surface
+    double distance; // Along the ray
+    Vector3d point;  // In world coordinates
+  };
+  // The part of a ray inside an object, and the leaf whose surface it starts on
+  struct Span {
+    double start, end;
+    int index;
+  };
+  using Spans = std::vector<Span>;
+
+  void import(const shared_ptr<CSGProducts>& products);
+  void clear();
+
+  [[nodiscard]] boost::optional<Hit> pick(const Vector3d& origin, const Vector3d& direction) const;
+
+private:
+  struct Triangle {
+    Vector3d p0, e1, e2;
+  };
+  struct BVHNode {
+    BoundingBox bbox;
+    size_t first; // First triangle for leaves, index of the right child otherwise
+    size_t count; // Number of triangles, 0 for inner nodes
+  };
+  // Triangles of one geometry, shared by all leaves using it
+  struct Mesh {
+    bool solid;
+    std::vector<Triangle> triangles;
+    std::vector<BVHNode> nodes;
+  };
+
+  const Mesh& getMesh(const PolySet& ps);
+  size_t buildNode(Mesh& mesh, size_t first, size_t count);
+  Spans intersect(const class CSGLeaf& leaf, const Vector3d& origin, const Vector3d& direction) const;
+
+  std::vector<shared_ptr<CSGProducts>> products;
+  std::unordered_map<const PolySet *, Mesh> meshes;
+};
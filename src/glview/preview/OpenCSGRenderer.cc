@@ -360,13 +360,6 @@ void OpenCSGRenderer::renderCSGProducts(const std::shared_ptr<CSGProducts>& prod
         const auto *ps = dynamic_cast<const PolySet *>(csgobj.leaf->geom.get());
         if (!ps) continue;
 
-        if (shaderinfo && shaderinfo->type == Renderer::SELECT_RENDERING) {
-          int identifier = csgobj.leaf->index;
-          GL_CHECKD(glUniform3f(shaderinfo->data.select_rendering.identifier,
-                                ((identifier >> 0) & 0xff) / 255.0f, ((identifier >> 8) & 0xff) / 255.0f,
-                                ((identifier >> 16) & 0xff) / 255.0f));
-        }
-
         const Color4f& c = csgobj.leaf->color;
         csgmode_e csgmode = get_csgmode(highlight_mode, background_mode);
 
@@ -449,19 +442,6 @@ void OpenCSGRenderer::renderCSGProducts(const std::shared_ptr<CSGProducts>& prod
 
       for (const auto& vs : product->states()) {
         if (vs) {
-          std::shared_ptr<OpenCSGVertexState> csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(vs);
-          if (csg_vs) {
-            if (shaderinfo && shaderinfo->type == SELECT_RENDERING) {
-              GL_TRACE("glUniform3f(%d, %f, %f, %f)", shaderinfo->data.select_rendering.identifier %
-                       (((csg_vs->csgObjectIndex() >> 0) & 0xff) / 255.0f) %
-                       (((csg_vs->csgObjectIndex() >> 8) & 0xff) / 255.0f) %
-                       (((csg_vs->csgObjectIndex() >> 16) & 0xff) / 255.0f));
-              GL_CHECKD(glUniform3f(shaderinfo->data.select_rendering.identifier,
-                                    ((csg_vs->csgObjectIndex() >> 0) & 0xff) / 255.0f,
-                                    ((csg_vs->csgObjectIndex() >> 8) & 0xff) / 255.0f,
-                                    ((csg_vs->csgObjectIndex() >> 16) & 0xff) / 255.0f));
-            }
-          }
           std::shared_ptr<VBOShaderVertexState> shader_vs = std::dynamic_pointer_cast<VBOShaderVertexState>(vs);
           if (!shader_vs || (showedges && shader_vs)) {
             vs->draw();
@@ -142,13 +142,7 @@ void ThrownTogetherRenderer::renderChainObject(const CSGChainObject& csgobj, boo
   colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, fberror, type);
   const Transform3d& m = csgobj.leaf->matrix;
 
-  if (shaderinfo && shaderinfo->type == Renderer::SELECT_RENDERING) {
-    int identifier = csgobj.leaf->index;
-    glUniform3f(shaderinfo->data.select_rendering.identifier, ((identifier >> 0) & 0xff) / 255.0f,
-                ((identifier >> 8) & 0xff) / 255.0f, ((identifier >> 16) & 0xff) / 255.0f);
-  } else {
-    setColor(colormode, c.data());
-  }
+  setColor(colormode, c.data());
   glPushMatrix();
   glMultMatrixd(m.data());
   render_surface(*ps, csgmode, m, shaderinfo);
@@ -182,20 +176,6 @@ void ThrownTogetherRenderer::renderCSGProducts(const std::shared_ptr<CSGProducts
   } else {
     for (const auto& vs : vertex_states) {
       if (vs) {
-        std::shared_ptr<TTRVertexState> csg_vs = std::dynamic_pointer_cast<TTRVertexState>(vs);
-        if (csg_vs) {
-          if (shaderinfo && shaderinfo->type == Renderer::SELECT_RENDERING) {
-            GL_TRACE("glUniform3f(%d, %f, %f, %f)",
-                     shaderinfo->data.select_rendering.identifier %
-                     (((csg_vs->csgObjectIndex() >> 0) & 0xff) / 255.0f) %
-                     (((csg_vs->csgObjectIndex() >> 8) & 0xff) / 255.0f) %
-                     (((csg_vs->csgObjectIndex() >> 16) & 0xff) / 255.0f));
-            GL_CHECKD(glUniform3f(shaderinfo->data.select_rendering.identifier,
-                                  ((csg_vs->csgObjectIndex() >> 0) & 0xff) / 255.0f,
-                                  ((csg_vs->csgObjectIndex() >> 8) & 0xff) / 255.0f,
-                                  ((csg_vs->csgObjectIndex() >> 16) & 0xff) / 255.0f));
-          }
-        }
         std::shared_ptr<VBOShaderVertexState> shader_vs = std::dynamic_pointer_cast<VBOShaderVertexState>(vs);
         if (!shader_vs || (shader_vs && showedges)) {
           vs->draw();
@@ -3,6 +3,7 @@
 #include "MainWindow.h"
 #include <boost/filesystem.hpp>
 #include <QFormLayout>
+#include <QSignalBlocker>
 
 Animate::Animate(QWidget *parent) : QWidget(parent)
 {
@@ -175,16 +176,23 @@ void Animate::incrementTVal()
     if (mainWindow->activeEditor->parameterWidget->childHasFocus()) return;
   }
 
-  if (this->anim_numsteps > 1) {
-    this->anim_step = (this->anim_step + 1) % this->anim_numsteps;
-    this->anim_tval = 1.0 * this->anim_step / this->anim_numsteps;
-  } else if (this->anim_numsteps > 0) {
-    this->anim_step = 0;
-    this->anim_tval = 0.0;
-  }
+  const int step = this->anim_numsteps > 1 ? (this->anim_step + 1) % this->anim_numsteps : 0;
+
+  // Show a precomputed frame instead of evaluating it; if it isn't
+  // ready yet, keep showing the current one.
+  const bool precomputed = !dumpPictures() && mainWindow->canPrecomputeAnimation();
+  if (precomputed && !mainWindow->showAnimationFrame(step, this->anim_numsteps)) return;
+
+  this->anim_step = step;
+  this->anim_tval = this->anim_numsteps > 1 ? 1.0 * this->anim_step / this->anim_numsteps : 0.0;
 
   const QString txt = QString::number(this->anim_tval, 'f', 5);
-  this->e_tval->setText(txt);
+  {
+    // The frame is already shown, so don't trigger a preview
+    const QSignalBlocker blocker(precomputed ? this->e_tval : nullptr);
+    this->e_tval->setText(txt);
+  }
+  if (precomputed) this->anim_tval = txt.toDouble();
 
   updatePauseButtonIcon();
 }
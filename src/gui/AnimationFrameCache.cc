@@ -0,0 +1,198 @@
+#include "AnimationFrameCache.h"
+#include "BuiltinContext.h"
+#include "CSGNode.h"
+#include "CSGTreeEvaluator.h"
+#include "CSGTreeNormalizer.h"
+#include "GeometryEvaluator.h"
+#include "MainWindow.h"
+#include "SourceFile.h"
+#include "Tree.h"
+#include "core/node.h"
+#include "exceptions.h"
+#include "printutils.h"
+
+#include <QString>
+#include <algorithm>
+#include <cmath>
+
+// Frames kept at most. Once the whole loop doesn't fit, the frames furthest
+// ahead of the playhead are dropped first.
+static const size_t MAX_CACHED_FRAMES = 256;
+
+AnimationFrameCache::~AnimationFrameCache()
+{
+  stop();
+}
+
+/*!
+   Returns $t for the given step, the same way Animate computes it, so
+   frames can be looked up by the $t shown in the animation widget.
+ */
+double AnimationFrameCache::frameTime(int step, int numsteps)
+{
+  const double t = numsteps > 1 ? 1.0 * step / numsteps : 0.0;
+  return QString::number(t, 'f', 5).toDouble();
+}
+
+shared_ptr<AnimationFrame> AnimationFrameCache::get(double t) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->frames.find(t);
+  return it != this->frames.end() ? it->second : nullptr;
+}
+
+/*!
+   Moves the playhead to \a step and starts the worker if frames ahead of it
+   are missing. A different root file discards all frames.
+   Returns true if the worker is running.
+ */
+bool AnimationFrameCache::precompute(const Source& source, int step, int numsteps)
+{
+  if (source.root_file != this->src.root_file) {
+    stop();
+    clear();
+  }
+  if (this->failed) return false;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->playhead = step;
+    this->numsteps = numsteps;
+    double t;
+    if (this->running || !nextFrame(t)) return this->running;
+  }
+
+  if (this->thread.joinable()) this->thread.join();
+  this->src = source;
+  this->cancelled = false;
+  this->running = true;
+  this->thread = std::thread(&AnimationFrameCache::work, this);
+  return true;
+}
+
+/*!
+   Stops the worker after the frame it's evaluating, and waits for it.
+ */
+void AnimationFrameCache::stop()
+{
+  this->cancelled = true;
+  if (this->thread.joinable()) this->thread.join();
+}
+
+void AnimationFrameCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->frames.clear();
+  this->failed = false;
+}
+
+/*!
+   Finds the first frame from the playhead on which isn't cached, making room
+   for it if needed. Returns false if there is nothing to precompute.
+   Must be called with the mutex locked.
+ */
+bool AnimationFrameCache::nextFrame(double& t)
+{
+  const int numsteps = std::max(this->numsteps, 1);
+  // Number of steps until the frame at the given $t is shown
+  auto ahead = [&](double frametime) {
+      return (std::lround(frametime * numsteps) - this->playhead + numsteps) % numsteps;
+    };
+  int missing = 0;
+  while (missing < numsteps && this->frames.count(frameTime((this->playhead + missing) % numsteps, numsteps))) {
+    ++missing;
+  }
+  if (missing == numsteps) return false;
+
+  if (this->frames.size() >= MAX_CACHED_FRAMES) {
+    auto furthest = std::max_element(this->frames.begin(), this->frames.end(),
+                                     [&](const auto& a, const auto& b) { return ahead(a.first) < ahead(b.first); });
+    // The cache already holds the frames needed soonest
+    if (ahead(furthest->first) <= missing) return false;
+    this->frames.erase(furthest);
+  }
+  t = frameTime((this->playhead + missing) % numsteps, numsteps);
+  return true;
+}
+
+void AnimationFrameCache::work()
+{
+  // this is a worker thread: we don't want any exceptions escaping and crashing the app.
+  try {
+    while (!this->cancelled) {
+      double t;
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!nextFrame(t)) break;
+      }
+      auto frame = evaluate(t);
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->frames[t] = frame;
+    }
+  } catch (const HardWarningException& e) {
+    LOG("Animation precomputation cancelled on first warning.");
+    this->failed = true;
+  } catch (const std::exception& e) {
+    LOG(message_group::Error, "Animation precomputation cancelled by exception %1$s", e.what());
+    this->failed = true;
+  } catch (...) {
+    LOG(message_group::Error, "Animation precomputation cancelled by unknown exception.");
+    this->failed = true;
+  }
+
+  this->running = false;
+  emit finished();
+}
+
+/*!
+   Evaluates the root file at \a t, like MainWindow::instantiateRoot() and
+   MainWindow::compileCSG() do for the current frame.
+ */
+shared_ptr<AnimationFrame> AnimationFrameCache::evaluate(double t) const
+{
+  auto frame = std::make_shared<AnimationFrame>();
+
+  AbstractNode::resetIndexCounter();
+  EvaluationSession session{this->src.document_path};
+  ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
+  MainWindow::setRenderVariables(builtin_context, true, t, this->src.camera);
+
+  std::shared_ptr<const FileContext> file_context;
+  frame->absolute_root_node = this->src.root_file->instantiate(*builtin_context, &file_context);
+  if (file_context) {
+    for (const char *name : {"$vpr", "$vpt", "$vpd", "$vpf"}) {
+      if (file_context->lookup_local_variable(name)) frame->script_camera = true;
+    }
+    if (frame->script_camera) {
+      frame->camera = this->src.camera;
+      frame->camera.updateView(file_context, false);
+    }
+  }
+  if (!frame->absolute_root_node) return frame;
+  if (!(frame->root_node = find_root_tag(frame->absolute_root_node))) {
+    frame->root_node = frame->absolute_root_node;
+  }
+
+  Tree tree(frame->root_node, this->src.document_path);
+  GeometryEvaluator geomevaluator(tree);
+  CSGTreeEvaluator csgrenderer(tree, &geomevaluator);
+  frame->csgRoot = csgrenderer.buildCSGTree(*frame->root_node);
+
+  CSGTreeNormalizer normalizer(this->src.normalizelimit);
+  if (frame->csgRoot) {
+    frame->normalizedRoot = normalizer.normalize(frame->csgRoot);
+    if (frame->normalizedRoot) {
+      frame->root_products = std::make_shared<CSGProducts>();
+      frame->root_products->import(frame->normalizedRoot);
+    }
+  }
+  auto import = [&](const std::vector<shared_ptr<CSGNode>>& terms, shared_ptr<CSGProducts>& products) {
+      if (terms.empty()) return;
+      products = std::make_shared<CSGProducts>();
+      for (const auto& term : terms) {
+        if (auto nterm = normalizer.normalize(term)) products->import(nterm);
+      }
+    };
+  import(csgrenderer.getHighlightNodes(), frame->highlights_products);
+  import(csgrenderer.getBackgroundNodes(), frame->background_products);
+  return frame;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QObject>
+#include "Camera.h"
+#include "memory.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class AbstractNode;
+class CSGNode;
+class CSGProducts;
+class SourceFile;
+class ThrownTogetherRenderer;
+
+/*!
+   Everything needed to show one animation frame without evaluating the design.
+ */
+struct AnimationFrame
+{
+  shared_ptr<AbstractNode> absolute_root_node;
+  shared_ptr<AbstractNode> root_node;
+  shared_ptr<CSGNode> csgRoot;
+  shared_ptr<CSGNode> normalizedRoot;
+  shared_ptr<CSGProducts> root_products;
+  shared_ptr<CSGProducts> highlights_products;
+  shared_ptr<CSGProducts> background_products;
+
+  // The view set by $vpr, $vpt, $vpd or $vpf in the design, if any
+  bool script_camera{false};
+  Camera camera;
+
+  // Created on the GUI thread when the frame is first shown, so the vertex
+  // buffers they build are kept with the frame.
+  bool renderers_created{false};
+#ifdef ENABLE_OPENCSG
+  shared_ptr<class OpenCSGRenderer> opencsgRenderer;
+#endif
+  shared_ptr<ThrownTogetherRenderer> thrownTogetherRenderer;
+};
+
+/*!
+   Precomputes upcoming animation frames on a worker thread while the
+   animation is playing, and keeps a bounded number of them keyed by $t.
+
+   The worker parses nothing: it instantiates the already parsed root file
+   for each $t and builds the CSG products. The caller must stop() the worker
+   before touching the root file, evaluating anything on the GUI thread, or
+   clearing or invalidating the source file, stat, path or dxf caches. The
+   geometry caches are locked and node indices are counted per thread.
+ */
+class AnimationFrameCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  AnimationFrameCache() = default;
+  ~AnimationFrameCache() override;
+
+  // Snapshot of everything the worker needs from the GUI thread
+  struct Source {
+    const SourceFile *root_file{nullptr};
+    std::string document_path;
+    Camera camera;
+    size_t normalizelimit{0};
+  };
+
+  [[nodiscard]] shared_ptr<AnimationFrame> get(double t) const;
+  bool precompute(const Source& source, int step, int numsteps);
+  [[nodiscard]] bool isRunning() const { return this->running; }
+  // True if evaluating a frame failed since the last clear()
+  [[nodiscard]] bool hasFailed() const { return this->failed; }
+  void stop();
+  void clear();
+
+  static double frameTime(int step, int numsteps);
+
+signals:
+  void finished();
+
+private:
+  bool nextFrame(double& t);
+  void work();
+  shared_ptr<AnimationFrame> evaluate(double t) const;
+
+  Source src;
+  int playhead{0};
+  int numsteps{0};
+  std::map<double, shared_ptr<AnimationFrame>> frames;
+  mutable std::mutex mutex;
+  std::thread thread;
+  std::atomic<bool> running{false};
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> failed{false};
+};
@@ -0,0 +1,77 @@
+#include "FileWatcher.h"
+#include "PathCache.h"
+#include "SourceFileCache.h"
+#include "StatCache.h"
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <boost/filesystem.hpp>
+
+namespace fs = boost::filesystem;
+
+FileWatcher::FileWatcher(QObject *parent) : QObject(parent)
+{
+  this->watcher = new QFileSystemWatcher(this);
+  connect(this->watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+  connect(this->watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+}
+
+/*!
+   Watches the given files, and the directories containing them so files
+   replaced by renaming or created later are noticed. If \a complete is false
+   the files are only a part of the dependencies, and changes may be missed.
+ */
+void FileWatcher::setFiles(std::unordered_set<std::string> files, bool complete)
+{
+  if (files == this->files && complete == this->complete) return;
+
+  if (!this->watcher->files().isEmpty()) this->watcher->removePaths(this->watcher->files());
+  if (!this->watcher->directories().isEmpty()) this->watcher->removePaths(this->watcher->directories());
+
+  QStringList paths;
+  QStringList dirs;
+  for (const auto& file : files) {
+    const auto dir = QString::fromStdString(fs::path(file).parent_path().generic_string());
+    if (!dir.isEmpty() && !dirs.contains(dir)) dirs << dir;
+    if (QFileInfo::exists(QString::fromStdString(file))) paths << QString::fromStdString(file);
+  }
+  // Files which don't exist yet are noticed by watching their directory
+  auto failed = this->watcher->addPaths(dirs);
+  if (!paths.isEmpty()) failed += this->watcher->addPaths(paths);
+
+  this->files = std::move(files);
+  this->complete = complete && failed.isEmpty();
+  StatCache::setWatched(this->complete ? this->files : std::unordered_set<std::string>());
+}
+
+void FileWatcher::invalidate(const std::string& file)
+{
+  StatCache::invalidate(file);
+  // A file may also have appeared in front of one found in a library directory
+  PathCache::instance()->clear();
+  this->changes = true;
+}
+
+void FileWatcher::fileChanged(const QString& path)
+{
+  const auto file = path.toStdString();
+  emit aboutToInvalidate();
+  invalidate(file);
+  SourceFileCache::instance()->invalidate(file);
+  // Files replaced by renaming are no longer watched
+  if (!this->watcher->files().contains(path) && QFileInfo::exists(path)) this->watcher->addPath(path);
+  emit changed(path);
+}
+
+void FileWatcher::directoryChanged(const QString& path)
+{
+  const auto dir = path.toStdString();
+  emit aboutToInvalidate();
+  for (const auto& file : this->files) {
+    if (fs::path(file).parent_path().generic_string() != dir) continue;
+    invalidate(file);
+    const auto qfile = QString::fromStdString(file);
+    if (!this->watcher->files().contains(qfile) && QFileInfo::exists(qfile)) this->watcher->addPath(qfile);
+  }
+  emit changed(path);
+}
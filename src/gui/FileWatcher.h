@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QObject>
+#include <string>
+#include <unordered_set>
+
+class QFileSystemWatcher;
+
+/*!
+   Watches the files a design depends on, using the system's file change
+   notifications (inotify on Linux), so auto-reload doesn't have to poll them.
+
+   Reported changes invalidate the affected StatCache and SourceFileCache
+   entries. As long as every dependency is watched, StatCache keeps their
+   entries instead of calling stat() again after a short time. The
+   aboutToInvalidate() signal is emitted first, so anything reading the caches
+   on another thread can be stopped.
+ */
+class FileWatcher : public QObject
+{
+  Q_OBJECT
+
+public:
+  FileWatcher(QObject *parent = nullptr);
+
+  void setFiles(std::unordered_set<std::string> files, bool complete);
+  // True if all files are watched, so changes are reported by the changed() signal
+  [[nodiscard]] bool isComplete() const { return this->complete; }
+  [[nodiscard]] bool hasChanges() const { return this->changes; }
+  void clearChanges() { this->changes = false; }
+
+signals:
+  void aboutToInvalidate();
+  void changed(const QString& path);
+
+private slots:
+  void fileChanged(const QString& path);
+  void directoryChanged(const QString& path);
+
+private:
+  void invalidate(const std::string& file);
+
+  QFileSystemWatcher *watcher;
+  std::unordered_set<std::string> files;
+  bool complete{false};
+  bool changes{false};
+};
@@ -30,6 +30,7 @@
 #include "openscad.h"
 #include "GeometryCache.h"
 #include "SourceFileCache.h"
+#include "PathCache.h"
 #include "MainWindow.h"
 #include "OpenSCADApp.h"
 #include "parsersettings.h"
@@ -57,7 +58,9 @@
 #include "ThrownTogetherRenderer.h"
 #include "CSGTreeNormalizer.h"
 #include "QGLView.h"
-#include "MouseSelector.h"
+#include "CSGPicker.h"
+#include "AnimationFrameCache.h"
+#include "FileWatcher.h"
 #ifdef Q_OS_MAC
 #include "CocoaUtils.h"
 #endif
@@ -368,15 +371,12 @@ MainWindow::MainWindow(const QStringList& filenames)
   connect(this->cgalworker, SIGNAL(done(shared_ptr<const Geometry>)),
           this, SLOT(actionRenderDone(shared_ptr<const Geometry>)));
 #endif
+  this->animationFrames = std::make_unique<AnimationFrameCache>();
+  connect(this->animationFrames.get(), SIGNAL(finished()), this, SLOT(animationFramesFinished()));
 
 #ifdef ENABLE_CGAL
   this->cgalRenderer = nullptr;
 #endif
-#ifdef ENABLE_OPENCSG
-  this->opencsgRenderer = nullptr;
-#endif
-  this->thrownTogetherRenderer = nullptr;
-
   root_node = nullptr;
 
   this->qglview->statusLabel = new QLabel(this);
@@ -397,6 +397,11 @@ MainWindow::MainWindow(const QStringList& filenames)
   waitAfterReloadTimer->setSingleShot(true);
   waitAfterReloadTimer->setInterval(autoReloadPollingPeriodMS);
   connect(waitAfterReloadTimer, SIGNAL(timeout()), this, SLOT(waitAfterReload()));
+
+  this->fileWatcher = new FileWatcher(this);
+  // Frames are evaluated from the caches the watcher invalidates
+  connect(this->fileWatcher, SIGNAL(aboutToInvalidate()), this, SLOT(stopAnimationFrames()));
+  connect(this->fileWatcher, SIGNAL(changed(QString)), this, SLOT(watchedFileChanged(QString)));
   connect(Preferences::inst(), SIGNAL(ExperimentalChanged()), this, SLOT(changeParameterWidget()));
 
   progressThrottle->start();
@@ -730,7 +735,6 @@ MainWindow::MainWindow(const QStringList& filenames)
 
   updateExportActions();
 
-  this->selector = std::make_unique<MouseSelector>(this->qglview);
   activeEditor->setFocus();
 }
 
@@ -967,16 +971,13 @@ void MainWindow::updateReorderMode(bool reorderMode)
 
 MainWindow::~MainWindow()
 {
+  this->animationFrames->stop();
   // If root_file is not null then it will be the same as parsed_file,
   // so no need to delete it.
   delete parsed_file;
 #ifdef ENABLE_CGAL
   delete this->cgalRenderer;
 #endif
-#ifdef ENABLE_OPENCSG
-  delete this->opencsgRenderer;
-#endif
-  delete this->thrownTogetherRenderer;
   scadApp->windowManager.remove(this);
   if (scadApp->windowManager.getWindows().size() == 0) {
     // Quit application even in case some other windows like
@@ -1053,6 +1054,12 @@ void MainWindow::compile(bool reload, bool forcedone)
   OpenSCAD::parameterCheck = Preferences::inst()->getValue("advanced/enableParameterCheck").toBool();
   OpenSCAD::rangeCheck = Preferences::inst()->getValue("advanced/enableParameterRangeCheck").toBool();
 
+  // Frames are evaluated from the same root file and file caches
+  this->animationFrames->stop();
+  // Without a watcher reporting changes, files may have appeared or disappeared
+  if (!reload || this->watchedEditor != activeEditor || !this->fileWatcher->isComplete()) {
+    PathCache::instance()->clear();
+  }
   try{
     bool shouldcompiletoplevel = false;
     bool didcompile = false;
@@ -1064,6 +1071,7 @@ void MainWindow::compile(bool reload, bool forcedone)
 
     // Reload checks the timestamp of the toplevel file and refreshes if necessary,
     if (reload) {
+      this->fileWatcher->clearChanges();
       // Refresh files if it has changed on disk
       if (fileChangedOnDisk() && checkEditorModified()) {
         shouldcompiletoplevel = tabManager->refreshDocument(); // don't compile if we couldn't open the file
@@ -1084,11 +1092,13 @@ void MainWindow::compile(bool reload, bool forcedone)
       shouldcompiletoplevel = true;
     }
 
+    bool includeschanged = false;
     if (this->parsed_file) {
       auto mtime = this->parsed_file->includesChanged();
       if (mtime > this->includes_mtime) {
         this->includes_mtime = mtime;
         shouldcompiletoplevel = true;
+        includeschanged = true;
       }
     }
     // Parsing and dependency handling must run to completion even with stop on errors to prevent auto
@@ -1100,7 +1110,7 @@ void MainWindow::compile(bool reload, bool forcedone)
         this->console->actionClearConsole_triggered();
       }
       if (activeEditor->isContentModified()) saveBackup();
-      parseTopLevelDocument();
+      parseTopLevelDocument(!includeschanged);
       didcompile = true;
     }
 
@@ -1118,6 +1128,7 @@ void MainWindow::compile(bool reload, bool forcedone)
         didcompile = true;
       }
     }
+    updateFileWatcher();
 
     // Had any errors in the parse that would have caused exceptions via PRINT.
     if (would_have_thrown()) throw HardWarningException("");
@@ -1229,11 +1240,9 @@ void MainWindow::instantiateRoot()
   // Invalidate renderers before we kill the CSG tree
   this->qglview->setRenderer(nullptr);
 #ifdef ENABLE_OPENCSG
-  delete this->opencsgRenderer;
-  this->opencsgRenderer = nullptr;
+  this->opencsgRenderer.reset();
 #endif
-  delete this->thrownTogetherRenderer;
-  this->thrownTogetherRenderer = nullptr;
+  this->thrownTogetherRenderer.reset();
 
   // Remove previous CSG tree
   this->absolute_root_node.reset();
@@ -1241,6 +1250,7 @@ void MainWindow::instantiateRoot()
   this->csgRoot.reset();
   this->normalizedRoot.reset();
   this->root_products.reset();
+  this->picker.reset();
 
   this->root_node.reset();
   this->tree.setRoot(nullptr);
@@ -1398,14 +1408,14 @@ void MainWindow::compileCSG()
     else {
       LOG("Normalized tree has %1$d elements!",
           (this->root_products ? this->root_products->size() : 0));
-      this->opencsgRenderer = new OpenCSGRenderer(this->root_products,
-                                                  this->highlights_products,
-                                                  this->background_products);
+      this->opencsgRenderer = std::make_shared<OpenCSGRenderer>(this->root_products,
+                                                                this->highlights_products,
+                                                                this->background_products);
     }
 #endif
-    this->thrownTogetherRenderer = new ThrownTogetherRenderer(this->root_products,
-                                                              this->highlights_products,
-                                                              this->background_products);
+    this->thrownTogetherRenderer = std::make_shared<ThrownTogetherRenderer>(this->root_products,
+                                                                            this->highlights_products,
+                                                                            this->background_products);
     LOG("Compile and preview finished.");
     renderStatistic.printRenderingTime();
     this->processEvents();
@@ -1796,14 +1806,19 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
 
 void MainWindow::setRenderVariables(ContextHandle<BuiltinContext>& context)
 {
-  context->set_variable("$preview", Value(this->is_preview));
-  context->set_variable("$t", Value(this->animateWidget->getAnim_tval()));
-  auto camVpt = qglview->cam.getVpt();
+  setRenderVariables(context, this->is_preview, this->animateWidget->getAnim_tval(), qglview->cam);
+}
+
+void MainWindow::setRenderVariables(ContextHandle<BuiltinContext>& context, bool preview, double t, const Camera& cam)
+{
+  context->set_variable("$preview", Value(preview));
+  context->set_variable("$t", Value(t));
+  auto camVpt = cam.getVpt();
   context->set_variable("$vpt", Value(VectorType(context->session(), camVpt.x(), camVpt.y(), camVpt.z())));
-  auto camVpr = qglview->cam.getVpr();
+  auto camVpr = cam.getVpr();
   context->set_variable("$vpr", Value(VectorType(context->session(), camVpr.x(), camVpr.y(), camVpr.z())));
-  context->set_variable("$vpd", Value(qglview->cam.zoomValue()));
-  context->set_variable("$vpf", Value(qglview->cam.fovValue()));
+  context->set_variable("$vpd", Value(cam.zoomValue()));
+  context->set_variable("$vpf", Value(cam.fovValue()));
 }
 
 /*!
@@ -1887,8 +1902,20 @@ bool MainWindow::trust_python_file(const std::string &file,  const std::string &
 }
 #endif
 	
-void MainWindow::parseTopLevelDocument()
+/*!
+   Parses the document of the active editor into root_file.
+
+   If \a reuseParsedFile is set and neither the text nor the editor changed
+   since the last successful parse (e.g. repeated F5/F6 without edits, or
+   after the initial parse done when opening a file), the existing AST is
+   kept and only the customizer parameters are re-applied.
+ */
+void MainWindow::parseTopLevelDocument(bool reuseParsedFile)
 {
+  // Precomputed animation frames may be for another text or other parameters
+  this->animationFrames->stop();
+  this->animationFrames->clear();
+
   resetSuppressedMessages();
 
   this->last_compiled_doc = activeEditor->toPlainText();
@@ -1897,6 +1924,19 @@ void MainWindow::parseTopLevelDocument()
     std::string(this->last_compiled_doc.toUtf8().constData()) +
     "\n\x03\n" + commandline_commands;
 
+  if (reuseParsedFile && this->root_file && this->root_file == this->parsed_file &&
+      this->last_parsed_editor == this->activeEditor && this->last_parsed_text == fulltext) {
+    parser_error_pos = -1;
+    this->activeEditor->resetHighlighting();
+    this->activeEditor->parameterWidget->applyParameters(this->root_file);
+    this->activeEditor->parameterWidget->setEnabled(true);
+    this->activeEditor->setIndicator(this->root_file->indicatorData);
+    return;
+  }
+  this->last_parsed_text.clear();
+  this->last_parsed_editor = this->activeEditor;
+  const auto doctext = fulltext;
+
   auto fnameba = activeEditor->filepath.toLocal8Bit();
   const char *fname = activeEditor->filepath.isEmpty() ? "" : fnameba;
   delete this->parsed_file;
@@ -1927,6 +1967,11 @@ void MainWindow::parseTopLevelDocument()
 
   this->activeEditor->resetHighlighting();
   if (this->root_file != nullptr) {
+#ifdef ENABLE_PYTHON
+    if (!this->python_active) this->last_parsed_text = doctext;
+#else
+    this->last_parsed_text = doctext;
+#endif
     //add parameters as annotation in AST
     CommentParser::collectParameters(fulltext, this->root_file);
     this->activeEditor->parameterWidget->setParameters(this->root_file, fulltext);
@@ -1946,10 +1991,33 @@ void MainWindow::changeParameterWidget()
 void MainWindow::checkAutoReload()
 {
   if (!activeEditor->filepath.isEmpty()) {
+    // If all files are watched, there is nothing to check until one changes
+    if (this->watchedEditor == activeEditor && this->fileWatcher->isComplete() &&
+        !this->fileWatcher->hasChanges()) return;
     actionReloadRenderPreview();
   }
 }
 
+/*!
+   Watches the active document and the files it depends on for auto-reload.
+ */
+void MainWindow::updateFileWatcher()
+{
+  std::unordered_set<std::string> files;
+  auto complete = !activeEditor->filepath.isEmpty();
+  if (complete) files.insert(activeEditor->filepath.toStdString());
+  if (this->parsed_file && !this->parsed_file->collectDependencies(files)) complete = false;
+  this->fileWatcher->setFiles(std::move(files), complete);
+  this->watchedEditor = activeEditor;
+}
+
+void MainWindow::watchedFileChanged(const QString& path)
+{
+  // The modification time doesn't show changes within the same second
+  if (this->parsed_file && this->parsed_file->hasInclude(path.toStdString())) this->includes_mtime = 0;
+  if (designActionAutoReload->isChecked()) checkAutoReload();
+}
+
 void MainWindow::autoReloadSet(bool on)
 {
   QSettingsCached settings;
@@ -2005,6 +2073,113 @@ void MainWindow::csgReloadRender()
   compileEnded();
 }
 
+/*!
+   Returns true if animation playback can show precomputed frames, which are
+   evaluated off the GUI thread from the design parsed from the current editor.
+ */
+bool MainWindow::canPrecomputeAnimation()
+{
+  if (!Feature::ExperimentalAnimationFrameCache.is_enabled() || this->animationFrames->hasFailed()) return false;
+#ifdef ENABLE_PYTHON
+  if (this->python_active) return false;
+#endif
+  return this->root_file && this->root_file == this->parsed_file &&
+         this->last_parsed_editor == this->activeEditor && !this->last_parsed_text.empty() &&
+         activeEditor->toPlainText() == this->last_compiled_doc;
+}
+
+/*!
+   Shows the precomputed frame for the given animation step, and keeps the
+   frames after it being precomputed. Returns false if the frame isn't ready yet.
+ */
+bool MainWindow::showAnimationFrame(int step, int numsteps)
+{
+  // Something else is evaluating on the GUI thread
+  if (GuiLocker::isLocked() && !this->animationFramesLocked) return false;
+
+  auto frame = this->animationFrames->get(AnimationFrameCache::frameTime(step, numsteps));
+
+  AnimationFrameCache::Source source;
+  source.root_file = this->root_file;
+  source.document_path = boost::filesystem::path(activeEditor->filepath.toStdString()).parent_path().string();
+  source.camera = this->qglview->cam;
+  source.normalizelimit = 2ul * Preferences::inst()->getValue("advanced/openCSGLimit").toUInt();
+  if (!this->animationFramesLocked) setCurrentOutput();
+  if (this->animationFrames->precompute(source, frame ? (step + 1) % numsteps : step, numsteps) &&
+      !this->animationFramesLocked) {
+    GuiLocker::lock();
+    this->animationFramesLocked = true;
+  }
+  if (!frame) return false;
+
+  if (!frame->renderers_created) {
+    frame->renderers_created = true;
+#ifdef ENABLE_OPENCSG
+    if (!frame->root_products ||
+        frame->root_products->size() <= Preferences::inst()->getValue("advanced/openCSGLimit").toUInt()) {
+      frame->opencsgRenderer = std::make_shared<OpenCSGRenderer>(frame->root_products,
+                                                                 frame->highlights_products,
+                                                                 frame->background_products);
+    }
+#endif
+    frame->thrownTogetherRenderer = std::make_shared<ThrownTogetherRenderer>(frame->root_products,
+                                                                             frame->highlights_products,
+                                                                             frame->background_products);
+  }
+
+  this->qglview->setRenderer(nullptr);
+  this->picker.reset();
+  this->absolute_root_node = frame->absolute_root_node;
+  this->root_node = frame->root_node;
+  this->tree.setRoot(this->root_node);
+  this->csgRoot = frame->csgRoot;
+  this->normalizedRoot = frame->normalizedRoot;
+  this->root_products = frame->root_products;
+  this->highlights_products = frame->highlights_products;
+  this->background_products = frame->background_products;
+#ifdef ENABLE_OPENCSG
+  this->opencsgRenderer = frame->opencsgRenderer;
+#endif
+  this->thrownTogetherRenderer = frame->thrownTogetherRenderer;
+
+  if (frame->script_camera) {
+    const auto pixel_width = this->qglview->cam.pixel_width;
+    const auto pixel_height = this->qglview->cam.pixel_height;
+    this->qglview->cam = frame->camera;
+    this->qglview->cam.pixel_width = pixel_width;
+    this->qglview->cam.pixel_height = pixel_height;
+    viewportControlWidget->cameraChanged();
+  }
+
+  if (viewActionThrownTogether->isChecked()) {
+    viewModeThrownTogether();
+  } else {
+#ifdef ENABLE_OPENCSG
+    viewModePreview();
+#else
+    viewModeThrownTogether();
+#endif
+  }
+  return true;
+}
+
+/*!
+   Stops precomputing animation frames, so the GUI thread can evaluate again.
+ */
+void MainWindow::stopAnimationFrames()
+{
+  this->animationFrames->stop();
+  animationFramesFinished();
+}
+
+void MainWindow::animationFramesFinished()
+{
+  if (this->animationFrames->isRunning() || !this->animationFramesLocked) return;
+  this->animationFramesLocked = false;
+  clearCurrentOutput();
+  GuiLocker::unlock();
+}
+
 void MainWindow::prepareCompile(const char *afterCompileSlot, bool procevents, bool preview)
 {
   autoReloadTimer->stop();
@@ -2022,6 +2197,7 @@ void MainWindow::actionRenderPreview()
   static bool preview_requested;
 
   preview_requested = true;
+  stopAnimationFrames();
   if (GuiLocker::isLocked()) return;
   GuiLocker::lock();
   preview_requested = false;
@@ -2064,6 +2240,7 @@ void MainWindow::csgRender()
 void MainWindow::action3DPrint()
 {
 #ifdef ENABLE_3D_PRINTING
+  stopAnimationFrames();
   if (GuiLocker::isLocked()) return;
   GuiLocker lock;
 
@@ -2248,6 +2425,7 @@ void MainWindow::sendToPrintService()
 
 void MainWindow::actionRender()
 {
+  stopAnimationFrames();
   if (GuiLocker::isLocked()) return;
   GuiLocker::lock();
 
@@ -2268,6 +2446,7 @@ void MainWindow::cgalRender()
   this->root_geom.reset();
 
   LOG("Rendering Polygon Mesh using %1$s...",
+      Feature::ExperimentalAutoCsg.is_enabled() ? "automatically chosen kernels" :
       Feature::ExperimentalManifold.is_enabled() ? "Manifold" : "CGAL");
 
   this->progresswidget = new ProgressWidget(this);
@@ -2321,7 +2500,7 @@ void MainWindow::actionRenderDone(const shared_ptr<const Geometry>& root_geom)
 #endif /* ENABLE_CGAL */
 
 /**
- * Call the mouseselection to determine the id of the clicked-on object.
+ * Cast a ray through the clicked pixel to determine the id of the clicked-on object.
  * Use the generated ID and try to find it within the list of products
  * And finally move the cursor to the beginning of the selected object in the editor
  */
@@ -2332,23 +2511,23 @@ void MainWindow::selectObject(QPoint mouse)
     return;
   }
 
-  // selecting without select object?!
-  if (!this->selector) {
-    return;
-  }
-
   // Nothing to select
   if (!this->root_products) {
     return;
   }
 
-  this->qglview->renderer->prepare(true, false, &this->selector->shaderinfo);
-
-  // Update the selector with the right image size
-  this->selector->reset(this->qglview);
+  if (!this->picker) {
+    this->picker = std::make_unique<CSGPicker>();
+    this->picker->import(this->root_products);
+    this->picker->import(this->highlights_products);
+    this->picker->import(this->background_products);
+  }
 
   // Select the object at mouse coordinates
-  int index = this->selector->select(this->qglview->renderer, mouse.x(), mouse.y());
+  Vector3d origin, direction;
+  this->qglview->cam.pixelRay(mouse.x() + 0.5, mouse.y() + 0.5, origin, direction);
+  const auto hit = this->picker->pick(origin, direction);
+  int index = hit ? hit->index : -1;
   std::deque<std::shared_ptr<const AbstractNode>> path;
   std::shared_ptr<const AbstractNode> result = this->root_node->getNodeByID(index, path);
 
@@ -2541,6 +2720,7 @@ void MainWindow::actionDisplayCSGProducts()
 
 void MainWindow::actionCheckValidity()
 {
+  stopAnimationFrames();
   if (GuiLocker::isLocked()) return;
   GuiLocker lock;
 #ifdef ENABLE_CGAL
@@ -2637,6 +2817,7 @@ void MainWindow::actionExport(FileFormat, QString, QString, unsigned int, QStrin
 #endif
 {
   //Setting filename skips the file selection dialog and uses the path provided instead.
+  stopAnimationFrames();
   if (GuiLocker::isLocked()) return;
   GuiLocker lock;
 #ifdef ENABLE_CGAL
@@ -2827,6 +3008,8 @@ void MainWindow::actionCopyViewport()
 
 void MainWindow::actionFlushCaches()
 {
+  // The caches are shared with the animation frame worker
+  stopAnimationFrames();
   GeometryCache::instance()->clear();
 #ifdef ENABLE_CGAL
   CGALCache::instance()->clear();
@@ -2860,7 +3043,7 @@ void MainWindow::viewModePreview()
   if (this->qglview->hasOpenCSGSupport()) {
     viewModeActionsUncheck();
     viewActionPreview->setChecked(true);
-    this->qglview->setRenderer(this->opencsgRenderer ? (Renderer *)this->opencsgRenderer : (Renderer *)this->thrownTogetherRenderer);
+    this->qglview->setRenderer(this->opencsgRenderer ? (Renderer *)this->opencsgRenderer.get() : (Renderer *)this->thrownTogetherRenderer.get());
     this->qglview->updateColorScheme();
     this->qglview->update();
   } else {
@@ -2898,7 +3081,7 @@ void MainWindow::viewModeThrownTogether()
 {
   viewModeActionsUncheck();
   viewActionThrownTogether->setChecked(true);
-  this->qglview->setRenderer(this->thrownTogetherRenderer);
+  this->qglview->setRenderer(this->thrownTogetherRenderer.get());
   this->qglview->updateColorScheme();
   this->qglview->update();
 }
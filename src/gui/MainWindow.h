@@ -27,10 +27,13 @@
 Q_IMPORT_PLUGIN(QSvgPlugin)
 #endif
 
+class AnimationFrameCache;
 class BuiltinContext;
+class Camera;
 class CGALWorker;
 class CSGNode;
 class CSGProducts;
+class FileWatcher;
 class FontListDialog;
 class LibraryInfoDialog;
 class Preferences;
@@ -71,10 +74,11 @@ public:
   class CGALRenderer *cgalRenderer;
 #endif
 #ifdef ENABLE_OPENCSG
-  class OpenCSGRenderer *opencsgRenderer;
-  std::unique_ptr<class MouseSelector> selector;
+  shared_ptr<class OpenCSGRenderer> opencsgRenderer;
 #endif
-  ThrownTogetherRenderer *thrownTogetherRenderer;
+  shared_ptr<ThrownTogetherRenderer> thrownTogetherRenderer;
+  // Built from the CSG products on the first selection after a preview
+  std::unique_ptr<class CSGPicker> picker;
 
   QString last_compiled_doc;
 
@@ -121,13 +125,17 @@ public:
   static void noOutputErrorLog(const Message&, void *) {} // /dev/null
 
   bool fileChangedOnDisk();
-  void parseTopLevelDocument();
+  void parseTopLevelDocument(bool reuseParsedFile = false);
   void exceptionCleanup();
   void setLastFocus(QWidget *widget);
   void UnknownExceptionCleanup(std::string msg = "");
 
   bool isLightTheme();
 
+  static void setRenderVariables(ContextHandle<BuiltinContext>& context, bool preview, double t, const Camera& cam);
+  bool canPrecomputeAnimation();
+  bool showAnimationFrame(int step, int numsteps);
+
 private:
   void initActionIcon(QAction *action, const char *darkResource, const char *lightResource);
   void setRenderVariables(ContextHandle<BuiltinContext>& context);
@@ -234,9 +242,11 @@ protected:
 
 public slots:
   void actionRenderPreview();
+  void stopAnimationFrames();
 private slots:
   void csgRender();
   void csgReloadRender();
+  void animationFramesFinished();
   void action3DPrint();
   void sendToOctoPrint();
   void sendToPrintService();
@@ -351,8 +361,10 @@ public slots:
   void checkAutoReload();
   void waitAfterReload();
   void autoReloadSet(bool);
+  void watchedFileChanged(const QString& path);
 
 private:
+  void updateFileWatcher();
   bool network_progress_func(const double permille);
   static void report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int mark);
   static bool undockMode;
@@ -372,9 +384,15 @@ private:
   QTemporaryFile *tempFile{nullptr};
   ProgressWidget *progresswidget{nullptr};
   CGALWorker *cgalworker;
+  std::unique_ptr<AnimationFrameCache> animationFrames;
+  bool animationFramesLocked{false}; // GuiLocker is held while frames are precomputed
   QMutex consolemutex;
   EditorInterface *renderedEditor; // stores pointer to editor which has been most recently rendered
+  FileWatcher *fileWatcher;
+  EditorInterface *watchedEditor{nullptr}; // editor whose dependencies fileWatcher watches
   time_t includes_mtime{0}; // latest include mod time
+  std::string last_parsed_text; // full text (incl. commandline commands) of root_file, empty if not reusable
+  EditorInterface *last_parsed_editor{nullptr}; // editor root_file was parsed from
   time_t deps_mtime{0}; // latest dependency mod time
   std::unordered_map<std::string, QString> export_paths; // for each file type, where it was exported to last
   QString exportPath(const char *suffix); // look up the last export path and generate one if not found
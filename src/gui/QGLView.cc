@@ -29,6 +29,7 @@
 #include "Preferences.h"
 #include "Renderer.h"
 #include "degree_trig.h"
+#include "fbo.h"
 #if defined(USE_GLEW) || defined(OPENCSG_GLEW)
 #include "glew-utils.h"
 #endif
@@ -41,6 +42,7 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QErrorMessage>
@@ -49,6 +51,8 @@
 #endif
 #include "OpenCSGWarningDialog.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <sstream>
 
@@ -58,11 +62,28 @@
 
 #include "qt-obsolete.h"
 
+// Frame time to aim for while the camera is being dragged
+static const double INTERACTION_FRAME_TIME = 1.0 / 30;
+static const double MIN_INTERACTION_SCALE = 0.25;
+// Timing a frame waits for the GPU to finish, so only every n-th frame is timed
+static const int FRAME_TIME_SAMPLE_INTERVAL = 8;
+// Time without camera movement after which a full resolution frame is rendered
+static const int SETTLE_TIME_MS = 150;
+
 QGLView::QGLView(QWidget *parent) : QOpenGLWidget(parent)
 {
   init();
 }
 
+QGLView::~QGLView()
+{
+  if (this->interaction_fbo) {
+    makeCurrent();
+    fbo_delete(this->interaction_fbo);
+    doneCurrent();
+  }
+}
+
 void QGLView::init()
 {
   resetView();
@@ -70,6 +91,14 @@ void QGLView::init()
   this->mouse_drag_active = false;
   this->statusLabel = nullptr;
 
+  this->settle_timer = new QTimer(this);
+  this->settle_timer->setSingleShot(true);
+  connect(this->settle_timer, &QTimer::timeout, this, [this]() {
+    this->interacting = false;
+    this->interaction_frames = 0;
+    update();
+  });
+
   setMouseTracking(true);
 }
 
@@ -168,9 +197,71 @@ void QGLView::resizeGL(int w, int h)
   emit resized();
 }
 
-void QGLView::paintGL()
+/*!
+   Renders the frame at interaction_scale into an offscreen buffer and
+   upsamples it into the widget. Returns false if that's not possible.
+ */
+bool QGLView::paintReducedFrame()
 {
+  if (!hasGLExtension(ARB_framebuffer_object)) return false;
+
+  const auto dpr = devicePixelRatio();
+  const int width = std::max(1, static_cast<int>(std::lround(this->width() * dpr)));
+  const int height = std::max(1, static_cast<int>(std::lround(this->height() * dpr)));
+  const int reduced_width = std::max(1, static_cast<int>(width * this->interaction_scale));
+  const int reduced_height = std::max(1, static_cast<int>(height * this->interaction_scale));
+
+  const QSize reduced_size(reduced_width, reduced_height);
+  if (!this->interaction_fbo) {
+    this->interaction_fbo = fbo_new();
+    if (!fbo_init(this->interaction_fbo, reduced_width, reduced_height)) {
+      fbo_delete(this->interaction_fbo);
+      this->interaction_fbo = nullptr;
+      return false;
+    }
+  } else if (this->interaction_fbo_size != reduced_size &&
+             !fbo_resize(this->interaction_fbo, reduced_width, reduced_height)) {
+    return false;
+  }
+  this->interaction_fbo_size = reduced_size;
+
+  fbo_bind(this->interaction_fbo);
+  glViewport(0, 0, reduced_width, reduced_height);
   GLView::paintGL();
+  fbo_unbind(this->interaction_fbo);
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, this->interaction_fbo->fbo_id);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, defaultFramebufferObject());
+  glBlitFramebuffer(0, 0, reduced_width, reduced_height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+  glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+  glViewport(0, 0, width, height);
+  return true;
+}
+
+void QGLView::paintGL()
+{
+  if (this->interacting) {
+    const bool timed = this->interaction_frames++ % FRAME_TIME_SAMPLE_INTERVAL == 0;
+    QElapsedTimer frametimer;
+    frametimer.start();
+    const double scale = this->interaction_scale;
+    if (scale >= 1.0 || !paintReducedFrame()) {
+      this->interaction_scale = 1.0;
+      GLView::paintGL();
+    }
+
+    if (timed) {
+      glFinish();
+      // Rendering cost is dominated by fill rate, so scale the pixel count to the frame time budget
+      const double frametime = std::max(frametimer.nsecsElapsed() * 1e-9, 1e-6);
+      const double fullframetime = frametime / (scale * scale);
+      // Quantized so the offscreen buffer isn't reallocated on every frame
+      const double newscale = std::floor(std::sqrt(INTERACTION_FRAME_TIME / fullframetime) * 8) / 8;
+      this->interaction_scale = std::clamp(newscale, MIN_INTERACTION_SCALE, 1.0);
+    }
+  } else {
+    GLView::paintGL();
+  }
 
   if (statusLabel) {
     auto status = QString("%1 (%2x%3)")
@@ -290,6 +381,8 @@ void QGLView::mouseMoveEvent(QMouseEvent *event)
   double dy = (this_mouse.y() - last_mouse.y()) * 0.7;
   if (mouse_drag_active) {
     mouse_drag_moved = true;
+    this->interacting = true;
+    this->settle_timer->start(SETTLE_TIME_MS);
     auto button_compare = this->mouseSwapButtons?Qt::RightButton : Qt::LeftButton;
     if (event->buttons() & button_compare
 #ifdef Q_OS_MAC
@@ -336,6 +429,12 @@ void QGLView::mouseReleaseEvent(QMouseEvent *event)
 {
   mouse_drag_active = false;
   releaseMouse();
+  if (this->interacting) {
+    this->settle_timer->stop();
+    this->interacting = false;
+    this->interaction_frames = 0;
+    update();
+  }
 
   auto button_compare = this->mouseSwapButtons?Qt::LeftButton : Qt::RightButton;
   if (!mouse_drag_moved
@@ -21,6 +21,7 @@ class QGLView : public QOpenGLWidget, public GLView
 
 public:
   QGLView(QWidget *parent = nullptr);
+  ~QGLView() override;
 #ifdef ENABLE_OPENCSG
   bool hasOpenCSGSupport() { return this->is_opencsg_capable; }
 #endif
@@ -67,6 +68,16 @@ private:
   QPoint last_mouse;
   QImage frame; // Used by grabFrame() and save()
 
+  // While the camera is being dragged, frames too slow at full resolution
+  // are rendered at interaction_scale into interaction_fbo and upsampled.
+  bool paintReducedFrame();
+  bool interacting = false;
+  double interaction_scale = 1.0;
+  int interaction_frames = 0; // frames painted since the interaction started
+  struct fbo_t *interaction_fbo = nullptr;
+  QSize interaction_fbo_size;
+  class QTimer *settle_timer = nullptr;
+
   void wheelEvent(QWheelEvent *event) override;
   void mousePressEvent(QMouseEvent *event) override;
   void mouseMoveEvent(QMouseEvent *event) override;
@@ -5,6 +5,9 @@
 
 #include "ScadLexer.h"
 
+#include <algorithm>
+#include <QTimer>
+
 #if !ENABLE_LEXERTL
 
 ScadLexer::ScadLexer(QObject *parent) : QsciLexerCPP(parent)
@@ -104,6 +107,7 @@ void Lex::default_rules()
 {
   rules_.push_state("PATH");
   rules_.push_state("COMMENT");
+  rules_.push_state("STRING");
 
   std::string keywords("module function echo import projection render "
                        "return if else let for each assert");
@@ -112,8 +116,10 @@ void Lex::default_rules()
   //include and use have a unique syntax
   rules_.push("INITIAL", "use", ekeyword, "PATH");
   rules_.push("INITIAL", "include", ekeyword, "PATH");
+  // Line breaks are not styled as strings, see lex_results()
+  rules_.push("PATH", "[ \t\r\n]+", etext, "PATH");
+  rules_.push("PATH", "<[^>]*>", eQuotedString, "INITIAL");
   rules_.push("PATH", ".|\n", etext, "INITIAL"); //leave this state; "use" and "include" can also be used as variable names
-  rules_.push("PATH", "[ \t\r\n]*<[^>]*>", eQuotedString, "INITIAL");
 
   std::string transformations("translate rotate scale linear_extrude "
                               "rotate_extrude resize mirror multmatrix color "
@@ -137,7 +143,10 @@ void Lex::default_rules()
   std::string operators(R"(\+ - \* \/ % \^ < <= >= == != >= > && \|\| ! = #)");
   defineRules(operators, eoperator);
 
-  rules_.push(R"(["](([\\]["])|[^"])*["])", eQuotedString);
+  // Strings are a state like comments, so a range can start inside one
+  rules_.push("INITIAL", R"(["])", eQuotedString, "STRING");
+  rules_.push("STRING", R"([^"\\]+|[\\](.|\n))", eQuotedString, "STRING");
+  rules_.push("STRING", R"(["])", eQuotedString, "INITIAL");
 
   std::string values("true false undef PI");
   defineRules(values, enumber);
@@ -193,10 +202,12 @@ void Lex::lex_results(const std::string& input, int start, LexInterface *const o
   //The editor can ask to only lex from a starting point.
   //This can be faster the lexing the whole text,
   //but requires the lexer to try to restore the lexer state.
-  //We currently handle comments (COMMENT State) pretty well.
+  //Ranges start at the beginning of a line, so the line break before
+  //is only styled as a comment or string inside a block comment or string.
   //We currently do not handle include/use (PATH State).
   int isstyle = obj->getStyleAt(start - 1);
   if (isstyle == ecomment) results.state = rules_.state("COMMENT");
+  else if (isstyle == eQuotedString) results.state = rules_.state("STRING");
 
   lexertl::lookup(sm, results);
   while (results.id != eEOF) {
@@ -211,6 +222,10 @@ ScadLexer2::ScadLexer2(QObject *parent) : QsciLexerCustom(parent), LexInterface(
 {
   my_lexer = new Lex();
   my_lexer->default_rules();
+
+  this->deferredStyleTimer = new QTimer(this);
+  this->deferredStyleTimer->setSingleShot(true);
+  connect(this->deferredStyleTimer, &QTimer::timeout, this, [this]() { styleDeferred(); });
 }
 
 ScadLexer2::~ScadLexer2()
@@ -218,6 +233,20 @@ ScadLexer2::~ScadLexer2()
   delete my_lexer;
 }
 
+/*!
+   Styles [start, end) as requested by Scintilla, which is usually the
+   edited line up to the end of the visible area.
+
+   Ranges longer than maxSynchronousStyleLength, e.g. everything after a "/*"
+   typed near the top of a large file, are styled in line aligned chunks:
+   the first chunk right away, the rest from the event loop. Further edits
+   postpone the remaining chunks by deferredStyleDelayMS, so they don't slow
+   down typing. They also cancel the styling of text which is invalidated
+   anyway, as styling resumes from where Scintilla's styled text ends.
+   Like the ranges requested by Scintilla, chunks start at the beginning of
+   a line, where lex_results() picks up a block comment or string from the
+   style of the preceding line break.
+ */
 void ScadLexer2::styleText(int start, int end)
 {
 #if DEBUG_LEXERTL
@@ -225,6 +254,48 @@ void ScadLexer2::styleText(int start, int end)
 #endif
   if (!editor()) return;
 
+  if (end - start > maxSynchronousStyleLength) {
+    const int line = editor()->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION, start + maxSynchronousStyleLength);
+    const int chunkEnd = editor()->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE, line + 1);
+    if (chunkEnd > start && chunkEnd < end) {
+      this->deferredStyleEnd = std::max(this->deferredStyleEnd, end);
+      styleRange(start, chunkEnd);
+      this->deferredStyleTimer->start(this->stylingDeferred ? 0 : deferredStyleDelayMS);
+      return;
+    }
+  }
+  styleRange(start, end);
+  if (end >= this->deferredStyleEnd) {
+    this->deferredStyleEnd = 0;
+    this->deferredStyleTimer->stop();
+  } else if (!this->stylingDeferred) {
+    this->deferredStyleTimer->start(deferredStyleDelayMS);
+  }
+}
+
+/*!
+   Continues styling a range of which styleText() only styled the first chunk.
+ */
+void ScadLexer2::styleDeferred()
+{
+  if (!editor() || this->deferredStyleEnd == 0) return;
+
+  const int length = editor()->SendScintilla(QsciScintilla::SCI_GETLENGTH);
+  const int end = std::min(this->deferredStyleEnd, length);
+  const int styled = editor()->SendScintilla(QsciScintilla::SCI_GETENDSTYLED);
+  if (styled >= end) {
+    this->deferredStyleEnd = 0;
+    return;
+  }
+  const int line = editor()->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION, styled);
+  const int start = editor()->SendScintilla(QsciScintilla::SCI_POSITIONFROMLINE, line);
+  this->stylingDeferred = true;
+  styleText(start, end);
+  this->stylingDeferred = false;
+}
+
+void ScadLexer2::styleRange(int start, int end)
+{
   char *data = new char[end - start + 1];
   editor()->SendScintilla(QsciScintilla::SCI_GETTEXTRANGE, start, end, data);
   QString source(data);
@@ -235,13 +306,33 @@ void ScadLexer2::styleText(int start, int end)
   std::cout << "its being called" << std::endl;
 #endif
 
+  this->styledStart = start;
+  this->styledText = input;
+  this->styledStyles.assign(input.size(), -1);
+
   my_lexer->lex_results(input, start, this);
   this->fold(start, end);
 
+  this->styledText.clear();
+  this->styledStyles.clear();
+
   delete [] data;
   if (source.isEmpty()) return;
 }
 
+/*!
+   Returns the style at \a pos, using the styles recorded during the current
+   styleText() call if available.
+ */
+int ScadLexer2::styledStyleAt(int pos)
+{
+  const int idx = pos - this->styledStart;
+  if (idx >= 0 && idx < static_cast<int>(this->styledStyles.size()) && this->styledStyles[idx] >= 0) {
+    return this->styledStyles[idx];
+  }
+  return getStyleAt(pos);
+}
+
 void ScadLexer2::autoScroll(int error_pos)
 {
   editor()->SendScintilla(QsciScintilla::SCI_GOTOPOS, error_pos);
@@ -250,18 +341,25 @@ void ScadLexer2::autoScroll(int error_pos)
 
 void ScadLexer2::fold(int start, int end)
 {
-  char chNext = editor()->SendScintilla(QsciScintilla::SCI_GETCHARAT, start);
+  const auto charAt = [this](int pos) -> char {
+    const int idx = pos - this->styledStart;
+    if (idx >= 0 && idx < static_cast<int>(this->styledText.size())) return this->styledText[idx];
+    return editor()->SendScintilla(QsciScintilla::SCI_GETCHARAT, pos);
+  };
+
+  char chNext = charAt(start);
   int lineCurrent = editor()->SendScintilla(QsciScintilla::SCI_LINEFROMPOSITION, start);
   int levelPrev = editor()->SendScintilla(QsciScintilla::SCI_GETFOLDLEVEL, lineCurrent) & QsciScintilla::SC_FOLDLEVELNUMBERMASK;
   int levelCurrent = levelPrev;
+  int currStyle = styledStyleAt(start - 1);
   for (int i = start; i < end; i++) {
     char ch = chNext;
-    chNext = editor()->SendScintilla(QsciScintilla::SCI_GETCHARAT, i + 1);
+    chNext = charAt(i + 1);
 
     bool atEOL = ((ch == '\r' && chNext != '\n') || (ch == '\n'));
 
-    int prevStyle = editor()->SendScintilla(QsciScintilla::SCI_GETSTYLEAT, i - 1);
-    int currStyle = editor()->SendScintilla(QsciScintilla::SCI_GETSTYLEAT, i);
+    int prevStyle = currStyle;
+    currStyle = styledStyleAt(i);
 
     bool currStyleIsOtherText = (currStyle == OtherText);
     if (currStyleIsOtherText) {
@@ -322,8 +420,14 @@ void ScadLexer2::highlighting(int start, const std::string& input, lexertl::smat
   std::cout << "highlighting ( " << style << " ):" << token << " [ " << token.length() << " bytes, " << glyphs.length() << " glyphs ]" << std::endl;
 #endif
 
-  startStyling(start + std::distance(input.begin(), results.first));
+  const int pos = start + std::distance(input.begin(), results.first);
+  startStyling(pos);
   setStyling(token.length(), style);
+
+  const int idx = pos - this->styledStart;
+  for (size_t i = 0; i < token.length(); ++i) {
+    if (idx + i < this->styledStyles.size()) this->styledStyles[idx + i] = style;
+  }
 }
 
 QColor ScadLexer2::defaultColor(int style) const
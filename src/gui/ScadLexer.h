@@ -3,6 +3,7 @@
 #include <QObject>
 #include <Qsci/qsciglobal.h>
 #include <string>
+#include <vector>
 
 #define ENABLE_LEXERTL  1
 
@@ -46,6 +47,8 @@ private:
 #include <Qsci/qscilexercustom.h>
 #include <Qsci/qsciscintilla.h>
 
+class QTimer;
+
 class LexInterface
 {
 public:
@@ -128,6 +131,24 @@ public:
     my_lexer->finalize_rules();
   }
 
+private:
+  void styleRange(int start, int end);
+  void styleDeferred();
+  int styledStyleAt(int pos);
+
+  // Longest range styled at once, in bytes
+  static constexpr int maxSynchronousStyleLength = 32 * 1024;
+  // Pause after the last edit before styling the rest of a long range
+  static constexpr int deferredStyleDelayMS = 200;
+  QTimer *deferredStyleTimer;
+  int deferredStyleEnd{0}; // end of the range still to be styled, 0 if none
+  bool stylingDeferred{false};
+
+  // Text and styles of the range currently being styled by styleText(),
+  // so fold() doesn't need to query Scintilla for every character.
+  int styledStart{0};
+  std::string styledText;
+  std::vector<int> styledStyles;
 };
 
 #endif // if ENABLE_LEXERTL
@@ -0,0 +1,502 @@
+#include "compression.h"
+#include "printutils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <boost/algorithm/string/predicate.hpp>
+
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+const std::size_t CHUNK_SIZE = 1 << 20;
+// Chunks waiting for the compressing thread, which bounds the memory used if it falls behind
+const std::size_t MAX_QUEUED_CHUNKS = 4;
+// Limit of files decompressed into memory, which may be far larger than the compressed file
+const std::size_t MAX_DECOMPRESSED_SIZE = std::size_t(1) << 31;
+
+const unsigned char gzipMagic[] = {0x1f, 0x8b};
+const unsigned char zstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+class Compressor
+{
+public:
+  virtual ~Compressor() = default;
+  // Compresses size bytes of data to the output, completing the compressed data if finish is set
+  virtual void write(const char *data, std::size_t size, bool finish) = 0;
+};
+
+#ifdef ENABLE_ZLIB
+class GzipCompressor : public Compressor
+{
+public:
+  GzipCompressor(std::ostream& output) : output(output), out(CHUNK_SIZE) {
+    // Adding 16 to the window bits writes a gzip rather than a zlib header
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      throw std::ios::failure("gzip compression failed to start");
+    }
+  }
+  ~GzipCompressor() override { deflateEnd(&stream); }
+
+  void write(const char *data, std::size_t size, bool finish) override {
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(size);
+    do {
+      stream.next_out = reinterpret_cast<Bytef *>(out.data());
+      stream.avail_out = static_cast<uInt>(out.size());
+      if (deflate(&stream, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) {
+        throw std::ios::failure("gzip compression failed");
+      }
+      output.write(out.data(), out.size() - stream.avail_out);
+    } while (stream.avail_out == 0);
+  }
+
+private:
+  std::ostream& output;
+  std::vector<char> out;
+  z_stream stream{};
+};
+#endif // ENABLE_ZLIB
+
+#ifdef ENABLE_ZSTD
+class ZstdCompressor : public Compressor
+{
+public:
+  ZstdCompressor(std::ostream& output) : output(output), out(ZSTD_CStreamOutSize()), context(ZSTD_createCCtx()) {
+    if (!context) throw std::ios::failure("zstd compression failed to start");
+  }
+  ~ZstdCompressor() override { ZSTD_freeCCtx(context); }
+
+  void write(const char *data, std::size_t size, bool finish) override {
+    ZSTD_inBuffer in{data, size, 0};
+    bool done;
+    do {
+      ZSTD_outBuffer buffer{out.data(), out.size(), 0};
+      const std::size_t remaining = ZSTD_compressStream2(context, &buffer, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+      if (ZSTD_isError(remaining)) throw std::ios::failure(ZSTD_getErrorName(remaining));
+      output.write(out.data(), buffer.pos);
+      done = finish ? remaining == 0 : in.pos == in.size;
+    } while (!done);
+  }
+
+private:
+  std::ostream& output;
+  std::vector<char> out;
+  ZSTD_CCtx *context;
+};
+#endif // ENABLE_ZSTD
+
+std::unique_ptr<Compressor> createCompressor([[maybe_unused]] std::ostream& output, Compression compression)
+{
+  switch (compression) {
+#ifdef ENABLE_ZLIB
+  case Compression::GZIP: return std::make_unique<GzipCompressor>(output);
+#endif
+#ifdef ENABLE_ZSTD
+  case Compression::ZSTD: return std::make_unique<ZstdCompressor>(output);
+#endif
+  default:
+    throw std::ios::failure(std::string(compressionName(compression)) + " compression isn't available");
+  }
+}
+
+Compression detectCompression(std::istream& input)
+{
+  unsigned char magic[4] = {};
+  input.read(reinterpret_cast<char *>(magic), sizeof(magic));
+  const auto size = input.gcount();
+  if (size >= 2 && std::equal(std::begin(gzipMagic), std::end(gzipMagic), magic)) return Compression::GZIP;
+  if (size >= 4 && std::equal(std::begin(zstdMagic), std::end(zstdMagic), magic)) return Compression::ZSTD;
+  return Compression::NONE;
+}
+
+class Decompressor
+{
+public:
+  virtual ~Decompressor() = default;
+  // Decompresses up to size bytes to data, returning how many; 0 at the end of the data
+  virtual std::size_t read(char *data, std::size_t size) = 0;
+};
+
+#ifdef ENABLE_ZLIB
+class GzipDecompressor : public Decompressor
+{
+public:
+  GzipDecompressor(std::istream& input) : input(input), in(CHUNK_SIZE) {
+    // Adding 32 to the window bits accepts the gzip header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) throw std::runtime_error("gzip decompression failed to start");
+  }
+  ~GzipDecompressor() override { inflateEnd(&stream); }
+
+  std::size_t read(char *data, std::size_t size) override {
+    stream.next_out = reinterpret_cast<Bytef *>(data);
+    stream.avail_out = static_cast<uInt>(size);
+    while (stream.avail_out > 0) {
+      if (stream.avail_in == 0 && !inputEnded) {
+        input.read(in.data(), in.size());
+        stream.next_in = reinterpret_cast<Bytef *>(in.data());
+        stream.avail_in = static_cast<uInt>(input.gcount());
+        inputEnded = stream.avail_in == 0;
+      }
+      const auto before = stream.avail_out;
+      const int result = inflate(&stream, Z_NO_FLUSH);
+      if (result == Z_STREAM_END) {
+        // Concatenated gzip members decompress to the concatenation of their contents
+        ended = true;
+        inflateReset(&stream);
+      } else if (result == Z_OK) {
+        ended = false;
+      } else if (result != Z_BUF_ERROR) { // Z_BUF_ERROR: nothing more without more input
+        throw std::runtime_error(stream.msg ? stream.msg : "invalid gzip data");
+      }
+      if (inputEnded && stream.avail_out == before) {
+        if (!ended) throw std::runtime_error("gzip data is truncated");
+        break;
+      }
+    }
+    return size - stream.avail_out;
+  }
+
+private:
+  std::istream& input;
+  std::vector<char> in;
+  z_stream stream{};
+  bool inputEnded{false};
+  bool ended{false}; // the last gzip member is complete
+};
+#endif // ENABLE_ZLIB
+
+#ifdef ENABLE_ZSTD
+class ZstdDecompressor : public Decompressor
+{
+public:
+  ZstdDecompressor(std::istream& input) : input(input), in(ZSTD_DStreamInSize()), context(ZSTD_createDCtx()) {
+    if (!context) throw std::runtime_error("zstd decompression failed to start");
+  }
+  ~ZstdDecompressor() override { ZSTD_freeDCtx(context); }
+
+  std::size_t read(char *data, std::size_t size) override {
+    ZSTD_outBuffer out{data, size, 0};
+    while (out.pos < out.size) {
+      if (buffer.pos == buffer.size && !inputEnded) {
+        input.read(in.data(), in.size());
+        buffer = {in.data(), static_cast<std::size_t>(input.gcount()), 0};
+        inputEnded = buffer.size == 0;
+      }
+      const auto before = out.pos;
+      // zstd keeps the last byte of a frame until all of its data is flushed
+      remaining = ZSTD_decompressStream(context, &out, &buffer);
+      if (ZSTD_isError(remaining)) throw std::runtime_error(ZSTD_getErrorName(remaining));
+      if (inputEnded && out.pos == before) {
+        if (remaining != 0) throw std::runtime_error("zstd data is truncated");
+        break;
+      }
+    }
+    return out.pos;
+  }
+
+private:
+  std::istream& input;
+  std::vector<char> in;
+  ZSTD_inBuffer buffer{nullptr, 0, 0};
+  ZSTD_DCtx *context;
+  std::size_t remaining{0};
+  bool inputEnded{false};
+};
+#endif // ENABLE_ZSTD
+
+std::unique_ptr<Decompressor> createDecompressor([[maybe_unused]] std::istream& input, Compression compression)
+{
+  switch (compression) {
+#ifdef ENABLE_ZLIB
+  case Compression::GZIP: return std::make_unique<GzipDecompressor>(input);
+#endif
+#ifdef ENABLE_ZSTD
+  case Compression::ZSTD: return std::make_unique<ZstdDecompressor>(input);
+#endif
+  default:
+    throw std::runtime_error(std::string(compressionName(compression)) + " decompression isn't available");
+  }
+}
+
+// Decompresses a file while it is read
+class DecompressingBuffer : public std::streambuf
+{
+public:
+  DecompressingBuffer(std::unique_ptr<Decompressor> decompressor, std::string filename)
+    : decompressor(std::move(decompressor)), filename(std::move(filename)), buffer(PUTBACK_SIZE + CHUNK_SIZE) {
+    setg(buffer.data(), buffer.data() + PUTBACK_SIZE, buffer.data() + PUTBACK_SIZE);
+  }
+
+protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    // Keep the end of the previous data, so it can be put back
+    const std::size_t putback = std::min<std::size_t>(gptr() - eback(), PUTBACK_SIZE);
+    std::memmove(buffer.data() + PUTBACK_SIZE - putback, gptr() - putback, putback);
+    std::size_t size;
+    try {
+      size = decompressor->read(buffer.data() + PUTBACK_SIZE, buffer.size() - PUTBACK_SIZE);
+    } catch (const std::exception& e) {
+      LOG(message_group::Warning, "Can't decompress '%1$s': %2$s", filename, e.what());
+      // Rethrown by the stream as badbit
+      throw;
+    }
+    if (size == 0) return traits_type::eof();
+    setg(buffer.data() + PUTBACK_SIZE - putback, buffer.data() + PUTBACK_SIZE, buffer.data() + PUTBACK_SIZE + size);
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  static const std::size_t PUTBACK_SIZE = 16;
+
+  std::unique_ptr<Decompressor> decompressor;
+  std::string filename;
+  std::vector<char> buffer;
+};
+
+class DecompressingStream : public std::istream
+{
+public:
+  DecompressingStream(std::unique_ptr<std::istream> file, Compression compression, const std::string& filename)
+    : std::istream(nullptr), file(std::move(file)), buffer(createDecompressor(*this->file, compression), filename) {
+    rdbuf(&buffer);
+  }
+
+private:
+  std::unique_ptr<std::istream> file;
+  DecompressingBuffer buffer;
+};
+
+// Opens filename, decompressing it while it is read if it's compressed
+std::unique_ptr<std::istream> openFile(const std::string& filename, bool& compressed)
+{
+  compressed = false;
+  auto file = std::make_unique<std::ifstream>(filename, std::ios::in | std::ios::binary);
+  if (!file->good()) return file;
+  const auto compression = detectCompression(*file);
+  file->clear();
+  file->seekg(0);
+  if (compression == Compression::NONE) return file;
+
+  compressed = true;
+  try {
+    return std::make_unique<DecompressingStream>(std::move(file), compression, filename);
+  } catch (const std::exception& e) {
+    LOG(message_group::Warning, "Can't decompress '%1$s': %2$s", filename, e.what());
+    auto failed = std::make_unique<std::istream>(nullptr);
+    failed->setstate(std::ios::failbit);
+    return failed;
+  }
+}
+
+} // namespace
+
+Compression compressionFromFileName(const std::string& filename)
+{
+  if (boost::algorithm::iends_with(filename, ".gz")) return Compression::GZIP;
+  if (boost::algorithm::iends_with(filename, ".zst")) return Compression::ZSTD;
+  return Compression::NONE;
+}
+
+std::string stripCompressionSuffix(const std::string& filename)
+{
+  switch (compressionFromFileName(filename)) {
+  case Compression::GZIP: return filename.substr(0, filename.size() - 3);
+  case Compression::ZSTD: return filename.substr(0, filename.size() - 4);
+  default: return filename;
+  }
+}
+
+const char *compressionName(Compression compression)
+{
+  switch (compression) {
+  case Compression::GZIP: return "gzip";
+  case Compression::ZSTD: return "zstd";
+  default: return "none";
+  }
+}
+
+bool compressionAvailable(Compression compression)
+{
+  switch (compression) {
+  case Compression::NONE: return true;
+#ifdef ENABLE_ZLIB
+  case Compression::GZIP: return true;
+#endif
+#ifdef ENABLE_ZSTD
+  case Compression::ZSTD: return true;
+#endif
+  default: return false;
+  }
+}
+
+class CompressedOutputStream::Buffer : public std::streambuf
+{
+public:
+  Buffer(std::unique_ptr<Compressor> compressor) : compressor(std::move(compressor)), current(CHUNK_SIZE) {
+    setp(current.data(), current.data() + current.size());
+    worker = std::thread(&Buffer::work, this);
+  }
+  ~Buffer() override {
+    try {
+      finish();
+    } catch (...) {
+    }
+  }
+
+  // Compresses what's left, rethrowing the error of the compressing thread if any
+  void finish() {
+    if (worker.joinable()) {
+      submit();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        finishing = true;
+      }
+      changed.notify_all();
+      worker.join();
+    }
+    if (error) {
+      auto e = error;
+      error = nullptr;
+      std::rethrow_exception(e);
+    }
+  }
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!submit()) return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+private:
+  // Queues what was written to the current chunk and starts a new one
+  bool submit() {
+    const std::size_t size = pptr() - pbase();
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (size > 0) {
+        changed.wait(lock, [this] { return queue.size() < MAX_QUEUED_CHUNKS || failed; });
+        if (failed) return false;
+        current.resize(size);
+        queue.push_back(std::move(current));
+        if (spare.empty()) {
+          current = std::vector<char>(CHUNK_SIZE);
+        } else {
+          current = std::move(spare.back());
+          spare.pop_back();
+          current.resize(CHUNK_SIZE);
+        }
+        setp(current.data(), current.data() + current.size());
+      }
+      if (failed) return false;
+    }
+    changed.notify_all();
+    return true;
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      changed.wait(lock, [this] { return !queue.empty() || finishing; });
+      std::vector<char> chunk;
+      if (!queue.empty()) {
+        chunk = std::move(queue.front());
+        queue.pop_front();
+      }
+      const bool last = finishing && queue.empty();
+      lock.unlock();
+      changed.notify_all();
+      try {
+        compressor->write(chunk.data(), chunk.size(), last);
+      } catch (...) {
+        lock.lock();
+        error = std::current_exception();
+        failed = true;
+        changed.notify_all();
+        return;
+      }
+      if (last) return;
+      lock.lock();
+      spare.push_back(std::move(chunk));
+    }
+  }
+
+  std::unique_ptr<Compressor> compressor;
+  std::vector<char> current;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<std::vector<char>> queue;
+  std::vector<std::vector<char>> spare; // compressed chunks, to reuse their memory
+  bool finishing{false};
+  bool failed{false};
+  std::exception_ptr error;
+  std::thread worker;
+};
+
+CompressedOutputStream::CompressedOutputStream(std::ostream& output, Compression compression)
+  : std::ostream(nullptr), buffer(std::make_unique<Buffer>(createCompressor(output, compression)))
+{
+  rdbuf(buffer.get());
+}
+
+CompressedOutputStream::~CompressedOutputStream() = default;
+
+void CompressedOutputStream::close()
+{
+  buffer->finish();
+}
+
+std::unique_ptr<std::istream> openDecompressedStream(const std::string& filename)
+{
+  bool compressed;
+  return openFile(filename, compressed);
+}
+
+std::unique_ptr<std::istream> openDecompressedFile(const std::string& filename)
+{
+  bool compressed;
+  auto stream = openFile(filename, compressed);
+  if (!compressed || !stream->good()) return stream;
+
+  auto data = std::make_unique<std::stringstream>(std::ios::in | std::ios::out | std::ios::binary);
+  std::vector<char> chunk(CHUNK_SIZE);
+  std::size_t size = 0;
+  while (stream->read(chunk.data(), chunk.size()) || stream->gcount() > 0) {
+    size += stream->gcount();
+    if (size > MAX_DECOMPRESSED_SIZE) {
+      LOG(message_group::Warning, "Can't decompress '%1$s': more than %2$d MiB of data", filename, MAX_DECOMPRESSED_SIZE >> 20);
+      data->setstate(std::ios::failbit);
+      return data;
+    }
+    data->write(chunk.data(), stream->gcount());
+  }
+  // The decompressing stream logged the reason
+  if (stream->bad()) data->setstate(std::ios::failbit);
+  return data;
+}
+
+bool isCompressedFile(const std::string& filename)
+{
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  return file.good() && detectCompression(file) != Compression::NONE;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+/*!
+   Streaming gzip and zstd compression of exported files, and the matching
+   decompression of imported ones.
+
+   Exports are compressed by the suffix of the output file name, e.g.
+   "model.stl.gz" or "model.off.zst". Imports recognize compressed files
+   by their magic bytes, whatever they are named.
+ */
+enum class Compression { NONE, GZIP, ZSTD };
+
+// Compression named by the last suffix of filename
+Compression compressionFromFileName(const std::string& filename);
+// filename without its compression suffix, e.g. to look up the file format
+std::string stripCompressionSuffix(const std::string& filename);
+const char *compressionName(Compression compression);
+// Whether the compression was enabled when building
+bool compressionAvailable(Compression compression);
+
+/*!
+   Compresses everything written to it into output.
+
+   Written data is handed over in large chunks to a thread which
+   compresses them, so the exporter keeps producing data meanwhile.
+   close() completes the compressed data; errors of the compressing thread,
+   such as write errors of output, are thrown from there.
+ */
+class CompressedOutputStream : public std::ostream
+{
+public:
+  CompressedOutputStream(std::ostream& output, Compression compression);
+  ~CompressedOutputStream() override;
+
+  void close();
+
+private:
+  class Buffer;
+  std::unique_ptr<Buffer> buffer;
+};
+
+/*!
+   Opens filename for binary reading, decompressing it while it is read if
+   it's gzip or zstd compressed. The stream can't seek in compressed files.
+   Returns a stream which isn't good() if the file can't be opened. If
+   compressed data turns out to be invalid, the reason is logged and the
+   stream goes bad().
+ */
+std::unique_ptr<std::istream> openDecompressedStream(const std::string& filename);
+
+/*!
+   Like openDecompressedStream(), but decompressed data is held in memory,
+   up to 2 GiB, so the stream is seekable like a std::ifstream. This is for
+   readers which look ahead, like the STL importer checking the file size.
+ */
+std::unique_ptr<std::istream> openDecompressedFile(const std::string& filename);
+
+// Whether filename starts like gzip or zstd compressed data
+bool isCompressedFile(const std::string& filename);
@@ -25,11 +25,17 @@
  */
 
 #include "export.h"
+#include "compression.h"
 #include "PolySet.h"
 #include "printutils.h"
 #include "Geometry.h"
+#ifdef ENABLE_MANIFOLD
+#include "ManifoldGeometry.h"
+#include "manifold.h"
+#endif
 
 #include <fstream>
+#include <numeric>
 
 #ifdef _WIN32
 #include <io.h>
@@ -103,8 +109,22 @@ bool exportFileByNameStdout(const shared_ptr<const Geometry>& root_geom, const E
 
 bool exportFileByNameStream(const shared_ptr<const Geometry>& root_geom, const ExportInfo& exportInfo)
 {
+  const auto compression = compressionFromFileName(exportInfo.name2open);
+  if (compression != Compression::NONE) {
+    if (!compressionAvailable(compression)) {
+      LOG(message_group::Error, _("%1$s compression was not enabled when building, can't export \"%2$s\""), compressionName(compression), exportInfo.name2display);
+      return false;
+    }
+    // 3MF files are zip archives already, and written by seeking
+    if (exportInfo.format == FileFormat::_3MF) {
+      LOG(message_group::Error, _("3MF files can't be compressed, can't export \"%1$s\""), exportInfo.name2display);
+      return false;
+    }
+  }
+
   std::ios::openmode mode = std::ios::out | std::ios::trunc;
-  if (exportInfo.format == FileFormat::_3MF || exportInfo.format == FileFormat::STL || exportInfo.format == FileFormat::PDF) {
+  if (exportInfo.format == FileFormat::_3MF || exportInfo.format == FileFormat::STL || exportInfo.format == FileFormat::PDF ||
+      compression != Compression::NONE) {
     mode |= std::ios::binary;
   }
   std::ofstream fstream(exportInfo.name2open, mode);
@@ -115,7 +135,14 @@ bool exportFileByNameStream(const shared_ptr<const Geometry>& root_geom, const E
     bool onerror = false;
     fstream.exceptions(std::ios::badbit | std::ios::failbit);
     try {
-      exportFile(root_geom, fstream, exportInfo);
+      if (compression == Compression::NONE) {
+        exportFile(root_geom, fstream, exportInfo);
+      } else {
+        CompressedOutputStream out(fstream, compression);
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+        exportFile(root_geom, out, exportInfo);
+        out.close();
+      }
     } catch (std::ios::failure&) {
       onerror = true;
     }
@@ -176,6 +203,47 @@ ExportMesh::ExportMesh(const PolySet& ps)
   for (const auto& i : triangleIndices) {
     triangles.emplace_back(indexTranslationMap[i[0]], indexTranslationMap[i[1]], indexTranslationMap[i[2]]);
   }
+  sortTriangles();
+}
+
+#ifdef ENABLE_MANIFOLD
+/*!
+   Takes the indexed mesh of the manifold as is, without going through a
+   PolySet. Vertices are still sorted and merged like the PolySet
+   constructor does, so both give the same output for the same mesh.
+ */
+ExportMesh::ExportMesh(const ManifoldGeometry& mani)
+{
+  const manifold::Mesh mesh = mani.getManifold().GetMesh();
+
+  std::vector<Vertex> positions;
+  positions.reserve(mesh.vertPos.size());
+  for (const auto& v : mesh.vertPos) {
+    positions.push_back(vectorToVertex(Vector3d(v.x, v.y, v.z)));
+  }
+  std::vector<int> order(positions.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&positions](int i1, int i2) {
+      return positions[i1] < positions[i2];
+    });
+
+  std::vector<int> indexTranslationMap(positions.size());
+  vertices.reserve(positions.size());
+  for (const auto i : order) {
+    if (vertices.empty() || vertices.back() != positions[i]) vertices.push_back(positions[i]);
+    indexTranslationMap[i] = vertices.size() - 1;
+  }
+
+  triangles.reserve(mesh.triVerts.size());
+  for (const auto& tv : mesh.triVerts) {
+    triangles.emplace_back(indexTranslationMap[tv[0]], indexTranslationMap[tv[1]], indexTranslationMap[tv[2]]);
+  }
+  sortTriangles();
+}
+#endif
+
+void ExportMesh::sortTriangles()
+{
   std::sort(triangles.begin(), triangles.end(), [](const Triangle& t1, const Triangle& t2) -> bool {
       return t1.key < t2.key;
     });
@@ -12,6 +12,7 @@
 #include "memory.h"
 
 class PolySet;
+class ManifoldGeometry;
 
 enum class FileFormat {
   ASCIISTL,
@@ -26,6 +27,7 @@ enum class FileFormat {
   NEFDBG,
   NEF3,
   CSG,
+  CSGB,
   AST,
   TERM,
   ECHO,
@@ -129,6 +131,7 @@ struct ExportFileFormatOptions {
     {"nefdbg", FileFormat::NEFDBG},
     {"nef3", FileFormat::NEF3},
     {"csg", FileFormat::CSG},
+    {"csgb", FileFormat::CSGB},
     {"param", FileFormat::PARAM},
     {"ast", FileFormat::AST},
     {"term", FileFormat::TERM},
@@ -155,7 +158,7 @@ struct ViewOptions {
     {"crosshairs", false},
   };
 
-  const std::vector<std::string> names() {
+  std::vector<std::string> names() const {
     std::vector<std::string> names;
     boost::copy(flags | boost::adaptors::map_keys, std::back_inserter(names));
     return names;
@@ -210,12 +213,17 @@ public:
   using Vertex = std::array<double, 3>;
 
   ExportMesh(const PolySet& ps);
+#ifdef ENABLE_MANIFOLD
+  ExportMesh(const ManifoldGeometry& mani);
+#endif
 
   bool foreach_vertex(const std::function<bool(const Vertex&)>& callback) const;
   bool foreach_indexed_triangle(const std::function<bool(const std::array<int, 3>&)>& callback) const;
   bool foreach_triangle(const std::function<bool(const std::array<Vertex, 3>&)>& callback) const;
 
 private:
+  void sortTriangles();
+
   std::vector<Vertex> vertices;
   std::vector<Triangle> triangles;
 };
@@ -29,6 +29,8 @@
 #include "PolySetUtils.h"
 #include "printutils.h"
 #include "CGALHybridPolyhedron.h"
+#include <unordered_map>
+#include <vector>
 #ifdef ENABLE_MANIFOLD
 #include "ManifoldGeometry.h"
 #endif
@@ -47,6 +49,42 @@ static uint32_t lib3mf_seek_callback(uint64_t pos, std::ostream *stream)
   return !(*stream);
 }
 
+#ifdef ENABLE_CGAL
+
+/*
+ * Children of a GeometryList, with the placements of their geometry.
+ * Geometry placed more than once is listed once, with all its placements.
+ * An empty list of placements means the child geometry is used as is.
+ */
+using InstanceGroups = std::vector<std::pair<shared_ptr<const Geometry>, std::vector<const Transform3d *>>>;
+
+static InstanceGroups group_instances(const GeometryList& geomlist)
+{
+  InstanceGroups groups;
+  if (geomlist.instances.size() != geomlist.size()) {
+    for (const auto& item : geomlist.getChildren()) groups.emplace_back(item.second, InstanceGroups::value_type::second_type{});
+    return groups;
+  }
+
+  std::unordered_map<const Geometry *, size_t> count;
+  for (const auto& instance : geomlist.instances) count[instance.geom.get()]++;
+
+  // The children are never transformed, every placement is written as a transform
+  std::unordered_map<const Geometry *, size_t> groupindex;
+  for (const auto& instance : geomlist.instances) {
+    if (count[instance.geom.get()] == 1 && instance.matrix.matrix().isIdentity()) {
+      groups.emplace_back(instance.geom, InstanceGroups::value_type::second_type{});
+      continue;
+    }
+    auto [it, inserted] = groupindex.emplace(instance.geom.get(), groups.size());
+    if (inserted) groups.emplace_back(instance.geom, InstanceGroups::value_type::second_type{});
+    groups[it->second].second.push_back(&instance.matrix);
+  }
+  return groups;
+}
+
+#endif // ENABLE_CGAL
+
 #ifndef LIB3MF_API_2
 #include <Model/COM/NMR_DLLInterfaces.h>
 #undef BOOL
@@ -69,10 +107,21 @@ static void export_3mf_error(std::string msg, PLib3MFModel *& model)
   }
 }
 
+using Transforms = std::vector<MODELTRANSFORM>;
+
+static MODELTRANSFORM to_3mf_transform(const Transform3d& matrix)
+{
+  MODELTRANSFORM t;
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 4; ++col) t.m_fFields[row][col] = (FLOAT)matrix(row, col);
+  }
+  return t;
+}
+
 /*
- * PolySet must be triangulated.
+ * Adds a build item per transform, or a single untransformed one if there are none.
  */
-static bool append_polyset(const PolySet& ps, PLib3MFModelMeshObject *& model)
+static bool append_mesh(const Export::ExportMesh& exportMesh, PLib3MFModelMeshObject *& model, const Transforms& transforms)
 {
   PLib3MFModelMeshObject *mesh;
   if (lib3mf_model_addmeshobject(model, &mesh) != LIB3MF_OK) {
@@ -94,8 +143,6 @@ static bool append_polyset(const PolySet& ps, PLib3MFModelMeshObject *& model)
       return lib3mf_meshobject_addtriangle(mesh, &t, nullptr) == LIB3MF_OK;
     };
 
-  Export::ExportMesh exportMesh{ps};
-
   if (!exportMesh.foreach_vertex(vertexFunc)) {
     export_3mf_error("Can't add vertex to 3MF model.", model);
     return false;
@@ -107,15 +154,31 @@ static bool append_polyset(const PolySet& ps, PLib3MFModelMeshObject *& model)
   }
 
   PLib3MFModelBuildItem *builditem;
-  if (lib3mf_model_addbuilditem(model, mesh, nullptr, &builditem) != LIB3MF_OK) {
-    export_3mf_error("Can't add build item to 3MF model.", model);
-    return false;
+  if (transforms.empty()) {
+    if (lib3mf_model_addbuilditem(model, mesh, nullptr, &builditem) != LIB3MF_OK) {
+      export_3mf_error("Can't add build item to 3MF model.", model);
+      return false;
+    }
+  }
+  for (const auto& transform : transforms) {
+    if (lib3mf_model_addbuilditem(model, mesh, &transform, &builditem) != LIB3MF_OK) {
+      export_3mf_error("Can't add build item to 3MF model.", model);
+      return false;
+    }
   }
 
   return true;
 }
 
-static bool append_nef(const CGAL_Nef_polyhedron& root_N, PLib3MFModelMeshObject *& model)
+/*
+ * PolySet must be triangulated.
+ */
+static bool append_polyset(const PolySet& ps, PLib3MFModelMeshObject *& model, const Transforms& transforms)
+{
+  return append_mesh(Export::ExportMesh{ps}, model, transforms);
+}
+
+static bool append_nef(const CGAL_Nef_polyhedron& root_N, PLib3MFModelMeshObject *& model, const Transforms& transforms)
 {
   if (!root_N.p3) {
     LOG(message_group::Export_Error, "Export failed, empty geometry.");
@@ -133,27 +196,36 @@ static bool append_nef(const CGAL_Nef_polyhedron& root_N, PLib3MFModelMeshObject
     return false;
   }
 
-  return append_polyset(ps, model);
+  return append_polyset(ps, model, transforms);
 }
 
-static bool append_3mf(const shared_ptr<const Geometry>& geom, PLib3MFModelMeshObject *& model)
+static bool append_3mf(const shared_ptr<const Geometry>& geom, PLib3MFModelMeshObject *& model, const Transforms& transforms = {})
 {
   if (const auto geomlist = dynamic_pointer_cast<const GeometryList>(geom)) {
-    for (const auto& item : geomlist->getChildren()) {
-      if (!append_3mf(item.second, model)) return false;
+    if (!transforms.empty()) {
+      for (const auto& item : geomlist->getChildren()) {
+        if (!append_3mf(item.second, model, transforms)) return false;
+      }
+      return true;
+    }
+    // Geometry placed repeatedly is written as one mesh with a build item per placement
+    for (const auto& [instance, matrices] : group_instances(*geomlist)) {
+      Transforms instancetransforms;
+      for (const auto *matrix : matrices) instancetransforms.push_back(to_3mf_transform(*matrix));
+      if (!append_3mf(instance, model, instancetransforms)) return false;
     }
   } else if (const auto N = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
-    return append_nef(*N, model);
+    return append_nef(*N, model, transforms);
   } else if (const auto hybrid = dynamic_pointer_cast<const CGALHybridPolyhedron>(geom)) {
-    return append_polyset(*hybrid->toPolySet(), model);
+    return append_polyset(*hybrid->toPolySet(), model, transforms);
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani = dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    return append_polyset(*mani->toPolySet(), model);
+    return append_mesh(Export::ExportMesh{*mani}, model, transforms);
 #endif
   } else if (const auto ps = dynamic_pointer_cast<const PolySet>(geom)) {
     PolySet triangulated(3);
     PolySetUtils::tessellate_faces(*ps, triangulated);
-    return append_polyset(triangulated, model);
+    return append_polyset(triangulated, model, transforms);
   } else if (dynamic_pointer_cast<const Polygon2d>(geom)) { // NOLINT(bugprone-branch-clone)
     assert(false && "Unsupported file format");
   } else { // NOLINT(bugprone-branch-clone)
@@ -229,10 +301,21 @@ static void export_3mf_error(std::string msg)
   LOG(message_group::Export_Error, std::move(msg));
 }
 
+using Transforms = std::vector<Lib3MF::sTransform>;
+
+static Lib3MF::sTransform to_3mf_transform(const Transform3d& matrix)
+{
+  Lib3MF::sTransform t;
+  for (int col = 0; col < 4; ++col) {
+    for (int row = 0; row < 3; ++row) t.m_Fields[col][row] = (Lib3MF_single)matrix(row, col);
+  }
+  return t;
+}
+
 /*
- * PolySet must be triangulated.
+ * Adds a build item per transform, or a single untransformed one if there are none.
  */
-static bool append_polyset(const PolySet& ps, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model)
+static bool append_mesh(const Export::ExportMesh& exportMesh, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model, const Transforms& transforms)
 {
   try {
     auto mesh = model->AddMeshObject();
@@ -261,8 +344,6 @@ static bool append_polyset(const PolySet& ps, Lib3MF::PWrapper& wrapper, Lib3MF:
         return true;
       };
 
-    Export::ExportMesh exportMesh{ps};
-
     if (!exportMesh.foreach_vertex(vertexFunc)) {
       export_3mf_error("Can't add vertex to 3MF model.");
       return false;
@@ -275,7 +356,8 @@ static bool append_polyset(const PolySet& ps, Lib3MF::PWrapper& wrapper, Lib3MF:
 
     Lib3MF::PBuildItem builditem;
     try {
-      model->AddBuildItem(mesh.get(), wrapper->GetIdentityTransform());
+      if (transforms.empty()) model->AddBuildItem(mesh.get(), wrapper->GetIdentityTransform());
+      for (const auto& transform : transforms) model->AddBuildItem(mesh.get(), transform);
     } catch (Lib3MF::ELib3MFException& e) {
       export_3mf_error(e.what());
     }
@@ -286,7 +368,15 @@ static bool append_polyset(const PolySet& ps, Lib3MF::PWrapper& wrapper, Lib3MF:
   return true;
 }
 
-static bool append_nef(const CGAL_Nef_polyhedron& root_N, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model)
+/*
+ * PolySet must be triangulated.
+ */
+static bool append_polyset(const PolySet& ps, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model, const Transforms& transforms)
+{
+  return append_mesh(Export::ExportMesh{ps}, wrapper, model, transforms);
+}
+
+static bool append_nef(const CGAL_Nef_polyhedron& root_N, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model, const Transforms& transforms)
 {
   if (!root_N.p3) {
     LOG(message_group::Export_Error, "Export failed, empty geometry.");
@@ -304,27 +394,36 @@ static bool append_nef(const CGAL_Nef_polyhedron& root_N, Lib3MF::PWrapper& wrap
     return false;
   }
 
-  return append_polyset(ps, wrapper, model);
+  return append_polyset(ps, wrapper, model, transforms);
 }
 
-static bool append_3mf(const shared_ptr<const Geometry>& geom, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model)
+static bool append_3mf(const shared_ptr<const Geometry>& geom, Lib3MF::PWrapper& wrapper, Lib3MF::PModel& model, const Transforms& transforms = {})
 {
   if (const auto geomlist = dynamic_pointer_cast<const GeometryList>(geom)) {
-    for (const auto& item : geomlist->getChildren()) {
-      if (!append_3mf(item.second, wrapper, model)) return false;
+    if (!transforms.empty()) {
+      for (const auto& item : geomlist->getChildren()) {
+        if (!append_3mf(item.second, wrapper, model, transforms)) return false;
+      }
+      return true;
+    }
+    // Geometry placed repeatedly is written as one mesh with a build item per placement
+    for (const auto& [instance, matrices] : group_instances(*geomlist)) {
+      Transforms instancetransforms;
+      for (const auto *matrix : matrices) instancetransforms.push_back(to_3mf_transform(*matrix));
+      if (!append_3mf(instance, wrapper, model, instancetransforms)) return false;
     }
   } else if (const auto N = dynamic_pointer_cast<const CGAL_Nef_polyhedron>(geom)) {
-    return append_nef(*N, wrapper, model);
+    return append_nef(*N, wrapper, model, transforms);
   } else if (const auto hybrid = dynamic_pointer_cast<const CGALHybridPolyhedron>(geom)) {
-    return append_polyset(*hybrid->toPolySet(), wrapper, model);
+    return append_polyset(*hybrid->toPolySet(), wrapper, model, transforms);
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani = dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    return append_polyset(*mani->toPolySet(), wrapper, model);
+    return append_mesh(Export::ExportMesh{*mani}, wrapper, model, transforms);
 #endif
   } else if (const auto ps = dynamic_pointer_cast<const PolySet>(geom)) {
     PolySet triangulated(3);
     PolySetUtils::tessellate_faces(*ps, triangulated);
-    return append_polyset(triangulated, wrapper, model);
+    return append_polyset(triangulated, wrapper, model, transforms);
   } else if (dynamic_pointer_cast<const Polygon2d>(geom)) {
     assert(false && "Unsupported file format");
   } else {
@@ -29,6 +29,7 @@
 #include "PolySetUtils.h"
 #ifdef ENABLE_MANIFOLD
 #include "ManifoldGeometry.h"
+#include "manifold.h"
 #endif
 
 #ifdef ENABLE_CGAL
@@ -48,6 +49,12 @@ Vector3d toVector(const std::array<double, 3>& pt) {
   return {pt[0], pt[1], pt[2]};
 }
 
+#ifdef ENABLE_MANIFOLD
+Vector3d toVector(const glm::vec3& pt) {
+  return {pt.x, pt.y, pt.z};
+}
+#endif
+
 Vector3d fromString(const std::string& vertexString)
 {
   Vector3d v;
@@ -74,6 +81,68 @@ void write_vector(std::ostream& output, const Vector3f& v) {
 }
 
 
+// Writes one facet of an STL
+void append_stl_triangle(const std::array<Vector3d, 3>& p, std::ostream& output, bool binary)
+{
+  if (binary) {
+    Vector3f p0 = p[0].cast<float>();
+    Vector3f p1 = p[1].cast<float>();
+    Vector3f p2 = p[2].cast<float>();
+
+    // Ensure 3 distinct vertices.
+    if ((p0 != p1) && (p0 != p2) && (p1 != p2)) {
+      Vector3f normal = (p1 - p0).cross(p2 - p0);
+      normal.normalize();
+      if (!is_finite(normal) || is_nan(normal)) {
+        // Collinear vertices.
+        normal << 0, 0, 0;
+      }
+      write_vector(output, normal);
+    }
+    write_vector(output, p0);
+    write_vector(output, p1);
+    write_vector(output, p2);
+    char attrib[2] = {0, 0};
+    output.write(attrib, 2);
+  } else { // ascii
+    std::array<std::string, 3> vertexStrings;
+    std::transform(p.cbegin(), p.cend(), vertexStrings.begin(),
+                   toString);
+
+    if (vertexStrings[0] != vertexStrings[1] &&
+        vertexStrings[0] != vertexStrings[2] &&
+        vertexStrings[1] != vertexStrings[2]) {
+
+      // The above condition ensures that there are 3 distinct
+      // vertices, but they may be collinear. If they are, the unit
+      // normal is meaningless so the default value of "0 0 0" can
+      // be used. If the vertices are not collinear then the unit
+      // normal must be calculated from the components.
+      output << "  facet normal ";
+
+      Vector3d p0 = fromString(vertexStrings[0]);
+      Vector3d p1 = fromString(vertexStrings[1]);
+      Vector3d p2 = fromString(vertexStrings[2]);
+
+      Vector3d normal = (p1 - p0).cross(p2 - p0);
+      normal.normalize();
+      if (is_finite(normal) && !is_nan(normal)) {
+        output << normal[0] << " " << normal[1] << " " << normal[2]
+               << "\n";
+      } else {
+        output << "0 0 0\n";
+      }
+      output << "    outer loop\n";
+
+      for (const auto& vertexString : vertexStrings) {
+        output << "      vertex " << vertexString << "\n";
+      }
+      output << "    endloop\n";
+      output << "  endfacet\n";
+    }
+  }
+}
+
 uint64_t append_stl(const PolySet& ps, std::ostream& output, bool binary)
 {
   uint64_t triangle_count = 0;
@@ -82,64 +151,7 @@ uint64_t append_stl(const PolySet& ps, std::ostream& output, bool binary)
 
   auto processTriangle = [&](const std::array<Vector3d, 3>& p) {
       triangle_count++;
-
-      if (binary) {
-        Vector3f p0 = p[0].cast<float>();
-        Vector3f p1 = p[1].cast<float>();
-        Vector3f p2 = p[2].cast<float>();
-
-        // Ensure 3 distinct vertices.
-        if ((p0 != p1) && (p0 != p2) && (p1 != p2)) {
-          Vector3f normal = (p1 - p0).cross(p2 - p0);
-          normal.normalize();
-          if (!is_finite(normal) || is_nan(normal)) {
-            // Collinear vertices.
-            normal << 0, 0, 0;
-          }
-          write_vector(output, normal);
-        }
-        write_vector(output, p0);
-        write_vector(output, p1);
-        write_vector(output, p2);
-        char attrib[2] = {0, 0};
-        output.write(attrib, 2);
-      } else { // ascii
-        std::array<std::string, 3> vertexStrings;
-        std::transform(p.cbegin(), p.cend(), vertexStrings.begin(),
-                       toString);
-
-        if (vertexStrings[0] != vertexStrings[1] &&
-            vertexStrings[0] != vertexStrings[2] &&
-            vertexStrings[1] != vertexStrings[2]) {
-
-          // The above condition ensures that there are 3 distinct
-          // vertices, but they may be collinear. If they are, the unit
-          // normal is meaningless so the default value of "0 0 0" can
-          // be used. If the vertices are not collinear then the unit
-          // normal must be calculated from the components.
-          output << "  facet normal ";
-
-          Vector3d p0 = fromString(vertexStrings[0]);
-          Vector3d p1 = fromString(vertexStrings[1]);
-          Vector3d p2 = fromString(vertexStrings[2]);
-
-          Vector3d normal = (p1 - p0).cross(p2 - p0);
-          normal.normalize();
-          if (is_finite(normal) && !is_nan(normal)) {
-            output << normal[0] << " " << normal[1] << " " << normal[2]
-                   << "\n";
-          } else {
-            output << "0 0 0\n";
-          }
-          output << "    outer loop\n";
-
-          for (const auto& vertexString : vertexStrings) {
-            output << "      vertex " << vertexString << "\n";
-          }
-          output << "    endloop\n";
-          output << "  endfacet\n";
-        }
-      }
+      append_stl_triangle(p, output, binary);
     };
 
   if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
@@ -215,11 +227,20 @@ uint64_t append_stl(const ManifoldGeometry& mani, std::ostream& output,
     LOG(message_group::Export_Warning, "Exported object may not be a valid 2-manifold and may need repair");
   }
 
-  auto ps = mani.toPolySet();
-  if (ps) {
-    triangle_count += append_stl(*ps, output, binary);
+  // Manifold meshes are triangulated already, so write them without a PolySet
+  if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
+    Export::ExportMesh exportMesh { mani };
+    exportMesh.foreach_triangle([&](const auto& pts) {
+        triangle_count++;
+        append_stl_triangle({ toVector(pts[0]), toVector(pts[1]), toVector(pts[2]) }, output, binary);
+        return true;
+      });
   } else {
-    LOG(message_group::Export_Error, "Manifold->PolySet failed");
+    const manifold::Mesh mesh = mani.getManifold().GetMesh();
+    for (const auto& tv : mesh.triVerts) {
+      triangle_count++;
+      append_stl_triangle({ toVector(mesh.vertPos[tv[0]]), toVector(mesh.vertPos[tv[1]]), toVector(mesh.vertPos[tv[2]]) }, output, binary);
+    }
   }
 
   return triangle_count;
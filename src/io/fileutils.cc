@@ -1,5 +1,6 @@
 #include "fileutils.h"
 #include "printutils.h"
+#include "PathCache.h"
 
 #include <boost/filesystem.hpp>
 namespace fs = boost::filesystem;
@@ -16,14 +17,18 @@ std::string lookup_file(const std::string& filename,
   if (!filename.empty() && !fs::path(filename).is_absolute()) {
     fs::path absfile;
     if (!path.empty()) absfile = fs::absolute(fs::path(path) / filename);
-    fs::path absfile_fallback;
-    if (!fallbackpath.empty()) absfile_fallback = fs::absolute(fs::path(fallbackpath) / filename);
 
-    if (!fs::exists(absfile) && fs::exists(absfile_fallback)) {
-      resultfile = absfile_fallback.string();
-      LOG(message_group::Deprecated, "Imported file (%1$s) found in document root instead of relative to the importing module. This behavior is deprecated", std::string(filename));
+    const auto key = "file\n" + absfile.string() + "\n" + fallbackpath + "\n" + filename;
+    if (auto cached = PathCache::instance()->lookup(key)) {
+      resultfile = *cached;
     } else {
-      resultfile = absfile.string();
+      fs::path absfile_fallback;
+      if (!fallbackpath.empty()) absfile_fallback = fs::absolute(fs::path(fallbackpath) / filename);
+      resultfile = (!fs::exists(absfile) && fs::exists(absfile_fallback) ? absfile_fallback : absfile).string();
+      PathCache::instance()->insert(key, resultfile);
+    }
+    if (resultfile != absfile.string()) {
+      LOG(message_group::Deprecated, "Imported file (%1$s) found in document root instead of relative to the importing module. This behavior is deprecated", std::string(filename));
     }
   } else {
     resultfile = filename;
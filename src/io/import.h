@@ -4,11 +4,20 @@
 #include <boost/optional.hpp>
 
 #include "AST.h"
+#include "GeometryUtils.h"
 
-class PolySet *import_stl(const std::string& filename, const Location& loc);
-class PolySet *import_obj(const std::string& filename, const Location& loc);
+class Geometry *import_stl(const std::string& filename, const Location& loc);
+Geometry *import_obj(const std::string& filename, const Location& loc);
+Geometry *import_off(const std::string& filename, const Location& loc);
 
-PolySet *import_off(const std::string& filename, const Location& loc);
+/*!
+   Creates the geometry of a mesh the importers read as indexed faces.
+   With the manifold feature, a closed manifold mesh is handed to Manifold
+   with the file's own indices instead of as a PolySet to convert again.
+ */
+Geometry *create_imported_mesh(const std::vector<Vector3d>& vertices, const std::vector<IndexedFace>& faces);
+// Whether create_imported_mesh() uses the indices, so importers of polygon soups should index them
+bool imported_meshes_use_indices();
 
 class Polygon2d *import_svg(double fn, double fs, double fa,
                             const std::string& filename,
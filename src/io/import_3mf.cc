@@ -24,6 +24,7 @@
  *
  */
 
+#include "import.h"
 #include "PolySet.h"
 #include "Geometry.h"
 #include "printutils.h"
@@ -31,6 +32,42 @@
 #include "AST.h"
 
 #ifdef ENABLE_LIB3MF
+
+#include <algorithm>
+#include <map>
+
+// Transforms of the build items placing a mesh object
+using Placements = std::vector<Transform3d, Eigen::aligned_allocator<Transform3d>>;
+
+/*
+ * Creates one mesh per build item placing the mesh object. Mesh objects
+ * not placed by any build item, e.g. parts of components, are used as is.
+ */
+static std::vector<Geometry *> create_placed_meshes(const std::vector<Vector3d>& vertices, const std::vector<IndexedFace>& faces, const Placements *placements)
+{
+  if (!placements) return {create_imported_mesh(vertices, faces)};
+
+  std::vector<Geometry *> result;
+  for (const auto& matrix : *placements) {
+    if (matrix.matrix().isIdentity()) {
+      result.push_back(create_imported_mesh(vertices, faces));
+      continue;
+    }
+    std::vector<Vector3d> placed;
+    placed.reserve(vertices.size());
+    for (const auto& vertex : vertices) placed.push_back(matrix * vertex);
+    if (matrix.matrix().determinant() < 0) {
+      // Mirroring flips the winding order
+      auto flipped = faces;
+      for (auto& face : flipped) std::reverse(face.begin(), face.end());
+      result.push_back(create_imported_mesh(placed, flipped));
+    } else {
+      result.push_back(create_imported_mesh(placed, faces));
+    }
+  }
+  return result;
+}
+
 #ifndef LIB3MF_API_2
 #include <Model/COM/NMR_DLLInterfaces.h>
 #undef BOOL
@@ -54,9 +91,9 @@ const std::string get_lib3mf_version() {
 #include "cgalutils.h"
 #endif
 
-using polysets_t = std::list<std::shared_ptr<PolySet>>;
+using meshes_t = std::list<std::shared_ptr<Geometry>>;
 
-static Geometry *import_3mf_error(PLib3MFModel *model = nullptr, PLib3MFModelResourceIterator *object_it = nullptr, PolySet *mesh = nullptr, PolySet *mesh2 = nullptr)
+static Geometry *import_3mf_error(PLib3MFModel *model = nullptr, PLib3MFModelResourceIterator *object_it = nullptr, Geometry *mesh = nullptr)
 {
   if (model) {
     lib3mf_release(model);
@@ -67,9 +104,6 @@ static Geometry *import_3mf_error(PLib3MFModel *model = nullptr, PLib3MFModelRes
   if (mesh) {
     delete mesh;
   }
-  if (mesh2) {
-    delete mesh2;
-  }
 
   return new PolySet(3);
 }
@@ -111,14 +145,55 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
     return import_3mf_error(model);
   }
 
+  std::map<DWORD, Placements> placements;
+  PLib3MFModelBuildItemIterator *item_it;
+  result = lib3mf_model_getbuilditems(model, &item_it);
+  if (result != LIB3MF_OK) {
+    return import_3mf_error(model);
+  }
+  while (true) {
+    int has_next;
+    result = lib3mf_builditemiterator_movenext(item_it, &has_next);
+    if (result != LIB3MF_OK) {
+      lib3mf_release(item_it);
+      return import_3mf_error(model);
+    }
+    if (!has_next) {
+      break;
+    }
+
+    PLib3MFModelBuildItem *item;
+    DWORD object_id;
+    int has_transform;
+    if (lib3mf_builditemiterator_getcurrent(item_it, &item) != LIB3MF_OK ||
+        lib3mf_builditem_getobjectresourceid(item, &object_id) != LIB3MF_OK ||
+        lib3mf_builditem_hasobjecttransform(item, &has_transform) != LIB3MF_OK) {
+      lib3mf_release(item_it);
+      return import_3mf_error(model);
+    }
+    Transform3d matrix = Transform3d::Identity();
+    if (has_transform) {
+      MODELTRANSFORM transform;
+      if (lib3mf_builditem_getobjecttransform(item, &transform) != LIB3MF_OK) {
+        lib3mf_release(item_it);
+        return import_3mf_error(model);
+      }
+      for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) matrix(row, col) = transform.m_fFields[row][col];
+      }
+    }
+    placements[object_id].push_back(matrix);
+  }
+  lib3mf_release(item_it);
+
   PLib3MFModelResourceIterator *object_it;
   result = lib3mf_model_getmeshobjects(model, &object_it);
   if (result != LIB3MF_OK) {
     return import_3mf_error(model);
   }
 
-  PolySet *first_mesh = nullptr;
-  polysets_t meshes;
+  Geometry *first_mesh = nullptr;
+  meshes_t meshes;
   unsigned int mesh_idx = 0;
   while (true) {
     int has_next;
@@ -135,6 +210,11 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
     if (result != LIB3MF_OK) {
       return import_3mf_error(model, object_it, first_mesh);
     }
+    DWORD object_id;
+    result = lib3mf_resource_getresourceid(object, &object_id);
+    if (result != LIB3MF_OK) {
+      return import_3mf_error(model, object_it, first_mesh);
+    }
 
     DWORD vertex_count;
     result = lib3mf_meshobject_getvertexcount(object, &vertex_count);
@@ -149,35 +229,33 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
 
     PRINTDB("%s: mesh %d, vertex count: %lu, triangle count: %lu", filename.c_str() % mesh_idx % vertex_count % triangle_count);
 
-    auto *p = new PolySet(3);
-    p->reserve(triangle_count);
+    std::vector<Vector3d> vertices;
+    vertices.reserve(vertex_count);
+    for (DWORD idx = 0; idx < vertex_count; ++idx) {
+      MODELMESHVERTEX vertex;
+      if (lib3mf_meshobject_getvertex(object, idx, &vertex) != LIB3MF_OK) {
+        return import_3mf_error(model, object_it, first_mesh);
+      }
+      vertices.emplace_back(vertex.m_fPosition[0], vertex.m_fPosition[1], vertex.m_fPosition[2]);
+    }
+
+    std::vector<IndexedFace> faces;
+    faces.reserve(triangle_count);
     for (DWORD idx = 0; idx < triangle_count; ++idx) {
       MODELMESHTRIANGLE triangle;
       if (lib3mf_meshobject_gettriangle(object, idx, &triangle) != LIB3MF_OK) {
-        return import_3mf_error(model, object_it, first_mesh, p);
-      }
-
-      MODELMESHVERTEX vertex1, vertex2, vertex3;
-      if (lib3mf_meshobject_getvertex(object, triangle.m_nIndices[0], &vertex1) != LIB3MF_OK) {
-        return import_3mf_error(model, object_it, first_mesh, p);
+        return import_3mf_error(model, object_it, first_mesh);
       }
-      if (lib3mf_meshobject_getvertex(object, triangle.m_nIndices[1], &vertex2) != LIB3MF_OK) {
-        return import_3mf_error(model, object_it, first_mesh, p);
-      }
-      if (lib3mf_meshobject_getvertex(object, triangle.m_nIndices[2], &vertex3) != LIB3MF_OK) {
-        return import_3mf_error(model, object_it, first_mesh, p);
-      }
-
-      p->append_poly(3);
-      p->append_vertex(vertex1.m_fPosition[0], vertex1.m_fPosition[1], vertex1.m_fPosition[2]);
-      p->append_vertex(vertex2.m_fPosition[0], vertex2.m_fPosition[1], vertex2.m_fPosition[2]);
-      p->append_vertex(vertex3.m_fPosition[0], vertex3.m_fPosition[1], vertex3.m_fPosition[2]);
+      faces.push_back({(int)triangle.m_nIndices[0], (int)triangle.m_nIndices[1], (int)triangle.m_nIndices[2]});
     }
 
-    if (first_mesh) {
-      meshes.push_back(std::shared_ptr<PolySet>(p));
-    } else {
-      first_mesh = p;
+    const auto placement = placements.find(object_id);
+    for (auto *p : create_placed_meshes(vertices, faces, placement == placements.end() ? nullptr : &placement->second)) {
+      if (first_mesh) {
+        meshes.push_back(std::shared_ptr<Geometry>(p));
+      } else {
+        first_mesh = p;
+      }
     }
     mesh_idx++;
   }
@@ -238,16 +316,13 @@ const std::string get_lib3mf_version() {
 #include "cgalutils.h"
 #endif
 
-using polysets_t = std::list<std::shared_ptr<PolySet>>;
+using meshes_t = std::list<std::shared_ptr<Geometry>>;
 
-static Geometry *import_3mf_error(PolySet *mesh = nullptr, PolySet *mesh2 = nullptr)
+static Geometry *import_3mf_error(Geometry *mesh = nullptr)
 {
   if (mesh) {
     delete mesh;
   }
-  if (mesh2) {
-    delete mesh2;
-  }
   return new PolySet(3);
 }
 
@@ -301,14 +376,33 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
     return new PolySet(3);
   }
 
+  std::map<Lib3MF_uint32, Placements> placements;
+  try {
+    Lib3MF::PBuildItemIterator item_it = model->GetBuildItems();
+    while (item_it->MoveNext()) {
+      Lib3MF::PBuildItem item = item_it->GetCurrent();
+      Transform3d matrix = Transform3d::Identity();
+      if (item->HasObjectTransform()) {
+        const Lib3MF::sTransform transform = item->GetObjectTransform();
+        for (int col = 0; col < 4; ++col) {
+          for (int row = 0; row < 3; ++row) matrix(row, col) = transform.m_Fields[col][row];
+        }
+      }
+      placements[item->GetObjectResourceID()].push_back(matrix);
+    }
+  } catch (const Lib3MF::ELib3MFException& e) {
+    LOG(message_group::Error, e.what());
+    return new PolySet(3);
+  }
+
   Lib3MF::PMeshObjectIterator object_it;
   object_it = model->GetMeshObjects();
   if (!object_it) {
     return new PolySet(3);
   }
 
-  PolySet *first_mesh = 0;
-  polysets_t meshes;
+  Geometry *first_mesh = 0;
+  meshes_t meshes;
   unsigned int mesh_idx = 0;
   bool has_next = object_it->MoveNext();
   while (has_next) {
@@ -334,26 +428,29 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
 
     PRINTDB("%s: mesh %d, vertex count: %lu, triangle count: %lu", filename.c_str() % mesh_idx % vertex_count % triangle_count);
 
-    PolySet *p = new PolySet(3);
-    p->reserve(triangle_count);
-    for (Lib3MF_uint64 idx = 0; idx < triangle_count; ++idx) {
-      Lib3MF::sTriangle triangle = object->GetTriangle(idx);
-      Lib3MF::sPosition vertex1, vertex2, vertex3;
-
-      vertex1 = object->GetVertex(triangle.m_Indices[0]);
-      vertex2 = object->GetVertex(triangle.m_Indices[1]);
-      vertex3 = object->GetVertex(triangle.m_Indices[2]);
+    std::vector<Lib3MF::sPosition> positions;
+    std::vector<Lib3MF::sTriangle> triangles;
+    object->GetVertices(positions);
+    object->GetTriangleIndices(triangles);
 
-      p->append_poly(3);
-      p->append_vertex(vertex1.m_Coordinates[0], vertex1.m_Coordinates[1], vertex1.m_Coordinates[2]);
-      p->append_vertex(vertex2.m_Coordinates[0], vertex2.m_Coordinates[1], vertex2.m_Coordinates[2]);
-      p->append_vertex(vertex3.m_Coordinates[0], vertex3.m_Coordinates[1], vertex3.m_Coordinates[2]);
+    std::vector<Vector3d> vertices;
+    vertices.reserve(positions.size());
+    for (const auto& position : positions) {
+      vertices.emplace_back(position.m_Coordinates[0], position.m_Coordinates[1], position.m_Coordinates[2]);
+    }
+    std::vector<IndexedFace> faces;
+    faces.reserve(triangles.size());
+    for (const auto& triangle : triangles) {
+      faces.push_back({(int)triangle.m_Indices[0], (int)triangle.m_Indices[1], (int)triangle.m_Indices[2]});
     }
 
-    if (first_mesh) {
-      meshes.push_back(std::shared_ptr<PolySet>(p));
-    } else {
-      first_mesh = p;
+    const auto placement = placements.find(object->GetResourceID());
+    for (auto *p : create_placed_meshes(vertices, faces, placement == placements.end() ? nullptr : &placement->second)) {
+      if (first_mesh) {
+        meshes.push_back(std::shared_ptr<Geometry>(p));
+      } else {
+        first_mesh = p;
+      }
     }
     mesh_idx++;
     has_next = object_it->MoveNext();
@@ -368,7 +465,7 @@ Geometry *import_3mf(const std::string& filename, const Location& loc)
 #ifdef ENABLE_CGAL
     Geometry::Geometries children;
     children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(), shared_ptr<const Geometry>(first_mesh)));
-    for (polysets_t::iterator it = meshes.begin(); it != meshes.end(); ++it) {
+    for (meshes_t::iterator it = meshes.begin(); it != meshes.end(); ++it) {
       children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(), shared_ptr<const Geometry>(*it)));
     }
     if (auto ps = CGALUtils::getGeometryAsPolySet(CGALUtils::applyUnion3D(children.begin(), children.end()))) {
@@ -25,6 +25,7 @@
  */
 
 #include "PolySet.h"
+#include "compression.h"
 #include "printutils.h"
 #include "AST.h"
 
@@ -68,6 +69,10 @@ private:
   std::map<const std::string, cb_func> start_funcs;
   std::map<const std::string, cb_func> end_funcs;
 
+  std::unique_ptr<std::istream> decompressed; // compressed file, decompressed while it is parsed
+
+  static int read_decompressed(void *context, char *buffer, int len);
+
   static void set_x(AmfImporter *importer, const xmlChar *value);
   static void set_y(AmfImporter *importer, const xmlChar *value);
   static void set_z(AmfImporter *importer, const xmlChar *value);
@@ -210,8 +215,21 @@ void AmfImporter::processNode(xmlTextReaderPtr reader)
   xmlFree((void *) (name));
 }
 
+int AmfImporter::read_decompressed(void *context, char *buffer, int len)
+{
+  auto& stream = *static_cast<AmfImporter *>(context)->decompressed;
+  stream.read(buffer, len);
+  return stream.bad() ? -1 : static_cast<int>(stream.gcount());
+}
+
 xmlTextReaderPtr AmfImporter::createXmlReader(const char *filename)
 {
+  if (isCompressedFile(filename)) {
+    decompressed = openDecompressedStream(filename);
+    if (!decompressed->good()) return nullptr;
+    return xmlReaderForIO(read_decompressed, nullptr, this, filename, nullptr,
+                          XML_PARSE_NOENT | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+  }
   return xmlReaderForFile(filename, nullptr, XML_PARSE_NOENT | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
 }
 
@@ -0,0 +1,36 @@
+#include "import.h"
+#include "Feature.h"
+#include "PolySet.h"
+#ifdef ENABLE_MANIFOLD
+#include "ManifoldGeometry.h"
+#include "manifoldutils.h"
+#endif
+
+bool imported_meshes_use_indices()
+{
+#ifdef ENABLE_MANIFOLD
+  return Feature::ExperimentalManifold.is_enabled();
+#else
+  return false;
+#endif
+}
+
+Geometry *create_imported_mesh(const std::vector<Vector3d>& vertices, const std::vector<IndexedFace>& faces)
+{
+#ifdef ENABLE_MANIFOLD
+  if (imported_meshes_use_indices()) {
+    // Meshes which aren't closed or are inside out take the PolySet route, which repairs them
+    if (auto mani = ManifoldUtils::indexedMeshToManifold(vertices, faces)) {
+      return new ManifoldGeometry(mani);
+    }
+  }
+#endif
+
+  auto *p = new PolySet(3);
+  p->reserve(faces.size());
+  for (const auto& face : faces) {
+    p->append_poly(face.size());
+    for (const auto i : face) p->append_vertex(vertices[i]);
+  }
+  return p;
+}
@@ -1,4 +1,5 @@
 #include "import.h"
+#include "compression.h"
 #include "PolySet.h"
 #include <fstream>
 #include <vector>
@@ -7,18 +8,17 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
 
-PolySet *import_obj(const std::string& filename, const Location& loc) {
-  std::unique_ptr<PolySet> p = std::make_unique<PolySet>(3);
-
-  
-  std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary );
+Geometry *import_obj(const std::string& filename, const Location& loc) {
+  auto file = openDecompressedStream(filename);
+  auto& f = *file;
   if (!f.good()) {
     LOG(message_group::Warning,
         "Can't open import file '%1$s', import() at line %2$d",
         filename, loc.firstLine());
-    return p.release();
+    return new PolySet(3);
   }
   std::vector<Vector3d> pts;
+  std::vector<IndexedFace> faces;
   boost::regex ex_comment(R"(^\s*#)");
   boost::regex ex_v( R"(^\s*v\s+([^\s]+)\s+([^\s]+)\s+([^\s]+)\s*$)");
   boost::regex ex_f( R"(^\s*f\s+(.*)$)");
@@ -38,7 +38,7 @@ PolySet *import_obj(const std::string& filename, const Location& loc) {
     lineno, errstr, line, filename);
   };
 
-  while (!f.eof()) {
+  while (f.good()) {
     lineno++;
     std::getline(f, line);
     boost::trim(line);
@@ -61,7 +61,8 @@ PolySet *import_obj(const std::string& filename, const Location& loc) {
       std::string args=results[1];
       std::vector<std::string> words;
       boost::split(words, results[1], boost::is_any_of(" \t"));
-      p->append_poly(words.size());
+      auto& face = faces.emplace_back();
+      face.reserve(words.size());
       for (const std::string& word : words) {
         std::vector<std::string> wordindex;
         boost::split(wordindex, word, boost::is_any_of("/"));
@@ -70,7 +71,7 @@ PolySet *import_obj(const std::string& filename, const Location& loc) {
 	else {
 	  int ind=boost::lexical_cast<int>(wordindex[0]);
           if(ind >= 1 && ind  <= pts.size()) {
-            p->append_vertex(pts[ind-1][0], pts[ind-1][1], pts[ind-1][2]);
+            face.push_back(ind - 1);
 	  } else {  
             LOG(message_group::Warning, "Index %1$d out of range in Line %2$d", filename, lineno);
 	  }
@@ -88,5 +89,7 @@ PolySet *import_obj(const std::string& filename, const Location& loc) {
       LOG(message_group::Warning, "Unrecognized Line  %1$s in line Line %2$d", line, lineno);
     }
   }
-  return p.release();
+  // The reason why a compressed file couldn't be read was logged already
+  if (f.bad()) return new PolySet(3);
+  return create_imported_mesh(pts, faces);
 }
@@ -1,27 +1,48 @@
 #include "import.h"
+#include "compression.h"
 #include "PolySet.h"
 #include "printutils.h"
 #include "AST.h"
+#include <map>
 #ifdef ENABLE_CGAL
 #include "cgalutils.h"
 #endif
 
-PolySet *import_off(const std::string& filename, const Location& loc)
+Geometry *import_off(const std::string& filename, const Location& loc)
 {
-  auto *p = new PolySet(3);
 #ifdef ENABLE_CGAL
   CGAL_Polyhedron poly;
-  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
-  if (!file.good()) {
+  auto file = openDecompressedFile(filename);
+  if (!file->good()) {
     LOG(message_group::Warning, "Can't open import file '%1$s', import() at line %2$d", filename, loc.firstLine());
-  } else {
-    file >> poly;
-    file.close();
-    CGALUtils::createPolySetFromPolyhedron(poly, *p);
+    return new PolySet(3);
   }
+  *file >> poly;
+  file.reset();
+
+  // Keep the file's vertex indices
+  std::vector<Vector3d> vertices;
+  std::map<const CGAL_Polyhedron::Vertex *, int> vertexIndices;
+  vertices.reserve(poly.size_of_vertices());
+  for (auto vi = poly.vertices_begin(); vi != poly.vertices_end(); ++vi) {
+    vertexIndices.emplace(&*vi, vertices.size());
+    vertices.push_back(vector_convert<Vector3d>(vi->point()));
+  }
+  std::vector<IndexedFace> faces;
+  faces.reserve(poly.size_of_facets());
+  for (auto fi = poly.facets_begin(); fi != poly.facets_end(); ++fi) {
+    auto& face = faces.emplace_back();
+    face.reserve(fi->facet_degree());
+    auto hc = fi->facet_begin();
+    const auto hc_end = hc;
+    do {
+      face.push_back(vertexIndices[&*((hc++)->vertex())]);
+    } while (hc != hc_end);
+  }
+  return create_imported_mesh(vertices, faces);
 #else
   LOG(message_group::Warning, "OFF import requires CGAL, import() at line %2$d", filename, loc.firstLine());
+  return new PolySet(3);
 #endif // ifdef ENABLE_CGAL
-  return p;
 }
 
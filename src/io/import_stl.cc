@@ -1,7 +1,9 @@
 #include "import.h"
+#include "compression.h"
 #include "PolySet.h"
 #include "printutils.h"
 #include "AST.h"
+#include "Reindexer.h"
 
 #include <fstream>
 #include <boost/predef.h>
@@ -50,7 +52,7 @@ static void uint32_byte_swap(uint32_t& x) {
 }
 #endif // if BOOST_ENDIAN_BIG_BYTE
 
-static void read_stl_facet(std::ifstream& f, stl_facet& facet) {
+static void read_stl_facet(std::istream& f, stl_facet& facet) {
   f.read((char *)facet.data8, STL_FACET_NUMBYTES);
   if (f.gcount() < STL_FACET_NUMBYTES) {
     throw std::ios_base::failure("facet data truncated");
@@ -63,16 +65,33 @@ static void read_stl_facet(std::ifstream& f, stl_facet& facet) {
 #endif
 }
 
-PolySet *import_stl(const std::string& filename, const Location& loc) {
-  std::unique_ptr<PolySet> p = std::make_unique<PolySet>(3);
+Geometry *import_stl(const std::string& filename, const Location& loc) {
+  // STL stores every corner of every facet. Only when the mesh is imported by
+  // its indices are shared corners merged, otherwise a PolySet takes them as they are.
+  const bool indexed = imported_meshes_use_indices();
+  Reindexer<Vector3d> vertices;
+  std::vector<IndexedFace> faces;
+  auto p = std::make_unique<PolySet>(3);
+  auto addFacet = [&](const Vector3d& v1, const Vector3d& v2, const Vector3d& v3) {
+      if (indexed) {
+        faces.push_back({vertices.lookup(v1), vertices.lookup(v2), vertices.lookup(v3)});
+      } else {
+        p->append_poly(3);
+        p->append_vertex(v1);
+        p->append_vertex(v2);
+        p->append_vertex(v3);
+      }
+    };
 
-  // Open file and position at the end
-  std::ifstream f(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+  // Open file, decompressing it if needed, and position at the end
+  auto file = openDecompressedFile(filename);
+  auto& f = *file;
+  f.seekg(0, std::ios::end);
   if (!f.good()) {
     LOG(message_group::Warning,
         "Can't open import file '%1$s', import() at line %2$d",
         filename, loc.firstLine());
-    return p.release();
+    return new PolySet(3);
   }
 
   boost::regex ex_sfe(R"(^\s*solid|^\s*facet|^\s*endfacet)");
@@ -94,7 +113,12 @@ PolySet *import_stl(const std::string& filename, const Location& loc) {
 #endif
     if (file_size == static_cast<std::streamoff>(80ul + 4ul + 50ul * facenum)) {
       binary = true;
-      p->reserve(facenum);
+      if (indexed) {
+        faces.reserve(facenum);
+        vertices.reserve(facenum / 2);
+      } else {
+        p->reserve(facenum);
+      }
     }
   }
   f.seekg(0);
@@ -145,10 +169,9 @@ PolySet *import_stl(const std::string& filename, const Location& loc) {
               boost::lexical_cast<double>(results[v + 1]);
           }
           if (++i == 3) {
-            p->append_poly(3);
-            p->append_vertex(vdata[0][0], vdata[0][1], vdata[0][2]);
-            p->append_vertex(vdata[1][0], vdata[1][1], vdata[1][2]);
-            p->append_vertex(vdata[2][0], vdata[2][1], vdata[2][2]);
+            addFacet({vdata[0][0], vdata[0][1], vdata[0][2]},
+                     {vdata[1][0], vdata[1][1], vdata[1][2]},
+                     {vdata[2][0], vdata[2][1], vdata[2][2]});
           }
         } catch (const boost::bad_lexical_cast& blc) {
           AsciiError("can't parse vertex");
@@ -170,10 +193,9 @@ PolySet *import_stl(const std::string& filename, const Location& loc) {
           if (f.eof()) break;
           throw;
         }
-        p->append_poly(3);
-        p->append_vertex(facet.data.x1, facet.data.y1, facet.data.z1);
-        p->append_vertex(facet.data.x2, facet.data.y2, facet.data.z2);
-        p->append_vertex(facet.data.x3, facet.data.y3, facet.data.z3);
+        addFacet({facet.data.x1, facet.data.y1, facet.data.z1},
+                 {facet.data.x2, facet.data.y2, facet.data.z2},
+                 {facet.data.x3, facet.data.y3, facet.data.z3});
       }
     } catch (const std::ios_base::failure& ex) {
       int64_t offset = -1;
@@ -194,5 +216,6 @@ PolySet *import_stl(const std::string& filename, const Location& loc) {
         "STL format not recognized in '%1$s'.", filename);
     return new PolySet(3);
   }
-  return p.release();
+  if (!indexed) return p.release();
+  return create_imported_mesh(vertices.getArray(), faces);
 }
@@ -0,0 +1,350 @@
+#include "libopenscad.h"
+#include "Builtins.h"
+#include "BuiltinContext.h"
+#include "EvaluationSession.h"
+#include "GeometryCache.h"
+#include "GeometryEvaluator.h"
+#include "PathCache.h"
+#include "PlatformUtils.h"
+#include "Polygon2d.h"
+#include "PolySet.h"
+#include "Reindexer.h"
+#include "RenderStatistic.h"
+#include "SourceFile.h"
+#include "SourceFileCache.h"
+#include "Tree.h"
+#include "core/node.h"
+#include "dxfdim.h"
+#include "exceptions.h"
+#include "openscad.h"
+#include "parsersettings.h"
+#include "printutils.h"
+#ifdef ENABLE_CGAL
+#include "CGALCache.h"
+#include "cgalutils.h"
+#endif
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace libopenscad {
+
+static std::string application_path;
+
+void initialize(const std::string& applicationPath)
+{
+  application_path = applicationPath;
+}
+
+/*!
+   Sets up what main() sets up for the command line, once per process.
+ */
+static void initializeOnce()
+{
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    PlatformUtils::registerApplicationPath(application_path.empty() ? fs::current_path().generic_string() : application_path);
+#ifdef ENABLE_CGAL
+    // Always throw exceptions from CGAL, so we can catch instead of crashing on bad geometry.
+    CGAL::set_error_behaviour(CGAL::THROW_EXCEPTION);
+    CGAL::set_warning_behaviour(CGAL::THROW_EXCEPTION);
+#endif
+    Builtins::instance()->initialize();
+    parser_init();
+  });
+}
+
+void clearCaches()
+{
+  GeometryCache::instance()->clear();
+#ifdef ENABLE_CGAL
+  CGALCache::instance()->clear();
+#endif
+  dxf_dim_cache.clear();
+  dxf_cross_cache.clear();
+  SourceFileCache::instance()->clear();
+  PathCache::instance()->clear();
+}
+
+struct Session::Impl
+{
+  std::string source;
+  std::string filename;
+  std::vector<std::pair<std::string, std::string>> variables;
+
+  // Parsed lazily, as the variables are parsed along with the source
+  std::unique_ptr<SourceFile> root_file;
+  std::shared_ptr<AbstractNode> root_node;
+  shared_ptr<const Geometry> root_geom;
+  std::string summary;
+  std::vector<Message> messages;
+
+  static void output(const ::Message& msg, void *userdata);
+  template <typename F> bool run(F f);
+  void reset();
+  [[nodiscard]] fs::path documentPath() const;
+  bool parse();
+  bool evaluate();
+  bool render();
+};
+
+void Session::Impl::output(const ::Message& msg, void *userdata)
+{
+  auto self = static_cast<Session::Impl *>(userdata);
+  Message message;
+  message.type = msg.group == message_group::NONE ? "" : getGroupName(msg.group);
+  message.text = msg.msg;
+  if (!msg.loc.isNone()) {
+    message.file = msg.loc.fileName();
+    message.line = msg.loc.firstLine();
+  }
+  self->messages.push_back(std::move(message));
+}
+
+/*!
+   Runs \a f with the messages logged going to the session, catching what
+   would otherwise end the command line process.
+ */
+template <typename F>
+bool Session::Impl::run(F f)
+{
+  set_output_handler(&Session::Impl::output, nullptr, this);
+  resetSuppressedMessages();
+  bool result = false;
+  try {
+    result = f();
+  } catch (const HardWarningException&) {
+  } catch (const std::exception& e) {
+    LOG(message_group::Error, "%1$s", e.what());
+  }
+  set_output_handler(nullptr, nullptr, nullptr);
+  return result;
+}
+
+// Drops the results depending on the source and the variables
+void Session::Impl::reset()
+{
+  this->root_file.reset();
+  this->root_node.reset();
+  this->root_geom.reset();
+}
+
+fs::path Session::Impl::documentPath() const
+{
+  return this->filename.empty() ? fs::current_path() : fs::absolute(fs::path(this->filename)).parent_path();
+}
+
+bool Session::Impl::parse()
+{
+  std::string text = this->source + "\n\x03\n";
+  for (const auto& [name, expression] : this->variables) {
+    text += name + "=" + expression + ";\n";
+  }
+  SourceFile *file = nullptr;
+  if (!::parse(file, text, this->filename, this->filename, false)) {
+    delete file;
+    file = nullptr;
+  }
+  this->root_file.reset(file);
+  if (!file) return false;
+  file->handleDependencies();
+  return true;
+}
+
+bool Session::Impl::evaluate()
+{
+  this->root_node.reset();
+  this->root_geom.reset();
+  if (!this->root_file && !parse()) return false;
+
+  const auto fparent = documentPath();
+  const auto original_path = fs::current_path();
+  fs::current_path(fparent);
+
+  EvaluationSession session{fparent.string()};
+  ContextHandle<BuiltinContext> builtin_context{Context::create<BuiltinContext>(&session)};
+  builtin_context->set_variable("$preview", Value(false));
+
+  AbstractNode::resetIndexCounter();
+  std::shared_ptr<const FileContext> file_context;
+  std::shared_ptr<AbstractNode> absolute_root_node;
+  try {
+    absolute_root_node = this->root_file->instantiate(*builtin_context, &file_context);
+  } catch (...) {
+    fs::current_path(original_path);
+    throw;
+  }
+  fs::current_path(original_path);
+  if (!absolute_root_node) return false;
+
+  if (!(this->root_node = find_root_tag(absolute_root_node))) {
+    this->root_node = absolute_root_node;
+  }
+  return true;
+}
+
+bool Session::Impl::render()
+{
+  if (!this->root_node && !evaluate()) return false;
+
+  RenderStatistic statistic;
+  Tree tree(this->root_node, documentPath().string());
+  GeometryEvaluator geomevaluator(tree);
+  this->root_geom = geomevaluator.evaluateGeometry(*tree.root(), true);
+
+  std::ostringstream summary;
+  statistic.printAll(this->root_geom, Camera(), {"all"}, summary);
+  this->summary = summary.str();
+  return this->root_geom != nullptr;
+}
+
+Session::Session() : impl(std::make_unique<Impl>())
+{
+  initializeOnce();
+}
+
+Session::~Session() = default;
+
+bool Session::parse(const std::string& source, const std::string& filename)
+{
+  impl->source = source;
+  impl->filename = filename;
+  impl->reset();
+  return impl->run([this]() { return impl->parse(); });
+}
+
+bool Session::load(const std::string& filename)
+{
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    impl->messages.push_back({getGroupName(message_group::Error), "Can't open input file '" + filename + "'", "", 0});
+    return false;
+  }
+  return parse(std::string((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>()), filename);
+}
+
+void Session::setVariable(const std::string& name, const std::string& expression)
+{
+  auto it = std::find_if(impl->variables.begin(), impl->variables.end(), [&name](const auto& variable) {
+    return variable.first == name;
+  });
+  if (it != impl->variables.end()) it->second = expression;
+  else impl->variables.emplace_back(name, expression);
+  impl->reset();
+}
+
+void Session::clearVariables()
+{
+  impl->variables.clear();
+  impl->reset();
+}
+
+bool Session::evaluate()
+{
+  return impl->run([this]() { return impl->evaluate(); });
+}
+
+std::string Session::tree() const
+{
+  if (!impl->root_node) return {};
+  Tree tree(impl->root_node);
+  return tree.getString(*impl->root_node, "\t");
+}
+
+bool Session::render()
+{
+  return impl->run([this]() { return impl->render(); });
+}
+
+int Session::dimension() const
+{
+  return impl->root_geom && !impl->root_geom->isEmpty() ? impl->root_geom->getDimension() : 0;
+}
+
+/*!
+   Returns the rendered 3D geometry, with the parts of a top level list
+   merged into one mesh.
+ */
+Mesh Session::mesh() const
+{
+  Mesh mesh;
+  if (dimension() != 3) return mesh;
+
+  Geometry::Geometries geometries;
+  if (auto list = dynamic_pointer_cast<const GeometryList>(impl->root_geom)) {
+    geometries = list->flatten();
+  } else {
+    geometries.emplace_back(nullptr, impl->root_geom);
+  }
+
+  Reindexer<Vector3d> vertices;
+  for (const auto& item : geometries) {
+    if (!item.second || item.second->getDimension() != 3) continue;
+#ifdef ENABLE_CGAL
+    auto ps = CGALUtils::getGeometryAsPolySet(item.second);
+#else
+    auto ps = dynamic_pointer_cast<const PolySet>(item.second);
+#endif
+    if (!ps) continue;
+    for (const auto& polygon : ps->polygons) {
+      std::vector<int> face;
+      face.reserve(polygon.size());
+      for (const auto& vertex : polygon) face.push_back(vertices.lookup(vertex));
+      mesh.faces.push_back(std::move(face));
+    }
+  }
+  for (const auto& vertex : vertices.getArray()) {
+    mesh.vertices.push_back({vertex[0], vertex[1], vertex[2]});
+  }
+  return mesh;
+}
+
+/*!
+   Returns the rendered 2D geometry, with the outlines of a top level list
+   collected into one set.
+ */
+Polygons Session::polygons() const
+{
+  Polygons polygons;
+  if (dimension() != 2) return polygons;
+
+  Geometry::Geometries geometries;
+  if (auto list = dynamic_pointer_cast<const GeometryList>(impl->root_geom)) {
+    geometries = list->flatten();
+  } else {
+    geometries.emplace_back(nullptr, impl->root_geom);
+  }
+  for (const auto& item : geometries) {
+    auto poly = dynamic_pointer_cast<const Polygon2d>(item.second);
+    if (!poly) continue;
+    for (const auto& o : poly->outlines()) {
+      Outline outline;
+      outline.positive = o.positive;
+      for (const auto& vertex : o.vertices) outline.vertices.push_back({vertex[0], vertex[1]});
+      polygons.outlines.push_back(std::move(outline));
+    }
+  }
+  return polygons;
+}
+
+const std::string& Session::summary() const
+{
+  return impl->summary;
+}
+
+const std::vector<Message>& Session::messages() const
+{
+  return impl->messages;
+}
+
+void Session::clearMessages()
+{
+  impl->messages.clear();
+}
+
+} // namespace libopenscad
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*!
+   In-process API of the libopenscad library target.
+
+   This header is self-contained: it doesn't expose OpenSCAD's internal types.
+   The caches (source files, geometry, CGAL, fonts) are shared by all sessions
+   of the process and stay warm between calls. Like the rest of OpenSCAD,
+   evaluation uses process wide state, so calls must not run concurrently.
+ */
+namespace libopenscad {
+
+struct Message {
+  std::string type; // e.g. "WARNING", empty for echo-less plain output
+  std::string text;
+  std::string file;
+  int line{0};
+};
+
+// Indexed mesh. Faces list vertex indices counter-clockwise seen from outside.
+struct Mesh {
+  std::vector<std::array<double, 3>> vertices;
+  std::vector<std::vector<int>> faces;
+};
+
+struct Outline {
+  std::vector<std::array<double, 2>> vertices;
+  bool positive{true}; // false for holes
+};
+
+struct Polygons {
+  std::vector<Outline> outlines;
+};
+
+/*!
+   Sets the directory of the installed openscad executable, used to find the
+   bundled libraries, fonts and color schemes. Call before creating the first
+   session; defaults to the current directory.
+ */
+void initialize(const std::string& applicationPath);
+
+// Flushes all caches shared by the sessions
+void clearCaches();
+
+class Session
+{
+public:
+  Session();
+  ~Session();
+  Session(const Session&) = delete;
+  Session& operator=(const Session&) = delete;
+
+  // Parses source text. Relative includes and imports are resolved against
+  // the directory of \a filename.
+  bool parse(const std::string& source, const std::string& filename = "");
+  bool load(const std::string& filename);
+
+  // Overrides a top level variable like -D on the command line, e.g.
+  // setVariable("size", "[10, 20]"). Takes effect at the next evaluate().
+  void setVariable(const std::string& name, const std::string& expression);
+  void clearVariables();
+
+  // Evaluates the parsed source to a node tree
+  bool evaluate();
+  // The evaluated node tree in .csg syntax
+  [[nodiscard]] std::string tree() const;
+
+  // Renders the evaluated node tree, evaluating it first if needed
+  bool render();
+  // 2 or 3 for the rendered geometry, 0 if there is none
+  [[nodiscard]] int dimension() const;
+  [[nodiscard]] Mesh mesh() const;
+  [[nodiscard]] Polygons polygons() const;
+  // Statistics of the last render in JSON, as written by --summary-file
+  [[nodiscard]] const std::string& summary() const;
+
+  // Messages logged since the last clearMessages()
+  [[nodiscard]] const std::vector<Message>& messages() const;
+  void clearMessages();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+} // namespace libopenscad
@@ -27,10 +27,12 @@
 #include "openscad.h"
 #include "CommentParser.h"
 #include "core/node.h"
+#include "NodeSerializer.h"
 #include "SourceFile.h"
 #include "BuiltinContext.h"
 #include "Value.h"
 #include "export.h"
+#include "compression.h"
 #include "Builtins.h"
 #include "printutils.h"
 #include "handle_dep.h"
@@ -46,7 +48,9 @@
 #include "RenderStatistic.h"
 #include "ParameterObject.h"
 #include "ParameterSet.h"
+#include "RenderServer.h"
 #include "openscad_mimalloc.h"
+#include <map>
 #include <string>
 #include <vector>
 #include <fstream>
@@ -102,10 +106,30 @@ using boost::lexical_cast;
 using boost::bad_lexical_cast;
 using boost::is_any_of;
 
-std::string commandline_commands;
 static bool arg_info = false;
 static std::string arg_colorscheme;
 
+// Time spent in each startup phase, reported with --debug=openscad.
+// The phases run before --debug is parsed, so they are recorded first.
+static std::vector<std::pair<const char *, std::chrono::steady_clock::duration>> startup_phases;
+static auto startup_phase_start = std::chrono::steady_clock::now();
+
+static void startup_phase(const char *name)
+{
+  const auto now = std::chrono::steady_clock::now();
+  startup_phases.emplace_back(name, now - startup_phase_start);
+  startup_phase_start = now;
+}
+
+static void print_startup_phases()
+{
+  for (const auto& [name, duration] : startup_phases) {
+    const std::chrono::duration<double, std::milli> ms = duration;
+    PRINTDB("Startup: %s took %.3f ms", name % ms.count());
+  }
+  startup_phases.clear();
+}
+
 class Echostream
 {
 public:
@@ -131,8 +155,12 @@ private:
   std::ostream& stream;
 };
 
-static void help(const char *arg0, const po::options_description& desc, bool failure = false)
+static void describe_options(po::options_description& desc, const ViewOptions& viewOptions, bool list_colorschemes);
+
+static void help(const char *arg0, const ViewOptions& viewOptions, bool failure = false)
 {
+  po::options_description desc("Allowed options");
+  describe_options(desc, viewOptions, true);
   const fs::path progpath(arg0);
   LOG("Usage: %1$s [options] file.scad\n%2$s", progpath.filename().string(), desc);
   exit(failure ? 1 : 0);
@@ -299,6 +327,7 @@ static bool checkAndExport(const shared_ptr<const Geometry>& root_geom, unsigned
 
 void set_render_color_scheme(const std::string& color_scheme, const bool exit_if_not_found)
 {
+  // Without --colorscheme, exports don't load the color schemes at all
   if (color_scheme.empty()) {
     return;
   }
@@ -332,6 +361,9 @@ struct CommandLine
   unsigned animate_frames;
   const std::vector<std::string> summaryOptions;
   const std::string summaryFile;
+  const ParameterSweep& sweep;
+  // Customizer values applied on top of the parameter set
+  const ParameterSet *parameterValues{nullptr};
 };
 
 struct RenderVariables
@@ -340,7 +372,8 @@ struct RenderVariables
   double time;
 };
 
-int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat curFormat, SourceFile *root_file);
+int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat curFormat, SourceFile *root_file,
+              const std::shared_ptr<AbstractNode>& loaded_root_node);
 
 int cmdline(const CommandLine& cmd)
 {
@@ -351,8 +384,8 @@ int cmdline(const CommandLine& cmd)
   if (cmd.export_format.is_initialized()) {
     export_format = cmd.export_format.get();
   } else {
-    // else extract format from file extension
-    const auto path = fs::path(cmd.output_file);
+    // else extract format from file extension, e.g. stl for "model.stl.gz"
+    const auto path = fs::path(stripCompressionSuffix(cmd.output_file));
     std::string suffix = path.has_extension() ? path.extension().generic_string().substr(1) : "";
     boost::algorithm::to_lower(suffix);
     const auto format_iter = exportFileFormatOptions.exportFileFormats.find(suffix);
@@ -377,13 +410,35 @@ int cmdline(const CommandLine& cmd)
 
   set_render_color_scheme(arg_colorscheme, true);
 
+  const bool is_csgb = !cmd.is_stdin && boost::algorithm::iends_with(cmd.filename, ".csgb");
+  if (is_csgb && (!commandline_commands.empty() || !cmd.parameterFile.empty() || !cmd.sweep.empty() ||
+                  (cmd.parameterValues && !cmd.parameterValues->empty()))) {
+    LOG(message_group::Error, "An evaluated tree (.csgb) can't take -D, parameters or --sweep: '%1$s'", cmd.filename);
+    return 1;
+  }
+
   shared_ptr<Echostream> echostream;
-  if (export_format == FileFormat::ECHO) {
+  // A parameter sweep writes the echo output of each variant to its own file
+  if (export_format == FileFormat::ECHO && cmd.sweep.empty()) {
     echostream.reset(cmd.is_stdout ? new Echostream(std::cout) : new Echostream(cmd.output_file));
   }
 
   std::string text;
-  if (cmd.is_stdin) {
+  // An evaluated tree (.csgb) is rendered as is, with an empty source file
+  std::shared_ptr<AbstractNode> loaded_root_node;
+  if (is_csgb) {
+    std::ifstream ifs(cmd.filename, std::ios::binary);
+    if (!ifs.is_open()) {
+      LOG("Can't open input file '%1$s'!\n", cmd.filename);
+      return 1;
+    }
+    handle_dep(cmd.filename);
+    loaded_root_node = NodeSerializer::read(ifs, fs::absolute(cmd.filename).parent_path().string());
+    if (!loaded_root_node) {
+      LOG("Can't read evaluated tree '%1$s'!\n", cmd.filename);
+      return 1;
+    }
+  } else if (cmd.is_stdin) {
     text = std::string((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
   } else {
     std::ifstream ifs(cmd.filename);
@@ -425,8 +480,8 @@ int cmdline(const CommandLine& cmd)
 
   // add parameter to AST
   CommentParser::collectParameters(text.c_str(), root_file);
+  ParameterObjects parameters = ParameterObjects::fromSourceFile(root_file);
   if (!cmd.parameterFile.empty() && !cmd.setName.empty()) {
-    ParameterObjects parameters = ParameterObjects::fromSourceFile(root_file);
     ParameterSets sets;
     sets.readFile(cmd.parameterFile);
     for (const auto& set : sets) {
@@ -437,15 +492,51 @@ int cmdline(const CommandLine& cmd)
       }
     }
   }
+  if (cmd.parameterValues) {
+    ParameterSet values = parameters.exportValues("");
+    for (const auto& [name, value] : *cmd.parameterValues) values[name] = value;
+    parameters.importValues(values);
+    parameters.apply(root_file);
+  }
 
   root_file->handleDependencies();
 
   RenderVariables render_variables;
   render_variables.preview = canPreview(export_format) ? (cmd.viewOptions.renderer == RenderType::OPENCSG || cmd.viewOptions.renderer == RenderType::THROWNTOGETHER) : false;
 
-  if (cmd.animate_frames == 0) {
+  if (!cmd.sweep.empty()) {
+    // export one file per parameter combination. The source file is parsed
+    // only once and the geometry caches are shared by all variants, so
+    // subtrees not depending on the swept parameters are evaluated once.
+    for (const auto& item : cmd.sweep.dimensions()) {
+      if (std::none_of(parameters.begin(), parameters.end(), [&item](const auto& parameter) {
+        return parameter->name() == item.first;
+      })) {
+        LOG(message_group::Warning, "Parameter sweep: '%1$s' is not a customizer parameter", item.first);
+      }
+    }
+    const ParameterSet base = parameters.exportValues("");
+    render_variables.time = 0;
+    for (size_t variant = 0; variant < cmd.sweep.size(); ++variant) {
+      parameters.importValues(cmd.sweep.variant(base, variant));
+      parameters.apply(root_file);
+
+      CommandLine variant_cmd = cmd;
+      variant_cmd.output_file = cmd.sweep.filename(cmd.output_file, variant);
+      if (export_format == FileFormat::ECHO) {
+        echostream.reset(new Echostream(variant_cmd.output_file));
+      }
+      LOG("Exporting %1$s (variant %2$d of %3$d)...", variant_cmd.output_file, variant + 1, cmd.sweep.size());
+
+      int r = do_export(variant_cmd, render_variables, export_format, root_file, loaded_root_node);
+      if (r != 0) {
+        return r;
+      }
+    }
+    return 0;
+  } else if (cmd.animate_frames == 0) {
     render_variables.time = 0;
-    return do_export(cmd, render_variables, export_format, root_file);
+    return do_export(cmd, render_variables, export_format, root_file, loaded_root_node);
   } else {
     // export the requested number of animated frames
     for (unsigned frame = 0; frame < cmd.animate_frames; ++frame) {
@@ -454,19 +545,21 @@ int cmdline(const CommandLine& cmd)
       std::ostringstream oss;
       oss << std::setw(5) << std::setfill('0') << frame;
 
-      auto frame_file = fs::path(cmd.output_file);
+      // Keep a compression suffix last, e.g. "frame00001.stl.gz"
+      const auto uncompressed = stripCompressionSuffix(cmd.output_file);
+      auto frame_file = fs::path(uncompressed);
       auto extension = frame_file.extension();
       frame_file.replace_extension();
       frame_file += oss.str();
       frame_file.replace_extension(extension);
-      string frame_str = frame_file.generic_string();
+      string frame_str = frame_file.generic_string() + cmd.output_file.substr(uncompressed.size());
 
       LOG("Exporting %1$s...", cmd.filename);
 
       CommandLine frame_cmd = cmd;
       frame_cmd.output_file = frame_str;
 
-      int r = do_export(frame_cmd, render_variables, export_format, root_file);
+      int r = do_export(frame_cmd, render_variables, export_format, root_file, loaded_root_node);
       if (r != 0) {
         return r;
       }
@@ -476,7 +569,8 @@ int cmdline(const CommandLine& cmd)
   }
 }
 
-int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat curFormat, SourceFile *root_file)
+int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat curFormat, SourceFile *root_file,
+              const std::shared_ptr<AbstractNode>& loaded_root_node)
 {
   auto filename_str = fs::path(cmd.output_file).generic_string();
   auto fpath = fs::absolute(fs::path(cmd.filename));
@@ -500,7 +594,8 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     if(python_result_node != NULL && python_active) absolute_root_node = python_result_node;
     else
 #endif	    
-  absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
+  if (loaded_root_node) absolute_root_node = loaded_root_node;
+  else absolute_root_node = root_file->instantiate(*builtin_context, &file_context);
   Camera camera = cmd.camera;
   if (file_context) {
     camera.updateView(file_context, true);
@@ -531,6 +626,17 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       stream << tree.getString(*root_node, "\t") << "\n";
     });
     fs::current_path(cmd.original_path);
+  } else if (curFormat == FileFormat::CSGB) {
+    bool ok = false;
+    with_output(cmd.is_stdout, filename_str, [&](std::ostream& stream) {
+      try {
+        NodeSerializer::write(*root_node, fparent.string(), stream);
+        ok = true;
+      } catch (const std::invalid_argument& e) {
+        LOG(message_group::Export_Error, "%1$s", e.what());
+      }
+    }, std::ios::out | std::ios::binary);
+    if (!ok) return 1;
   } else if (curFormat == FileFormat::AST) {
     fs::current_path(fparent); // Force exported filenames to be relative to document path
     with_output(cmd.is_stdout, filename_str, [root_file](std::ostream& stream) {
@@ -735,6 +841,7 @@ void registerDefaultIcon(const QString&) { }
 int gui(vector<string>& inputFiles, const fs::path& original_path, int argc, char **argv)
 {
   OpenSCADApp app(argc, argv);
+  startup_phase("Qt application");
   // remove ugly frames in the QStatusBar when using additional widgets
   app.setStyleSheet("QStatusBar::item { border: 0px solid black; }");
 
@@ -760,9 +867,12 @@ int gui(vector<string>& inputFiles, const fs::path& original_path, int argc, cha
   parser_init();
 
   QSettingsCached settings;
+  startup_phase("library paths");
   if (settings.value("advanced/localization", true).toBool()) {
     localization_init();
   }
+  startup_phase("localization");
+  print_startup_phases();
 
 #ifdef Q_OS_MAC
   installAppleEventHandlers();
@@ -912,57 +1022,20 @@ bool flagConvert(const std::string& str){
   return false;
 }
 
-// OpenSCAD
-int main(int argc, char **argv)
+/*!
+   Adds the command line options to \a desc.
+   Listing the color schemes reads them all from disk, so it's only done when
+   the help text is actually printed.
+ */
+static void describe_options(po::options_description& desc, const ViewOptions& viewOptions, bool list_colorschemes)
 {
-#if defined(ENABLE_CGAL) && defined(USE_MIMALLOC)
-  // call init_mimalloc before any GMP variables are initialized. (defined in src/openscad_mimalloc.h)
-  init_mimalloc();
-#endif
-
-  int rc = 0;
-  StackCheck::inst();
-
-#ifdef OPENSCAD_QTGUI
-  { // Need a dummy app instance to get the application path but it needs to be destroyed before the GUI is launched.
-    QCoreApplication app(argc, argv);
-    PlatformUtils::registerApplicationPath(app.applicationDirPath().toLocal8Bit().constData());
-  }
-#else
-  PlatformUtils::registerApplicationPath(fs::absolute(boost::filesystem::path(argv[0]).parent_path()).generic_string());
-#endif
-
-#ifdef Q_OS_MAC
-  bool isGuiLaunched = getenv("GUI_LAUNCHED") != nullptr;
-  auto nslog = [](const Message& msg, void *userdata) {
-      CocoaUtils::nslog(msg.msg, userdata);
-    };
-  if (isGuiLaunched) set_output_handler(nslog, nullptr, nullptr);
-#else
-  PlatformUtils::ensureStdIO();
-#endif
-
-#ifdef ENABLE_CGAL
-  // Always throw exceptions from CGAL, so we can catch instead of crashing on bad geometry.
-  CGAL::set_error_behaviour(CGAL::THROW_EXCEPTION);
-  CGAL::set_warning_behaviour(CGAL::THROW_EXCEPTION);
-#endif
-  Builtins::instance()->initialize();
-
-  auto original_path = fs::current_path();
-
-  vector<string> output_files;
-  const char *deps_output_file = nullptr;
-  boost::optional<FileFormat> export_format;
-
-  ViewOptions viewOptions{};
-  po::options_description desc("Allowed options");
   desc.add_options()
     ("export-format", po::value<string>(), "overrides format of exported scad file when using option '-o', arg can be any of its supported file extensions.  For ascii stl export, specify 'asciistl', and for binary stl export, specify 'binstl'.  Ascii export is the current stl default, but binary stl is planned as the future default so asciistl should be explicitly specified in scripts when needed.\n")
-    ("o,o", po::value<vector<string>>(), "output specified file instead of running the GUI, the file extension specifies the type: stl, off, wrl, amf, 3mf, csg, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg (May be used multiple time for different exports). Use '-' for stdout\n")
+    ("o,o", po::value<vector<string>>(), "output specified file instead of running the GUI, the file extension specifies the type: stl, off, wrl, amf, 3mf, csg, csgb, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg (May be used multiple time for different exports). Use '-' for stdout\n")
     ("D,D", po::value<vector<string>>(), "var=val -pre-define variables")
     ("p,p", po::value<string>(), "customizer parameter file")
     ("P,P", po::value<string>(), "customizer parameter set")
+    ("sweep", po::value<vector<string>>(), "name=values -export one file per combination of customizer parameter values, given as [start:end], [start:step:end] or a comma separated list. Use {name} or {index} in the output filename (May be used multiple times)")
 #ifdef ENABLE_EXPERIMENTAL
   ("enable", po::value<vector<string>>(), ("enable experimental features (specify 'all' for enabling all available features): " +
                                            str_join(boost::make_iterator_range(Feature::begin(), Feature::end()), " | ",
@@ -974,6 +1047,7 @@ int main(int argc, char **argv)
   ("help,h", "print this help message and exit")
     ("version,v", "print the version")
     ("info", "print information about the build process\n")
+    ("serve", "serve render requests read from stdin, one JSON-RPC request per line, keeping caches between them\n")
 
     ("camera", po::value<string>(), "camera parameters when exporting png: =translate_x,y,z,rot_x,y,z,dist or =eye_x,y,z,center_x,y,z")
     ("autocenter", "adjust camera to look at object's center")
@@ -985,13 +1059,14 @@ int main(int argc, char **argv)
     ("view", po::value<CommaSeparatedVector>(), ("=view options: " + boost::algorithm::join(viewOptions.names(), " | ")).c_str())
     ("projection", po::value<string>(), "=(o)rtho or (p)erspective when exporting png")
     ("csglimit", po::value<unsigned int>(), "=n -stop rendering at n CSG elements when exporting png")
-    ("summary", po::value<vector<string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area")
+    ("summary", po::value<vector<string>>(), "enable additional render summary and statistics: all | cache | time | camera | geometry | bounding-box | area | csg")
     ("summary-file", po::value<string>(), "output summary information in JSON format to the given file, using '-' outputs to stdout")
     ("colorscheme", po::value<string>(), ("=colorscheme: " +
-                                          str_join(ColorMap::inst()->colorSchemeNames(), " | ",
-                                                   [](const std::string& colorScheme) {
+                                          (!list_colorschemes ? std::string("see --help") :
+                                           str_join(ColorMap::inst()->colorSchemeNames(), " | ",
+                                                    [](const std::string& colorScheme) {
     return (colorScheme == ColorMap::inst()->defaultColorSchemeName() ? "*" : "") + colorScheme;
-  }) +
+  })) +
                                           "\n").c_str())
     ("d,d", po::value<string>(), "deps_file -generate a dependency file for make")
     ("m,m", po::value<string>(), "make_cmd -runs make_cmd file if file is missing")
@@ -1008,6 +1083,54 @@ int main(int argc, char **argv)
   ("trust-python",  "Trust python")
 #endif
   ;
+}
+
+// OpenSCAD
+int main(int argc, char **argv)
+{
+#if defined(ENABLE_CGAL) && defined(USE_MIMALLOC)
+  // call init_mimalloc before any GMP variables are initialized. (defined in src/openscad_mimalloc.h)
+  init_mimalloc();
+#endif
+
+  int rc = 0;
+  StackCheck::inst();
+
+#ifdef OPENSCAD_QTGUI
+  { // Need a dummy app instance to get the application path but it needs to be destroyed before the GUI is launched.
+    QCoreApplication app(argc, argv);
+    PlatformUtils::registerApplicationPath(app.applicationDirPath().toLocal8Bit().constData());
+  }
+#else
+  PlatformUtils::registerApplicationPath(fs::absolute(boost::filesystem::path(argv[0]).parent_path()).generic_string());
+#endif
+  startup_phase("application path");
+
+#ifdef Q_OS_MAC
+  bool isGuiLaunched = getenv("GUI_LAUNCHED") != nullptr;
+  auto nslog = [](const Message& msg, void *userdata) {
+      CocoaUtils::nslog(msg.msg, userdata);
+    };
+  if (isGuiLaunched) set_output_handler(nslog, nullptr, nullptr);
+#else
+  PlatformUtils::ensureStdIO();
+#endif
+
+#ifdef ENABLE_CGAL
+  // Always throw exceptions from CGAL, so we can catch instead of crashing on bad geometry.
+  CGAL::set_error_behaviour(CGAL::THROW_EXCEPTION);
+  CGAL::set_warning_behaviour(CGAL::THROW_EXCEPTION);
+#endif
+
+  auto original_path = fs::current_path();
+
+  vector<string> output_files;
+  const char *deps_output_file = nullptr;
+  boost::optional<FileFormat> export_format;
+
+  ViewOptions viewOptions{};
+  po::options_description desc("Allowed options");
+  describe_options(desc, viewOptions, false);
 
   po::options_description hidden("Hidden options");
   hidden.add_options()
@@ -1027,8 +1150,9 @@ int main(int argc, char **argv)
     po::store(po::command_line_parser(argc, argv).options(all_options).positional(p).extra_parser(customSyntax).run(), vm);
   } catch (const std::exception& e) { // Catches e.g. unknown options
     LOG("%1$s\n", e.what());
-    help(argv[0], desc, true);
+    help(argv[0], viewOptions, true);
   }
+  startup_phase("option parsing");
 
   OpenSCAD::debug = "";
   if (vm.count("debug")) {
@@ -1068,7 +1192,7 @@ int main(int argc, char **argv)
     }
   }
 
-  if (vm.count("help")) help(argv[0], desc);
+  if (vm.count("help")) help(argv[0], viewOptions);
   if (vm.count("version")) version();
   if (vm.count("info")) arg_info = true;
 
@@ -1108,11 +1232,11 @@ int main(int argc, char **argv)
     output_files.push_back(vm["x"].as<string>());
   }
   if (vm.count("d")) {
-    if (deps_output_file) help(argv[0], desc, true);
+    if (deps_output_file) help(argv[0], viewOptions, true);
     deps_output_file = vm["d"].as<string>().c_str();
   }
   if (vm.count("m")) {
-    if (make_command) help(argv[0], desc, true);
+    if (make_command) help(argv[0], viewOptions, true);
     make_command = vm["m"].as<string>().c_str();
   }
 
@@ -1135,7 +1259,7 @@ int main(int argc, char **argv)
   string parameterFile;
   if (vm.count("p")) {
     if (!parameterFile.empty()) {
-      help(argv[0], desc, true);
+      help(argv[0], viewOptions, true);
     }
     parameterFile = vm["p"].as<string>().c_str();
   }
@@ -1143,7 +1267,7 @@ int main(int argc, char **argv)
   string parameterSet;
   if (vm.count("P")) {
     if (!parameterSet.empty()) {
-      help(argv[0], desc, true);
+      help(argv[0], viewOptions, true);
     }
     parameterSet = vm["P"].as<string>().c_str();
   }
@@ -1174,6 +1298,34 @@ int main(int argc, char **argv)
     animate_frames = vm["animate"].as<unsigned>();
   }
 
+  ParameterSweep sweep;
+  if (vm.count("sweep")) {
+    for (const auto& spec : vm["sweep"].as<vector<string>>()) {
+      if (!sweep.addSpec(spec)) return 1;
+    }
+    if (animate_frames) {
+      LOG("Option --sweep can't be combined with --animate.");
+      return 1;
+    }
+    for (const auto& filename : output_files) {
+      if (filename == "-") {
+        LOG("Option --sweep is not supported when exporting to stdout.");
+        return 1;
+      }
+      // Variants exported to the same file would silently overwrite each other
+      std::map<std::string, size_t> variant_files;
+      for (size_t variant = 0; variant < sweep.size(); ++variant) {
+        const auto variant_file = sweep.filename(filename, variant);
+        const auto inserted = variant_files.emplace(variant_file, variant);
+        if (!inserted.second) {
+          LOG("Option --sweep exports variants %1$d and %2$d to the same file '%3$s'. Use {index} or a placeholder for each swept parameter in the output filename.",
+              inserted.first->second + 1, variant + 1, variant_file);
+          return 1;
+        }
+      }
+    }
+  }
+
   Camera camera = get_camera(vm);
 
   if (animate_frames) {
@@ -1191,14 +1343,60 @@ int main(int argc, char **argv)
   auto cmdlinemode = false;
   if (!output_files.empty()) { // cmd-line mode
     cmdlinemode = true;
-    if (!inputFiles.size()) help(argv[0], desc, true);
+    if (!inputFiles.size()) help(argv[0], viewOptions, true);
   }
 
-  if (arg_info || cmdlinemode) {
-    if (inputFiles.size() > 1) help(argv[0], desc, true);
+  // Only registered once we know a design will be evaluated, so --help and
+  // --version don't pay for it
+  Builtins::instance()->initialize();
+  startup_phase("builtins");
+
+  if (vm.count("serve")) {
+    if (cmdlinemode || arg_info || !inputFiles.empty()) help(argv[0], viewOptions, true);
+    parser_init();
+    localization_init();
+    startup_phase("library paths and localization");
+    print_startup_phases();
+    // Options given on the command line are the defaults for all requests
+    const ParameterSweep nosweep;
+    RenderServer server([&](const RenderRequest& request) {
+      boost::optional<FileFormat> format;
+      if (!request.format.empty()) {
+        const auto format_iter = exportFileFormatOptions.exportFileFormats.find(request.format);
+        if (format_iter == exportFileFormatOptions.exportFileFormats.end()) {
+          LOG("Unknown export format '%1$s'.", request.format);
+          return 1;
+        }
+        format = format_iter->second;
+      }
+      const CommandLine cmd{
+        false,
+        request.file,
+        false,
+        request.output,
+        original_path,
+        request.parameterFile,
+        request.parameterSet,
+        viewOptions,
+        camera,
+        format ? format : export_format,
+        0,
+        request.summaryOptions,
+        request.summaryFile,
+        nosweep,
+        &request.parameters
+      };
+      return cmdline(cmd);
+    });
+    rc = server.run(std::cin, std::cout);
+  } else if (arg_info || cmdlinemode) {
+    if (inputFiles.size() > 1) help(argv[0], viewOptions, true);
     try {
       parser_init();
+      startup_phase("library paths");
       localization_init();
+      startup_phase("localization");
+      print_startup_phases();
       if (arg_info) {
         rc = info();
       } else {
@@ -1220,7 +1418,8 @@ int main(int argc, char **argv)
             export_format,
             animate_frames,
             vm.count("summary") ? vm["summary"].as<std::vector<std::string>>() : std::vector<std::string>{},
-            vm.count("summary-file") ? vm["summary-file"].as<std::string>() : ""
+            vm.count("summary-file") ? vm["summary-file"].as<std::string>() : "",
+            sweep
           };
           rc |= cmdline(cmd);
         }
@@ -1,6 +1,7 @@
 #include "printutils.h"
 #include <sstream>
 #include <cstdio>
+#include <mutex>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/circular_buffer.hpp>
@@ -32,6 +33,9 @@ int count = 0;
 namespace {
 bool no_throw;
 bool deferred;
+size_t message_count = 0;
+// Geometry may be created on worker threads, see GeometryEvaluator::precomputeLeaves()
+std::recursive_mutex print_mutex;
 }
 
 void set_output_handler(OutputHandlerFunc *newhandler, OutputHandlerFunc2 *newhandler2, void *userdata)
@@ -55,6 +59,12 @@ bool would_have_thrown()
   return would_throw;
 }
 
+size_t printed_message_count()
+{
+  std::lock_guard<std::recursive_mutex> lock(print_mutex);
+  return message_count;
+}
+
 void print_messages_push()
 {
   print_messages_stack.emplace_back();
@@ -75,6 +85,8 @@ void print_messages_pop()
 void PRINT(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  std::lock_guard<std::recursive_mutex> lock(print_mutex);
+  ++message_count;
 
   if (print_messages_stack.size() > 0) {
     if (!print_messages_stack.back().empty()) {
@@ -96,6 +108,7 @@ void PRINT(const Message& msgObj)
 void PRINT_NOCACHE(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
+  std::lock_guard<std::recursive_mutex> lock(print_mutex);
 
   const auto msg = msgObj.str();
 
@@ -99,6 +99,8 @@ extern std::list<std::string> print_messages_stack;
 void print_messages_push();
 void print_messages_pop();
 void resetSuppressedMessages();
+// Number of messages PRINT() got so far, to tell if an evaluation printed any
+size_t printed_message_count();
 
 
 /* PRINT statements come out in same window as ECHO.
@@ -0,0 +1,30 @@
+#!/usr/bin/env python
+
+# Export a 3MF file and list its mesh objects and build items
+#
+# Usage: <script> --openscad=<binary> <inputfile> [openscad args] <outputfile>
+#
+# Objects are numbered in the order they are defined, transforms of
+# build items are printed as the 12 numbers of the 3MF transform.
+
+import os, tempfile
+import xml.etree.ElementTree as ET
+from zipfile import ZipFile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Export a 3MF file and list its mesh objects and build items')
+
+ns = {'m': 'http://schemas.microsoft.com/3dmanufacturing/core/2015/02'}
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    exportfile = os.path.join(tmpdir, 'export.3mf')
+    run_openscad(args, [args.inputfile, '-o', exportfile], check=True)
+    model = ET.fromstring(ZipFile(exportfile).read('3D/3dmodel.model'))
+
+objects = [obj.get('id') for obj in model.findall('m:resources/m:object', ns)]
+with open(args.outputfile, 'w') as out:
+    out.write('objects: %d\n' % len(objects))
+    for item in model.findall('m:build/m:item', ns):
+        transform = item.get('transform', '1 0 0 0 1 0 0 0 1 0 0 0')
+        numbers = ' '.join('%g' % (float(n) + 0.0) for n in transform.split())
+        out.write('item: object %d, transform %s\n' % (objects.index(item.get('objectid')), numbers))
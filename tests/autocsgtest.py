@@ -0,0 +1,30 @@
+#!/usr/bin/env python
+
+# Report which kernels auto-csg chose for a design
+#
+# Usage: <script> --openscad=<binary> <inputfile> [openscad args] <outputfile>
+#
+# Renders the input file to STL with the csg render summary, and writes the
+# return code of OpenSCAD and the operations, failures and conversions of
+# each kernel to the outputfile. Times are left out since they vary.
+
+import os, json, tempfile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Report which kernels auto-csg chose for a design')
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    summaryfile = os.path.join(tmpdir, 'summary.json')
+    proc = run_openscad(args, [args.inputfile, '-o', os.path.join(tmpdir, 'out.stl'),
+                               '--summary', 'csg', '--summary-file', summaryfile])
+
+    summary = {}
+    if os.path.exists(summaryfile):
+        with open(summaryfile) as f:
+            summary = json.load(f)
+
+    with open(args.outputfile, 'w') as out:
+        out.write('return code: %d\n' % proc.returncode)
+        for kernel, statistic in sorted(summary.get('csg', {}).items()):
+            out.write('%s: %d operations, %d failures, %d conversions\n' % (
+                kernel, statistic['operations'], statistic['failures'], statistic['conversions']))
@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+
+# Report what a design takes from the geometry caches as it is edited
+#
+# Usage: <script> --openscad=<binary> [--suffix=<suffix>] [--set=<name>=<value> ...] <inputfile> [openscad args] <outputfile>
+#
+# Exports the input file, to STL by default or e.g. to a PNG preview, in
+# one openscad --serve session: first as is, and then once per --set, which
+# overrides a customizer parameter on top of the previous ones. An empty
+# --set exports again unchanged. For each export, the outputfile receives
+# whether it succeeded, the warnings and errors it logged, and the hits in
+# the geometry and CGAL caches.
+
+import os, json, subprocess, tempfile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Report what a design takes from the geometry caches as it is edited',
+                  ('--suffix', dict(default='stl', help='suffix of the exported file')),
+                  ('--set', dict(action='append', default=[], help='parameter override, as <name>=<value>')))
+
+def parse_value(value):
+    try:
+        return json.loads(value)
+    except ValueError:
+        return value
+
+renders = [('', {})]
+parameters = {}
+for override in args.set:
+    if override:
+        name, value = override.split('=', 1)
+        parameters[name] = parse_value(value)
+    renders.append((override, dict(parameters)))
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    requests = []
+    for id, (override, overrides) in enumerate(renders, 1):
+        requests.append({'jsonrpc': '2.0', 'id': id, 'method': 'render',
+                         'params': {'file': args.inputfile, 'output': os.path.join(tmpdir, 'out.' + args.suffix),
+                                    'parameters': overrides, 'summary': ['cache']}})
+    requests.append({'jsonrpc': '2.0', 'id': len(renders) + 1, 'method': 'shutdown'})
+    input = ''.join(json.dumps(request) + '\n' for request in requests).encode()
+    proc = run_openscad(args, ['--serve'], input=input, stdout=subprocess.PIPE)
+
+    with open(args.outputfile, 'w') as out:
+        out.write('return code: %d\n' % proc.returncode)
+        # The cache statistics count from the start of the session
+        previous = {}
+        for response_line in proc.stdout.decode('utf-8').splitlines():
+            if not response_line.startswith('{'): continue
+            response = json.loads(response_line)
+            if response['id'] > len(renders): continue
+            override = renders[response['id'] - 1][0]
+            result = response.get('result', {})
+            out.write('render %d%s: %s\n' % (response['id'], ' (%s)' % override if override else '',
+                                             'success' if result.get('success') else 'failed'))
+            for entry in result.get('log', []):
+                if entry['type'] in ('ERROR', 'WARNING'):
+                    out.write('  %s: %s\n' % (entry['type'], entry['message']))
+            cache = result.get('summary', {}).get('cache', {})
+            hits = []
+            for name in ['geometry_cache', 'cgal_cache']:
+                count = cache.get(name, {}).get('hits', 0)
+                hits.append('%s %d' % (name, count - previous.get(name, 0)))
+                previous[name] = count
+            out.write('  hits: %s\n' % ', '.join(hits))
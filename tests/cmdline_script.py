@@ -0,0 +1,43 @@
+#!/usr/bin/env python
+
+# Command line handling shared by the test scripts run by add_cmdline_test()
+#
+# add_cmdline_test() runs a script as
+#   <script> <inputfile> [injected options] [ARGS] <outputfile>
+# where the injected options, e.g. --enable=fast-csg, are meant for
+# OpenSCAD and come before the ARGS of the test. Options of the scripts
+# themselves are therefore named, like --openscad=<binary>, and everything
+# else between the input and the output file is passed on to OpenSCAD.
+
+import sys, os, argparse, subprocess
+
+def parse_args(description, *options):
+    """Parses the command line of a test script.
+
+    options are (name, keyword arguments) of script specific options, as
+    taken by ArgumentParser.add_argument(). Returns the parsed options with
+    inputfile, outputfile and openscad_args added.
+    """
+    parser = argparse.ArgumentParser(description=description, allow_abbrev=False,
+                                     usage='%(prog)s [options] <inputfile> [openscad args] <outputfile>')
+    parser.add_argument('--openscad', default=os.environ.get('OPENSCAD_BINARY'),
+                        help='OpenSCAD executable, defaults to env["OPENSCAD_BINARY"]')
+    for name, kwargs in options:
+        parser.add_argument(name, **kwargs)
+    args, remaining = parser.parse_known_args()
+    if len(remaining) < 2:
+        parser.error('expected an input and an output file')
+    if not args.openscad:
+        parser.error('no OpenSCAD executable given')
+    args.inputfile = os.path.abspath(remaining[0])
+    args.outputfile = remaining[-1]
+    args.openscad_args = remaining[1:-1]
+    return args
+
+def run_openscad(args, cmdline, **kwargs):
+    """Runs OpenSCAD with cmdline followed by the OpenSCAD arguments of the
+    test, passing kwargs on to subprocess.run()."""
+    cmd = [args.openscad] + cmdline + args.openscad_args
+    print('Running OpenSCAD:', ' '.join(cmd))
+    sys.stdout.flush()
+    return subprocess.run(cmd, **kwargs)
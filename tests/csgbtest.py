@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+
+# Round trip a design through an evaluated tree (.csgb), and load corrupt trees
+#
+# Usage: <script> --openscad=<binary> <inputfile> [openscad args] <outputfile>
+#
+# Exports the input file to .csg directly and through .csgb, and reports
+# whether both are identical. Then loads malformed trees derived from the
+# exported one, which must be rejected with an error instead of crashing.
+
+import sys, os, subprocess, tempfile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Round trip a design through an evaluated tree (.csgb), and load corrupt trees')
+
+def varint(value):
+    result = bytearray()
+    while value >= 0x80:
+        result.append((value & 0x7f) | 0x80)
+        value >>= 7
+    result.append(value)
+    return bytes(result)
+
+HEADER = b'OSCB' + varint(2)
+ROOT = 1
+# A new root node with a new module instantiation named "x" and no location
+FIRST_ROOT = varint(0) + bytes([ROOT]) + varint(0) + varint(0) + varint(1) + b'x' + bytes([0])
+# A new root node reusing that instantiation
+NEXT_ROOT = varint(0) + bytes([ROOT]) + varint(1)
+
+def run(inputfile, outputfile):
+    proc = run_openscad(args, [inputfile, '-o', outputfile], stderr=subprocess.PIPE, universal_newlines=True)
+    sys.stderr.write(proc.stderr)
+    errors = [line for line in proc.stderr.splitlines() if 'Invalid binary node tree' in line]
+    return proc.returncode, errors
+
+def read(path):
+    with open(path, 'rb') as f:
+        return f.read()
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    def path(name):
+        return os.path.join(tmpdir, name)
+
+    with open(args.outputfile, 'w') as out:
+        run(args.inputfile, path('direct.csg'))
+        run(args.inputfile, path('tree.csgb'))
+        rc, errors = run(path('tree.csgb'), path('tree.csg'))
+        identical = os.path.exists(path('tree.csg')) and read(path('direct.csg')) == read(path('tree.csg'))
+        out.write('round trip: return code %d, %s\n' % (rc, 'identical' if identical else 'different'))
+
+        tree = read(path('tree.csgb'))
+        corrupt = {
+            'truncated': tree[:len(HEADER) + 1],
+            'trailing-data': tree + b'\0',
+            'version': b'OSCB' + varint(99) + tree[len(HEADER):],
+            # The child refers to its parent, which is still being read
+            'cycle': HEADER + FIRST_ROOT + varint(1) + varint(1),
+            'deep': HEADER + FIRST_ROOT + varint(1) + (NEXT_ROOT + varint(1)) * 10000 + NEXT_ROOT + varint(0),
+        }
+        for name, data in corrupt.items():
+            with open(path(name + '.csgb'), 'wb') as f:
+                f.write(data)
+            rc, errors = run(path(name + '.csgb'), path(name + '.csg'))
+            out.write('%s: return code %d\n' % (name, rc))
+            for error in errors:
+                out.write('  %s\n' % error[error.index('Invalid'):])
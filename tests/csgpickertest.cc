@@ -0,0 +1,108 @@
+/*
+   Picks known objects of a small CSG scene through pixels of the camera,
+   in perspective and orthogonal projection, with CSGPicker.
+ */
+#include "CSGPicker.h"
+#include "CSGNode.h"
+#include "PolySet.h"
+#include "Camera.h"
+
+#include <cmath>
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, const char *projection)
+{
+  if (!condition) {
+    std::cerr << "FAILED: " << what << " (" << projection << ")" << std::endl;
+    ++failures;
+  }
+}
+
+// [-1, 1]^3
+static shared_ptr<const PolySet> unitCube()
+{
+  auto ps = std::make_shared<PolySet>(3);
+  const int faces[6][4] = {
+    {0, 1, 3, 2}, {4, 6, 7, 5}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 2, 6, 4}, {1, 5, 7, 3}
+  };
+  for (const auto& face : faces) {
+    ps->append_poly(4);
+    for (const int corner : face) {
+      ps->append_vertex(corner & 4 ? 1 : -1, corner & 2 ? 1 : -1, corner & 1 ? 1 : -1);
+    }
+  }
+  return ps;
+}
+
+int main()
+{
+  // 1: a 4 x 4 x 2 box around the origin, with a pocket 2: subtracted from the
+  // center of its top, and 3: a separate cube at x = 6
+  const auto cube = unitCube();
+  Transform3d box(Transform3d::Identity()), pocket(Transform3d::Identity()), separate(Transform3d::Identity());
+  box.scale(Vector3d(2, 2, 1));
+  pocket.translate(Vector3d(0, 0, 1));
+  separate.translate(Vector3d(6, 0, 0));
+  const Color4f color(0, 0, 0, 1);
+  auto csgtree = CSGOperation::createCSGNode(
+    OpenSCADOperator::UNION,
+    CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE,
+                                std::make_shared<CSGLeaf>(cube, box, color, "box", 1),
+                                std::make_shared<CSGLeaf>(cube, pocket, color, "pocket", 2)),
+    std::make_shared<CSGLeaf>(cube, separate, color, "separate", 3));
+  auto products = std::make_shared<CSGProducts>();
+  products->import(csgtree);
+
+  CSGPicker picker;
+  picker.import(products);
+
+  // Looking down from z = 40 onto the origin
+  Camera camera;
+  camera.setVpt(0, 0, 0);
+  camera.setVpr(0, 0, 0);
+  camera.setVpd(40);
+  camera.setVpf(22.5);
+  camera.pixel_width = 100;
+  camera.pixel_height = 100;
+
+  for (const auto projection : {Camera::ProjectionType::PERSPECTIVE, Camera::ProjectionType::ORTHOGONAL}) {
+    const char *name = projection == Camera::ProjectionType::PERSPECTIVE ? "perspective" : "orthogonal";
+    camera.setProjection(projection);
+    Vector3d origin, direction;
+
+    // Through the pocket onto its bottom, which is the surface of the subtracted leaf
+    camera.pixelRay(52, 49, origin, direction);
+    auto hit = picker.pick(origin, direction);
+    check(hit && hit->index == 2, "pocket bottom", name);
+    check(hit && std::abs(hit->point.z()) < 1e-9 && std::abs(hit->point.x()) < 1, "pocket bottom point", name);
+
+    // Onto the top of the box next to the pocket
+    camera.pixelRay(60, 49, origin, direction);
+    hit = picker.pick(origin, direction);
+    check(hit && hit->index == 1, "box top", name);
+    check(hit && std::abs(hit->point.z() - 1) < 1e-9 && hit->point.x() > 1 && hit->point.x() < 2, "box top point", name);
+
+    // Onto the top of the separate cube
+    camera.pixelRay(88, 49, origin, direction);
+    hit = picker.pick(origin, direction);
+    check(hit && hit->index == 3, "separate cube", name);
+    check(hit && std::abs(hit->point.z() - 1) < 1e-9 && hit->point.x() > 5 && hit->point.x() < 7, "separate cube point", name);
+
+    // Next to everything
+    camera.pixelRay(10, 49, origin, direction);
+    check(!picker.pick(origin, direction), "miss", name);
+  }
+
+  // With the eye inside the box, the orthogonal ray starts behind it on the near
+  // clipping plane and still picks the top of the box above the eye
+  camera.setVpt(1.5, 0, 0);
+  camera.setVpd(0.5);
+  Vector3d origin, direction;
+  camera.pixelRay(50, 50, origin, direction);
+  const auto hit = picker.pick(origin, direction);
+  check(hit && hit->index == 1 && std::abs(hit->point.z() - 1) < 1e-9, "box top above the eye", "orthogonal");
+
+  return failures == 0 ? 0 : 1;
+}
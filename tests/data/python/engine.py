@@ -0,0 +1,21 @@
+# Builds a few objects with the embedded Python engine, run by pythonechotest
+from openscad import *
+import array
+
+c = cube([1, 2, 3])
+echo(c)
+echo(c.translate([1, 0, 0]))
+echo(color(c, "red"))
+echo(t)
+try:
+    cube("a")
+except TypeError as e:
+    echo(type(e).__name__)
+# Points and faces read in place from typed buffers
+points = memoryview(array.array('d', [0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1])).cast('B').cast('d', [4, 3])
+faces = memoryview(array.array('i', [0, 1, 2, 0, 3, 1, 0, 2, 3, 1, 3, 2])).cast('B').cast('i', [4, 3])
+echo(polyhedron(points, faces))
+echo(polygon(memoryview(array.array('d', [0, 0, 2, 0, 0, 1])).cast('B').cast('d', [3, 2])))
+u = union(c, cube(1).translate([0, 0, 3]))
+echo(u)
+u.output()
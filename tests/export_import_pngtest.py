@@ -51,11 +51,12 @@ def createImport(inputfile, scadfile):
 #
 # Parse arguments
 #
-formats = ['csg', 'asciistl', 'binstl', 'stl', 'off', 'amf', '3mf', 'dxf', 'svg']
+formats = ['csg', 'asciistl', 'binstl', 'stl', 'off', 'obj', 'amf', '3mf', 'dxf', 'svg']
 parser = argparse.ArgumentParser()
 parser.add_argument('--openscad', required=False, default=os.environ["OPENSCAD_BINARY"],
     help='Specify OpenSCAD executable, default to env["OPENSCAD_BINARY"] if absent.')
 parser.add_argument('--format', required=True, choices=[item for sublist in [(f,f.upper()) for f in formats] for item in sublist], help='Specify 3d export format')
+parser.add_argument('--compression', choices=['gz', 'zst'], help='Compress the exported file, naming it with this suffix')
 parser.add_argument('--require-manifold', dest='requiremanifold', action='store_true', help='Require STL output to be manifold')
 parser.set_defaults(requiremanifold=False)
 args,remaining_args = parser.parse_known_args()
@@ -89,6 +90,7 @@ if args.format == 'csg':
 else:
     exportfile = os.path.join(outputdir, inputfilename)
     if args.format != inputsuffix[1:]: exportfile += '.' + args.format
+    if args.compression: exportfile += '.' + args.compression
 
 # If we're not reading an .scad or .csg file, we need to import it.
 if inputsuffix != '.scad' and inputsuffix != '.csg':
@@ -0,0 +1,55 @@
+/*
+   Links against libopenscad and renders a small design through its API,
+   to check that the library is complete and usable on its own.
+ */
+#include "libopenscad.h"
+
+#include <algorithm>
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::cerr << "FAILED: " << what << std::endl;
+    ++failures;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1) libopenscad::initialize(argv[1]);
+
+  libopenscad::Session session;
+  check(session.parse("size = 1;\ncube(size);\n", "test.scad"), "parse");
+  check(session.evaluate(), "evaluate");
+  check(session.tree().find("cube(size = [1, 1, 1]") != std::string::npos, "tree");
+
+  check(session.render(), "render 3D");
+  check(session.dimension() == 3, "dimension 3");
+  auto mesh = session.mesh();
+  check(mesh.vertices.size() == 8, "cube vertices");
+  double max = 0;
+  for (const auto& v : mesh.vertices) max = std::max(max, v[2]);
+  check(max == 1, "cube size");
+
+  session.setVariable("size", "2");
+  check(session.render(), "render with variable");
+  max = 0;
+  for (const auto& v : session.mesh().vertices) max = std::max(max, v[2]);
+  check(max == 2, "variable override");
+
+  check(session.parse("difference() { square(4, center = true); square(2, center = true); }\n"), "parse 2D");
+  check(session.render(), "render 2D");
+  check(session.dimension() == 2, "dimension 2");
+  auto polygons = session.polygons();
+  check(polygons.outlines.size() == 2, "square with a hole");
+
+  session.clearMessages();
+  check(!session.parse("cube(;\n"), "syntax error");
+  check(!session.messages().empty(), "syntax error message");
+
+  for (const auto& msg : session.messages()) std::cerr << msg.type << ": " << msg.text << std::endl;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+
+# Send a fixed sequence of JSON-RPC requests to openscad --serve
+#
+# Usage: <script> --openscad=<binary> <inputfile> [openscad args] <outputfile>
+#
+# Exports the input file with customizer values, to an evaluated tree
+# (.csgb) and from it again, and sends notifications and invalid requests,
+# including one with a file name which isn't valid UTF-8. The outputfile
+# receives the return code of OpenSCAD, the responses with the error
+# messages they logged, and the contents of the exported .csg files.
+
+import os, json, subprocess, tempfile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Send a fixed sequence of JSON-RPC requests to openscad --serve')
+inputfile = args.inputfile
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    def path(name):
+        return os.path.join(tmpdir, name)
+
+    def render(id, file, output, **params):
+        return {'jsonrpc': '2.0', 'id': id, 'method': 'render',
+                'params': dict(file=file, output=path(output), **params)}
+
+    def line(request):
+        return json.dumps(request).encode() + b'\n'
+
+    # JSON can't carry invalid UTF-8, so the path goes in as raw bytes. The
+    # error message quotes it, and the server must still answer and go on.
+    invalid_path = path('invalid.csg').encode() + b'\xff'
+    invalid_utf8 = b'{"jsonrpc": "2.0", "id": 7, "method": "render", "params": {"file": "' + \
+        invalid_path + b'", "output": "' + invalid_path + b'"}}\n'
+
+    requests = [
+        line(render(1, inputfile, 'parameters.csg', parameters={'width': 2, 'label': 'b'})),
+        # Notifications are never answered, not even with an error
+        line({'jsonrpc': '2.0', 'method': 'clear-caches'}),
+        line({'jsonrpc': '2.0', 'method': 'unknown'}),
+        line(render(2, inputfile, 'tree.csgb')),
+        line(render(3, path('tree.csgb'), 'rejected.csg', parameters={'width': 3})),
+        line(render(4, path('tree.csgb'), 'tree.csg')),
+        line({'jsonrpc': '2.0', 'id': 5, 'method': 'unknown'}),
+        invalid_utf8,
+        line({'jsonrpc': '2.0', 'id': 6, 'method': 'shutdown'}),
+    ]
+    proc = run_openscad(args, ['--serve'], input=b''.join(requests), stdout=subprocess.PIPE)
+
+    with open(args.outputfile, 'w') as out:
+        out.write('return code: %d\n' % proc.returncode)
+        for response_line in proc.stdout.decode('utf-8').splitlines():
+            if not response_line.startswith('{'): continue
+            response = json.loads(response_line)
+            if 'error' in response:
+                out.write('%s: error %d\n' % (response['id'], response['error']['code']))
+                continue
+            result = response['result']
+            out.write('%s: %s\n' % (response['id'], 'success' if result.get('success', True) else 'failed'))
+            for entry in result.get('log', []):
+                if entry['type'] == 'ERROR':
+                    out.write('  %s\n' % entry['message'].replace(tmpdir + os.sep, ''))
+        for name in ['parameters.csg', 'rejected.csg', 'tree.csg']:
+            if not os.path.exists(path(name)): continue
+            out.write('--- %s\n' % name)
+            with open(path(name)) as f:
+                out.write(f.read())
@@ -0,0 +1,25 @@
+#!/usr/bin/env python
+
+# Export a parameter sweep and list the files it created
+#
+# Usage: <script> --openscad=<binary> --template=<output template> <inputfile> [openscad args] <outputfile>
+#
+# The output template is relative to a temporary directory. The outputfile
+# receives the return code of OpenSCAD, followed by the name and contents
+# of every file exported, in sorted order.
+
+import os, tempfile
+from cmdline_script import parse_args, run_openscad
+
+args = parse_args('Export a parameter sweep and list the files it created',
+                  ('--template', dict(required=True, help='output file name template')))
+
+with tempfile.TemporaryDirectory() as tmpdir:
+    retval = run_openscad(args, [args.inputfile, '-o', os.path.join(tmpdir, args.template)]).returncode
+
+    with open(args.outputfile, 'w') as out:
+        out.write('return code: %d\n' % retval)
+        for name in sorted(os.listdir(tmpdir)):
+            out.write('--- %s\n' % name)
+            with open(os.path.join(tmpdir, name)) as f:
+                out.write(f.read())